@@ -55,6 +55,21 @@ extern void postOrderCB(Tree *root, TreeCallback callBack);
 extern void levelOrderCB(Tree *root, TreeQueue *treeQueue, TreeCallback callBack);
 extern void contiguousOrderCB(Tree *treeArray, int N, TreeCallback callBack);
 
+/* stackless traversals, iterative ones keep an explicit heap stack and Morris 
+	ones temporarily thread the tree (O(1) extra memory) */
+extern void preOrderIterative(Tree *root);
+extern void inOrderIterative(Tree *root);
+extern void postOrderIterative(Tree *root);
+extern void preOrderIterativeCB(Tree *root, TreeCallback callback);
+extern void inOrderIterativeCB(Tree *root, TreeCallback callback);
+extern void postOrderIterativeCB(Tree *root, TreeCallback callback);
+extern void preOrderMorris(Tree *root);
+extern void inOrderMorris(Tree *root);
+extern void postOrderMorris(Tree *root);
+extern void preOrderMorrisCB(Tree *root, TreeCallback callback);
+extern void inOrderMorrisCB(Tree *root, TreeCallback callback);
+extern void postOrderMorrisCB(Tree *root, TreeCallback callback);
+
 
 
 #endif
@@ -55,6 +55,9 @@ typedef struct TreeInfo
   Tree *root;
 } TreeInfo;
 
+/* initial size of the explicit stack used by iterative traversals */
+#define	TRAVERSAL_STACK_SIZE	64
+
 /* defines callback function type for performing actions during tree traversal */
 typedef void (*TreeCallback)(Tree *);
 
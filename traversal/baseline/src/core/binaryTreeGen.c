@@ -389,14 +389,31 @@ Tree * invTab2ContBTOptimized(int *invTable, Tree *btNodeArray, ITNode *itNodeAr
 	return root;
 }
 
+/* Morris in-order numbering, random trees are too deep to recurse safely */
 void bs2BST(Tree *root, int *id)
 {
-	if (root != NULL)
+	Tree *pred;
+	while (root != NULL)
 	{
-		bs2BST(root->left, id);
-		root->id = *id;
-		(*id)++;
-		bs2BST(root->right, id);
+		if (root->left == NULL)
+		{
+			root->id = (*id)++;
+			root = root->right;
+			continue;
+		}
+		pred = root->left;
+		while (pred->right != NULL && pred->right != root) pred = pred->right;
+		if (pred->right == NULL)
+		{
+			pred->right = root;
+			root = root->left;
+		}
+		else
+		{
+			pred->right = NULL;
+			root->id = (*id)++;
+			root = root->right;
+		}
 	}
 }
 
@@ -16,8 +16,10 @@
 /******************************************************************************* 
 ------------------------------- IMPORTS & PARAMS -------------------------------
 *******************************************************************************/
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "types.h"
 #include "queue.h"
@@ -26,6 +28,41 @@
 /******************************************************************************* 
 ------------------------------- HELPER FUNCTIONS -------------------------------
 *******************************************************************************/
+/* doubles an explicit traversal stack */
+Tree ** growStack(Tree **stack, int *capacity)
+{
+	*capacity *= 2;
+	return (Tree **) realloc(stack, (*capacity) * sizeof(Tree *));
+}
+
+/* flips the right pointers on the path from -> to so it can be walked backwards */
+void reverseRightSpine(Tree *from, Tree *to)
+{
+	Tree *x = from, *y = from->right, *z;
+	if (from == to) return;
+	while (x != to)
+	{
+		z = y->right;
+		y->right = x;
+		x = y;
+		y = z;
+	}
+}
+
+/* visits the right spine from -> to in reverse and restores it (to->right is 
+	left for the caller to reset), callback may be NULL */
+void visitRightSpineReversed(Tree *from, Tree *to, TreeCallback callback)
+{
+	Tree *node = to;
+	reverseRightSpine(from, to);
+	while (true)
+	{
+		if (callback != NULL) callback(node);
+		if (node == from) break;
+		node = node->right;
+	}
+	reverseRightSpine(to, from);
+}
 
 
 
@@ -146,6 +183,324 @@ void contiguousOrderCB(Tree *treeArray, int N, TreeCallback callback)
 }
 
 
+
+/******************************************************************************* 
+------------------------- ITERATIVE & MORRIS TRAVERSALS ------------------------
+*******************************************************************************/
+/* explicit-stack versions of the recursive traversals, the stack starts at 
+	TRAVERSAL_STACK_SIZE nodes and doubles, so depth costs heap instead of frames */
+void preOrderIterative(Tree *root)
+{
+	int capacity = TRAVERSAL_STACK_SIZE, top = 0;
+	Tree **stack = (Tree **) malloc(capacity * sizeof(Tree *));
+	while (root != NULL || top > 0)
+	{
+		if (root == NULL) root = stack[--top];
+		// do something here
+		if (root->right != NULL)
+		{
+			if (top == capacity) stack = growStack(stack, &capacity);
+			stack[top++] = root->right;
+		}
+		root = root->left;
+	}
+	free(stack);
+}
+
+void inOrderIterative(Tree *root)
+{
+	int capacity = TRAVERSAL_STACK_SIZE, top = 0;
+	Tree **stack = (Tree **) malloc(capacity * sizeof(Tree *));
+	while (root != NULL || top > 0)
+	{
+		while (root != NULL)
+		{
+			if (top == capacity) stack = growStack(stack, &capacity);
+			stack[top++] = root;
+			root = root->left;
+		}
+		root = stack[--top];
+		// do something here
+		root = root->right;
+	}
+	free(stack);
+}
+
+/* a node is finished once its right subtree is empty or was just visited */
+void postOrderIterative(Tree *root)
+{
+	int capacity = TRAVERSAL_STACK_SIZE, top = 0;
+	Tree **stack = (Tree **) malloc(capacity * sizeof(Tree *));
+	Tree *last = NULL, *peek;
+	while (root != NULL || top > 0)
+	{
+		if (root != NULL)
+		{
+			if (top == capacity) stack = growStack(stack, &capacity);
+			stack[top++] = root;
+			root = root->left;
+		}
+		else
+		{
+			peek = stack[top-1];
+			if (peek->right != NULL && peek->right != last)
+			{
+				root = peek->right;
+			}
+			else
+			{
+				// do something here
+				last = peek;
+				top--;
+			}
+		}
+	}
+	free(stack);
+}
+
+void preOrderIterativeCB(Tree *root, TreeCallback callback)
+{
+	int capacity = TRAVERSAL_STACK_SIZE, top = 0;
+	Tree **stack = (Tree **) malloc(capacity * sizeof(Tree *));
+	while (root != NULL || top > 0)
+	{
+		if (root == NULL) root = stack[--top];
+		callback(root);
+		if (root->right != NULL)
+		{
+			if (top == capacity) stack = growStack(stack, &capacity);
+			stack[top++] = root->right;
+		}
+		root = root->left;
+	}
+	free(stack);
+}
+
+void inOrderIterativeCB(Tree *root, TreeCallback callback)
+{
+	int capacity = TRAVERSAL_STACK_SIZE, top = 0;
+	Tree **stack = (Tree **) malloc(capacity * sizeof(Tree *));
+	while (root != NULL || top > 0)
+	{
+		while (root != NULL)
+		{
+			if (top == capacity) stack = growStack(stack, &capacity);
+			stack[top++] = root;
+			root = root->left;
+		}
+		root = stack[--top];
+		callback(root);
+		root = root->right;
+	}
+	free(stack);
+}
+
+/* a node is finished once its right subtree is empty or was just visited */
+void postOrderIterativeCB(Tree *root, TreeCallback callback)
+{
+	int capacity = TRAVERSAL_STACK_SIZE, top = 0;
+	Tree **stack = (Tree **) malloc(capacity * sizeof(Tree *));
+	Tree *last = NULL, *peek;
+	while (root != NULL || top > 0)
+	{
+		if (root != NULL)
+		{
+			if (top == capacity) stack = growStack(stack, &capacity);
+			stack[top++] = root;
+			root = root->left;
+		}
+		else
+		{
+			peek = stack[top-1];
+			if (peek->right != NULL && peek->right != last)
+			{
+				root = peek->right;
+			}
+			else
+			{
+				callback(peek);
+				last = peek;
+				top--;
+			}
+		}
+	}
+	free(stack);
+}
+
+/* Morris traversals thread the tree through empty right pointers instead of 
+	using a stack (O(1) extra memory), the tree is restored when they return 
+	but must not be read or modified by anyone else meanwhile */
+void preOrderMorris(Tree *root)
+{
+	Tree *pred;
+	while (root != NULL)
+	{
+		if (root->left == NULL)
+		{
+			// do something here
+			root = root->right;
+			continue;
+		}
+		pred = root->left;
+		while (pred->right != NULL && pred->right != root) pred = pred->right;
+		if (pred->right == NULL)
+		{
+			// do something here
+			pred->right = root;
+			root = root->left;
+		}
+		else
+		{
+			pred->right = NULL;
+			root = root->right;
+		}
+	}
+}
+
+void inOrderMorris(Tree *root)
+{
+	Tree *pred;
+	while (root != NULL)
+	{
+		if (root->left == NULL)
+		{
+			// do something here
+			root = root->right;
+			continue;
+		}
+		pred = root->left;
+		while (pred->right != NULL && pred->right != root) pred = pred->right;
+		if (pred->right == NULL)
+		{
+			pred->right = root;
+			root = root->left;
+		}
+		else
+		{
+			pred->right = NULL;
+			// do something here
+			root = root->right;
+		}
+	}
+}
+
+/* a dummy above root makes the whole tree a left subtree, every time a thread 
+	is removed the right spine of that left subtree is visited bottom-up */
+void postOrderMorris(Tree *root)
+{
+	Tree dummy, *pred;
+	dummy.left = root;
+	dummy.right = NULL;
+	root = &dummy;
+	while (root != NULL)
+	{
+		if (root->left == NULL)
+		{
+			root = root->right;
+			continue;
+		}
+		pred = root->left;
+		while (pred->right != NULL && pred->right != root) pred = pred->right;
+		if (pred->right == NULL)
+		{
+			pred->right = root;
+			root = root->left;
+		}
+		else
+		{
+			visitRightSpineReversed(root->left, pred, NULL);
+			pred->right = NULL;
+			root = root->right;
+		}
+	}
+}
+
+void preOrderMorrisCB(Tree *root, TreeCallback callback)
+{
+	Tree *pred;
+	while (root != NULL)
+	{
+		if (root->left == NULL)
+		{
+			callback(root);
+			root = root->right;
+			continue;
+		}
+		pred = root->left;
+		while (pred->right != NULL && pred->right != root) pred = pred->right;
+		if (pred->right == NULL)
+		{
+			callback(root);
+			pred->right = root;
+			root = root->left;
+		}
+		else
+		{
+			pred->right = NULL;
+			root = root->right;
+		}
+	}
+}
+
+void inOrderMorrisCB(Tree *root, TreeCallback callback)
+{
+	Tree *pred;
+	while (root != NULL)
+	{
+		if (root->left == NULL)
+		{
+			callback(root);
+			root = root->right;
+			continue;
+		}
+		pred = root->left;
+		while (pred->right != NULL && pred->right != root) pred = pred->right;
+		if (pred->right == NULL)
+		{
+			pred->right = root;
+			root = root->left;
+		}
+		else
+		{
+			pred->right = NULL;
+			callback(root);
+			root = root->right;
+		}
+	}
+}
+
+/* a dummy above root makes the whole tree a left subtree, every time a thread 
+	is removed the right spine of that left subtree is visited bottom-up */
+void postOrderMorrisCB(Tree *root, TreeCallback callback)
+{
+	Tree dummy, *pred;
+	dummy.left = root;
+	dummy.right = NULL;
+	root = &dummy;
+	while (root != NULL)
+	{
+		if (root->left == NULL)
+		{
+			root = root->right;
+			continue;
+		}
+		pred = root->left;
+		while (pred->right != NULL && pred->right != root) pred = pred->right;
+		if (pred->right == NULL)
+		{
+			pred->right = root;
+			root = root->left;
+		}
+		else
+		{
+			visitRightSpineReversed(root->left, pred, callback);
+			pred->right = NULL;
+			root = root->right;
+		}
+	}
+}
+
+
 /******************************************************************************* 
 --------------------------------- END OF FILE ----------------------------------
 *******************************************************************************/
\ No newline at end of file
@@ -54,6 +54,12 @@ void traversalBatch(int depth, int samples, bool printResults, bool verbose)
 	TraversalFunc preOrderTraversal = &preOrder;
 	TraversalFunc inOrderTraversal = &inOrder;
 	TraversalFunc postOrderTraversal = &postOrder;
+	TraversalFunc preOrderIterativeTraversal = &preOrderIterative;
+	TraversalFunc inOrderIterativeTraversal = &inOrderIterative;
+	TraversalFunc postOrderIterativeTraversal = &postOrderIterative;
+	TraversalFunc preOrderMorrisTraversal = &preOrderMorris;
+	TraversalFunc inOrderMorrisTraversal = &inOrderMorris;
+	TraversalFunc postOrderMorrisTraversal = &postOrderMorris;
 	TraversalFuncLevel levelOrderTraversal = &levelOrder;
 	TraversalFuncCont contiguousOrderTraversal = &contiguousOrder;
 
@@ -101,6 +107,30 @@ void traversalBatch(int depth, int samples, bool printResults, bool verbose)
 		treeInfo, postOrderTraversal, samples, printResults, verbose, 
 		"random", "contiguous", "post-order", "NULL"
 	);
+	timeTraversal(
+		treeInfo, preOrderIterativeTraversal, samples, printResults, verbose, 
+		"random", "contiguous", "pre-order-iterative", "NULL"
+	);
+	timeTraversal(
+		treeInfo, inOrderIterativeTraversal, samples, printResults, verbose, 
+		"random", "contiguous", "in-order-iterative", "NULL"
+	);
+	timeTraversal(
+		treeInfo, postOrderIterativeTraversal, samples, printResults, verbose, 
+		"random", "contiguous", "post-order-iterative", "NULL"
+	);
+	timeTraversal(
+		treeInfo, preOrderMorrisTraversal, samples, printResults, verbose, 
+		"random", "contiguous", "pre-order-morris", "NULL"
+	);
+	timeTraversal(
+		treeInfo, inOrderMorrisTraversal, samples, printResults, verbose, 
+		"random", "contiguous", "in-order-morris", "NULL"
+	);
+	timeTraversal(
+		treeInfo, postOrderMorrisTraversal, samples, printResults, verbose, 
+		"random", "contiguous", "post-order-morris", "NULL"
+	);
 	timeTraversalLevel(
 		treeInfo, treeQueue, levelOrderTraversal, samples, printResults, verbose, 
 		"random", "contiguous", "level-order", "NULL"
@@ -128,6 +158,30 @@ void traversalBatch(int depth, int samples, bool printResults, bool verbose)
 		treeInfo, postOrderTraversal, samples, printResults, verbose, 
 		"balanced", "fragmented", "post-order", "NULL"
 	);
+	timeTraversal(
+		treeInfo, preOrderIterativeTraversal, samples, printResults, verbose, 
+		"balanced", "fragmented", "pre-order-iterative", "NULL"
+	);
+	timeTraversal(
+		treeInfo, inOrderIterativeTraversal, samples, printResults, verbose, 
+		"balanced", "fragmented", "in-order-iterative", "NULL"
+	);
+	timeTraversal(
+		treeInfo, postOrderIterativeTraversal, samples, printResults, verbose, 
+		"balanced", "fragmented", "post-order-iterative", "NULL"
+	);
+	timeTraversal(
+		treeInfo, preOrderMorrisTraversal, samples, printResults, verbose, 
+		"balanced", "fragmented", "pre-order-morris", "NULL"
+	);
+	timeTraversal(
+		treeInfo, inOrderMorrisTraversal, samples, printResults, verbose, 
+		"balanced", "fragmented", "in-order-morris", "NULL"
+	);
+	timeTraversal(
+		treeInfo, postOrderMorrisTraversal, samples, printResults, verbose, 
+		"balanced", "fragmented", "post-order-morris", "NULL"
+	);
 	timeTraversalLevel(
 		treeInfo, treeQueue, levelOrderTraversal, samples, printResults, verbose, 
 		"balanced", "fragmented", "level-order", "NULL"
@@ -153,6 +207,30 @@ void traversalBatch(int depth, int samples, bool printResults, bool verbose)
 		treeInfo, postOrderTraversal, samples, printResults, verbose, 
 		"balanced", "contiguous", "post-order", "NULL"
 	);
+	timeTraversal(
+		treeInfo, preOrderIterativeTraversal, samples, printResults, verbose, 
+		"balanced", "contiguous", "pre-order-iterative", "NULL"
+	);
+	timeTraversal(
+		treeInfo, inOrderIterativeTraversal, samples, printResults, verbose, 
+		"balanced", "contiguous", "in-order-iterative", "NULL"
+	);
+	timeTraversal(
+		treeInfo, postOrderIterativeTraversal, samples, printResults, verbose, 
+		"balanced", "contiguous", "post-order-iterative", "NULL"
+	);
+	timeTraversal(
+		treeInfo, preOrderMorrisTraversal, samples, printResults, verbose, 
+		"balanced", "contiguous", "pre-order-morris", "NULL"
+	);
+	timeTraversal(
+		treeInfo, inOrderMorrisTraversal, samples, printResults, verbose, 
+		"balanced", "contiguous", "in-order-morris", "NULL"
+	);
+	timeTraversal(
+		treeInfo, postOrderMorrisTraversal, samples, printResults, verbose, 
+		"balanced", "contiguous", "post-order-morris", "NULL"
+	);
 	timeTraversalLevel(
 		treeInfo, treeQueue, levelOrderTraversal, samples, printResults, verbose, 
 		"balanced", "contiguous", "level-order", "NULL"
@@ -194,6 +272,12 @@ void traversalBatchCB(
 	TraversalFuncCB preOrderTraversalCB = &preOrderCB;
 	TraversalFuncCB inOrderTraversalCB = &inOrderCB;
 	TraversalFuncCB postOrderTraversalCB = &postOrderCB;
+	TraversalFuncCB preOrderIterativeTraversalCB = &preOrderIterativeCB;
+	TraversalFuncCB inOrderIterativeTraversalCB = &inOrderIterativeCB;
+	TraversalFuncCB postOrderIterativeTraversalCB = &postOrderIterativeCB;
+	TraversalFuncCB preOrderMorrisTraversalCB = &preOrderMorrisCB;
+	TraversalFuncCB inOrderMorrisTraversalCB = &inOrderMorrisCB;
+	TraversalFuncCB postOrderMorrisTraversalCB = &postOrderMorrisCB;
 	TraversalFuncLevelCB levelOrderTraversalCB = &levelOrderCB;
 	TraversalFuncContCB contiguousOrderTraversalCB = &contiguousOrderCB;
 
@@ -241,6 +325,30 @@ void traversalBatchCB(
 		treeInfo, postOrderTraversalCB, callback, samples, printResults, verbose, 
 		"random", "contiguous", "post-order", callbackName
 	);
+	timeTraversalCB(
+		treeInfo, preOrderIterativeTraversalCB, callback, samples, printResults, verbose, 
+		"random", "contiguous", "pre-order-iterative", callbackName
+	);
+	timeTraversalCB(
+		treeInfo, inOrderIterativeTraversalCB, callback, samples, printResults, verbose, 
+		"random", "contiguous", "in-order-iterative", callbackName
+	);
+	timeTraversalCB(
+		treeInfo, postOrderIterativeTraversalCB, callback, samples, printResults, verbose, 
+		"random", "contiguous", "post-order-iterative", callbackName
+	);
+	timeTraversalCB(
+		treeInfo, preOrderMorrisTraversalCB, callback, samples, printResults, verbose, 
+		"random", "contiguous", "pre-order-morris", callbackName
+	);
+	timeTraversalCB(
+		treeInfo, inOrderMorrisTraversalCB, callback, samples, printResults, verbose, 
+		"random", "contiguous", "in-order-morris", callbackName
+	);
+	timeTraversalCB(
+		treeInfo, postOrderMorrisTraversalCB, callback, samples, printResults, verbose, 
+		"random", "contiguous", "post-order-morris", callbackName
+	);
 	// timeTraversalLevelCB(
 	// 	treeInfo, treeQueue, levelOrderTraversalCB, callback, samples, printResults, verbose, 
 	// 	"random", "contiguous", "level-order", callbackName
@@ -42,6 +42,12 @@
 
 #define	TEST_7_N		10
 
+#define	TEST_8_N		100001
+
+/* ids in visiting order, filled by recordNode */
+int *visitOrder;
+int visitCount;
+
 
 /******************************************************************************* 
 ------------------------------- HELPER FUNCTIONS -------------------------------
@@ -519,6 +525,36 @@ void validateTraversal()
 	postOrderCB(binaryTree, callback);
 	printf("\n\n");
 
+	printf("Pre-Order Iterative Traversal: Callback = %s\n", "printNode");
+	printf("********************************************\n");
+	preOrderIterativeCB(binaryTree, callback);
+	printf("\n\n");
+
+	printf("Pre-Order Morris Traversal: Callback = %s\n", "printNode");
+	printf("********************************************\n");
+	preOrderMorrisCB(binaryTree, callback);
+	printf("\n\n");
+
+	printf("In-Order Iterative Traversal: Callback = %s\n", "printNode");
+	printf("********************************************\n");
+	inOrderIterativeCB(binaryTree, callback);
+	printf("\n\n");
+
+	printf("In-Order Morris Traversal: Callback = %s\n", "printNode");
+	printf("********************************************\n");
+	inOrderMorrisCB(binaryTree, callback);
+	printf("\n\n");
+
+	printf("Post-Order Iterative Traversal: Callback = %s\n", "printNode");
+	printf("********************************************\n");
+	postOrderIterativeCB(binaryTree, callback);
+	printf("\n\n");
+
+	printf("Post-Order Morris Traversal: Callback = %s\n", "printNode");
+	printf("********************************************\n");
+	postOrderMorrisCB(binaryTree, callback);
+	printf("\n\n");
+
 	printf("Level-Order Traversal: Callback = %s\n", "printNode");
 	printf("********************************************\n");
 	levelOrderCB(binaryTree, &treeQueue, callback);
@@ -536,6 +572,96 @@ void validateTraversal()
 	freeTQ(&treeQueue);
 }
 
+void recordNode(Tree *t)
+{
+	visitOrder[visitCount++] = t->id;
+}
+
+/* chains as deep as the tree is big: shape 0 only has left children, 1 only 
+	right ones, 2 alternates and 3 is a random tree */
+Tree * genDegenerateTree(Tree *btNodeArray, int N, int shape)
+{
+	int i;
+	bool left;
+	for (i=0; i<N; i++)
+	{
+		left = (shape == 0) || (shape == 2 && i % 2 == 0);
+		btNodeArray[i].id = i;
+		btNodeArray[i].data = NULL;
+		btNodeArray[i].left = (left && i+1 < N) ? &(btNodeArray[i+1]) : NULL;
+		btNodeArray[i].right = (!left && i+1 < N) ? &(btNodeArray[i+1]) : NULL;
+	}
+	return btNodeArray;
+}
+
+/* Morris traversals against the iterative ones (explicit stack, so any depth 
+	is fine) and against the recursive ones on the random tree, every left and 
+	right pointer has to be back in place afterwards */
+void validateStacklessTraversals()
+{
+	const char *shapes[4] = {"left", "right", "zigzag", "random"};
+	const char *names[3] = {"pre-order", "in-order", "post-order"};
+	void (*recursive[3])(Tree *, TreeCallback) = {&preOrderCB, &inOrderCB, &postOrderCB};
+	void (*iterative[3])(Tree *, TreeCallback) = {&preOrderIterativeCB, &inOrderIterativeCB, &postOrderIterativeCB};
+	void (*morris[3])(Tree *, TreeCallback) = {&preOrderMorrisCB, &inOrderMorrisCB, &postOrderMorrisCB};
+
+	int *invTable = (int *) malloc(TEST_8_N * sizeof(int));
+	int *expected = (int *) malloc(TEST_8_N * sizeof(int));
+	Tree *btNodeArray = (Tree *) malloc(TEST_8_N * sizeof(Tree));
+	Tree *links = (Tree *) malloc(TEST_8_N * sizeof(Tree));
+	ITNode *itNodeArray = (ITNode *) malloc(TEST_8_N * sizeof(ITNode));
+	Tree *root;
+	int i, k, t, mismatches, recursiveMismatches, changed;
+
+	visitOrder = (int *) malloc(TEST_8_N * sizeof(int));
+
+	printf("Stackless Traversals: N = %d\n", TEST_8_N);
+	printf("**********************************************************\n");
+	for (t=0; t<4; t++)
+	{
+		if (t < 3) root = genDegenerateTree(btNodeArray, TEST_8_N, t);
+		else root = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_8_N, false).root;
+		memcpy(links, btNodeArray, TEST_8_N * sizeof(Tree));
+
+		for (k=0; k<3; k++)
+		{
+			visitCount = 0;
+			iterative[k](root, &recordNode);
+			memcpy(expected, visitOrder, TEST_8_N * sizeof(int));
+
+			// the chains would overflow the call stack
+			recursiveMismatches = 0;
+			if (t == 3)
+			{
+				visitCount = 0;
+				recursive[k](root, &recordNode);
+				for (i=0; i<TEST_8_N; i++) recursiveMismatches += expected[i] != visitOrder[i];
+			}
+
+			visitCount = 0;
+			morris[k](root, &recordNode);
+			mismatches = (visitCount != TEST_8_N);
+			for (i=0; i<TEST_8_N; i++) mismatches += expected[i] != visitOrder[i];
+
+			for (i=0, changed=0; i<TEST_8_N; i++)
+			{
+				changed += btNodeArray[i].left != links[i].left || btNodeArray[i].right != links[i].right;
+			}
+
+			printf("%-6s %-10s: Morris Mismatches = %d , Links Changed = %d , Recursive Mismatches = %d\n", 
+				shapes[t], names[k], mismatches, changed, recursiveMismatches);
+		}
+	}
+	printf("\n");
+
+	free(invTable);
+	free(expected);
+	free(btNodeArray);
+	free(links);
+	free(itNodeArray);
+	free(visitOrder);
+}
+
 /******************************************************************************* 
 ------------------------------------- MAIN -------------------------------------
 *******************************************************************************/
@@ -587,6 +713,11 @@ int main(int argc, char *argv[])
 	printUnitTestMsg(&testNum, "Validate Tree Traversal Correctness");
 	validateTraversal();
 
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Validate Stackless Traversals on Deep Trees");
+	validateStacklessTraversals();
+
 	/* ---------------------------------------------------------------------- */
 
 	return (0);
@@ -24,7 +24,8 @@
 
 #include "types.h"
 
-#define NUM_THREADS 8
+/* env var read by getNumThreads when no -t/--threads flag is passed */
+#define NUM_THREADS_ENV "TREE_NUM_THREADS"
 
 
 
@@ -32,8 +33,12 @@
 ---------------------------- FUNCTION DECLARATIONS -----------------------------
 *******************************************************************************/
 
-/* functions for thread pool and task queue */
+/* functions for thread pool and its lock-free task queue (a task may only be 
+    submitted after claimIdleThread succeeded, otherwise run it inline) */
+extern int getNumThreads(int argc, char *argv[]);
+extern void setNumThreads(int n);
 extern void execTraversalTask(TraversalTask *task, ThreadInfo *);
+extern bool claimIdleThread();
 extern void submitTraversalTask(TraversalTask task);
 extern void * startThread(void *args);
 extern void initThreadPool();
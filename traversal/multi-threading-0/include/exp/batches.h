@@ -36,6 +36,13 @@ extern void traversalBatchCB(
 	bool printResults, bool verbose
 );
 
+/* traversalBatchCB's trees at each thread count from 1 to maxThreads, with 
+	speedup and efficiency against 1 thread */
+extern void scalingBatchCB(
+	int depth, int samples, int maxThreads, TreeCallback callback, 
+	const char callbackName[], bool printResults, bool verbose
+);
+
 
 
 #endif
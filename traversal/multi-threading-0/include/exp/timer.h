@@ -63,6 +63,15 @@ extern TimeInfo timeTraversalContCB(
 	const char traversalName[], const char callbackName[]
 );
 
+/* times traversalFunc at minThreads..maxThreads threads and prints speedup and 
+	efficiency against minThreads */
+extern TimeInfo timeTraversalScaling(
+	TreeInfo treeInfo, TraversalFuncCB traversalFunc, TreeCallback callback,
+	int minThreads, int maxThreads, int samples, bool printResults, bool verbose, 
+	const char treeType[], const char storageType[], const char traversalName[], 
+	const char callbackName[]
+);
+
 
 #endif
 /******************************************************************************* 
@@ -17,102 +17,246 @@
 /******************************************************************************* 
 ------------------------------- IMPORTS & PARAMS -------------------------------
 *******************************************************************************/
+#include <limits.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#define USE_FUTEX
+#endif
+
 #include "types.h"
 #include "threadpool.h"
 
+/* queue positions are kept on separate lines so producers and consumers 
+    don't invalidate each other */
+#define CACHE_LINE_SIZE 64
+
 
 
 /******************************************************************************* 
 ------------------------------- GLOBAL VARIABLES -------------------------------
 *******************************************************************************/
 
-pthread_t threadPool[NUM_THREADS-1];
-volatile int threadCount = 0;
+/* total threads incl. main (0 = pick with getNumThreads on first use) */
+int numThreads = 0;
+
+pthread_t *threadPool = NULL;
 
-pthread_mutex_t queueMutex;
-pthread_cond_t queueCond;
+/* workers free to take a task, a submit must claim one first */
+atomic_int threadCount = 0;
 
-bool addingTasks = false;
+atomic_bool addingTasks = false;
 
-ThreadInfo threadInfoArray[NUM_THREADS];  
+ThreadInfo *threadInfoArray = NULL;
 
 
 
 /******************************************************************************* 
----------------------------------- TASK QUEUE ----------------------------------
+----------------------------------- PARKING ------------------------------------
 *******************************************************************************/
-typedef struct TaskQueue
+#ifdef USE_FUTEX
+
+void futexWait(atomic_uint *addr, unsigned int val)
 {
-    int size;
-    int capacity;
-    int front;
-    int back;
-    TraversalTask queue[NUM_THREADS-1];
-} TaskQueue;
+    syscall(SYS_futex, (unsigned int *) addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
 
-void initTaskQueue(volatile TaskQueue *tq, int capacity)
+void futexWake(atomic_uint *addr, int count)
 {
-	tq->capacity    = capacity;
-	tq->size 	    = 0;
-	tq->front 	    = 0;
-	tq->back 	    = 0;
-	// tq->queue 	    = (TraversalTask **) malloc(capacity * sizeof(TraversalTask *));
+    syscall(SYS_futex, (unsigned int *) addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
 }
 
-// void freeTaskQueue(volatile TaskQueue *tq)
-// {
-// 	free(tq->queue);
-// 	tq->queue = NULL;
-// }
+#else
+
+/* no futex (emcc builds), emulate one with a single mutex/cond pair */
+pthread_mutex_t futexMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t futexCond = PTHREAD_COND_INITIALIZER;
 
-void resetTaskQueue(volatile TaskQueue *tq)
+void futexWait(atomic_uint *addr, unsigned int val)
 {
-    tq->capacity    = NUM_THREADS-1;
-	tq->size 	    = 0;
-	tq->front 	    = 0;
-	tq->back 	    = 0;
+    pthread_mutex_lock(&futexMutex);
+    while (atomic_load(addr) == val) pthread_cond_wait(&futexCond, &futexMutex);
+    pthread_mutex_unlock(&futexMutex);
 }
 
-bool isEmptyTaskQueue(volatile TaskQueue *tq)
+void futexWake(atomic_uint *addr, int count)
 {
-	return tq->size == 0;
+    pthread_mutex_lock(&futexMutex);
+    pthread_cond_broadcast(&futexCond);
+    pthread_mutex_unlock(&futexMutex);
 }
 
-bool isFullTaskQueue(volatile TaskQueue *tq)
+#endif
+
+/* eventcount: a waiter announces itself and reads the epoch, re-checks the 
+    queue, then sleeps only if no notify bumped the epoch in between, so 
+    notifiers only pay for a syscall when someone may be asleep */
+typedef struct EventCount
 {
-	return tq->size == tq->capacity;
+    atomic_uint epoch;
+    atomic_int waiters;
+} EventCount;
+
+EventCount queueEvent = {0};
+
+unsigned int prepareWait(EventCount *ec)
+{
+    atomic_fetch_add(&(ec->waiters), 1);
+    return atomic_load(&(ec->epoch));
+}
+
+void cancelWait(EventCount *ec)
+{
+    atomic_fetch_sub(&(ec->waiters), 1);
 }
 
-void enQueueTaskQueue(volatile TaskQueue *tq, TraversalTask t)
+void commitWait(EventCount *ec, unsigned int key)
 {
-    // printf("Enqueueing Task #: %d\n", tq->size+1);
-	tq->queue[tq->back] = t;
-	tq->back++;
-	if (tq->back == tq->capacity) { tq->back = 0;}
-	tq->size++;
+    futexWait(&(ec->epoch), key);
+    atomic_fetch_sub(&(ec->waiters), 1);
 }
 
-TraversalTask deQueueTaskQueue(volatile TaskQueue *tq)
+void notifyEvent(EventCount *ec, int count)
 {
-    // printf("Dequeueing Task #: %d\n", tq->size);
-    TraversalTask tmp = tq->queue[tq->front];
-    tq->front++;
-    if (tq->front == tq->capacity) { tq->front = 0;}
-    tq->size--;
-    return tmp;
+    atomic_fetch_add(&(ec->epoch), 1);
+    if (atomic_load(&(ec->waiters)) > 0) futexWake(&(ec->epoch), count);
 }
 
-volatile TaskQueue taskQueue = {0};
+
+
+/******************************************************************************* 
+---------------------------------- TASK QUEUE ----------------------------------
+*******************************************************************************/
+/* bounded MPMC ring (Vyukov): a cell whose sequence equals pos is free for 
+    the producer at pos, one whose sequence is pos+1 holds the consumer's task */
+typedef struct TaskCell
+{
+    atomic_size_t seq;
+    TraversalTask task;
+} TaskCell;
+
+typedef struct TaskQueue
+{
+    size_t mask;
+    TaskCell *cells;
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t enqueuePos;
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t dequeuePos;
+} TaskQueue;
+
+/* capacity is rounded up to a power of 2 (at least 2, so full and empty 
+    cells never share a sequence number) */
+void initTaskQueue(TaskQueue *tq, int capacity)
+{
+    size_t size = 2, i;
+    while (size < (size_t) capacity) size <<= 1;
+
+    tq->mask    = size - 1;
+    tq->cells   = (TaskCell *) aligned_alloc(CACHE_LINE_SIZE, size * sizeof(TaskCell));
+    for (i=0; i<size; i++)
+    {
+        atomic_init(&(tq->cells[i].seq), i);
+    }
+    atomic_init(&(tq->enqueuePos), 0);
+    atomic_init(&(tq->dequeuePos), 0);
+}
+
+void freeTaskQueue(TaskQueue *tq)
+{
+	free(tq->cells);
+	tq->cells = NULL;
+}
+
+/* returns false if the ring is full */
+bool enQueueTaskQueue(TaskQueue *tq, TraversalTask t)
+{
+    TaskCell *cell;
+    size_t pos = atomic_load_explicit(&(tq->enqueuePos), memory_order_relaxed);
+    for (;;)
+    {
+        cell = &(tq->cells[pos & tq->mask]);
+        size_t seq = atomic_load_explicit(&(cell->seq), memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&(tq->enqueuePos), &pos, pos+1, 
+                memory_order_relaxed, memory_order_relaxed)) break;
+        }
+        else if (diff < 0) return false;
+        else pos = atomic_load_explicit(&(tq->enqueuePos), memory_order_relaxed);
+    }
+
+    cell->task = t;
+    atomic_store_explicit(&(cell->seq), pos+1, memory_order_release);
+    return true;
+}
+
+/* returns false if the ring is empty */
+bool deQueueTaskQueue(TaskQueue *tq, TraversalTask *t)
+{
+    TaskCell *cell;
+    size_t pos = atomic_load_explicit(&(tq->dequeuePos), memory_order_relaxed);
+    for (;;)
+    {
+        cell = &(tq->cells[pos & tq->mask]);
+        size_t seq = atomic_load_explicit(&(cell->seq), memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) (pos+1);
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&(tq->dequeuePos), &pos, pos+1, 
+                memory_order_relaxed, memory_order_relaxed)) break;
+        }
+        else if (diff < 0) return false;
+        else pos = atomic_load_explicit(&(tq->dequeuePos), memory_order_relaxed);
+    }
+
+    *t = cell->task;
+    atomic_store_explicit(&(cell->seq), pos + tq->mask + 1, memory_order_release);
+    return true;
+}
+
+TaskQueue taskQueue;
 
 /******************************************************************************* 
 ------------------------------- THREAD FUNCTIONS -------------------------------
 *******************************************************************************/
+/* total threads (workers + main) from -t N / --threads N / --threads=N, then 
+    NUM_THREADS_ENV, then the number of online cores (copy of the one in 
+    traversal/multi-threading-new/src/core/threadpool.c, keep them identical) */
+int getNumThreads(int argc, char *argv[])
+{
+    const char *value = NULL;
+    int i;
+    for (i=1; i<argc; i++)
+    {
+        if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) && i+1 < argc)
+        {
+            value = argv[i+1];
+        }
+        else if (strncmp(argv[i], "--threads=", 10) == 0)
+        {
+            value = argv[i] + 10;
+        }
+    }
+    if (value == NULL) value = getenv(NUM_THREADS_ENV);
+
+    int count = (value != NULL) ? atoi(value) : 0;
+    if (count <= 0) count = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (count <= 0) count = 1;
+    return count;
+}
+
+void setNumThreads(int n)
+{
+    numThreads = n;
+}
 
 void execTraversalTask(TraversalTask *task, ThreadInfo *threadInfo)
 {
@@ -123,13 +267,24 @@ void execTraversalTask(TraversalTask *task, ThreadInfo *threadInfo)
     // task->callback(task->root);
 }
 
+/* cheap relaxed check first, the CAS only runs when a worker looks idle, 
+    every claimed worker gets exactly one submitted task */
+bool claimIdleThread()
+{
+    int idle = atomic_load_explicit(&threadCount, memory_order_relaxed);
+    while (idle > 0)
+    {
+        if (atomic_compare_exchange_weak(&threadCount, &idle, idle-1)) return true;
+    }
+    return false;
+}
+
+/* caller must have claimed a worker, so the ring (sized to the worker 
+    count) can never be full here */
 void submitTraversalTask(TraversalTask task)
 {   
-    pthread_mutex_lock(&queueMutex);
     enQueueTaskQueue(&taskQueue, task);
-    threadCount--;
-    pthread_mutex_unlock(&queueMutex);
-    pthread_cond_signal(&queueCond);
+    notifyEvent(&queueEvent, 1);
 }
 
 void * startThread(void *args)
@@ -138,32 +293,37 @@ void * startThread(void *args)
     ThreadInfo *threadInfo = (ThreadInfo *) args;
     // printf("Starting Thread: %d\n", threadInfo->threadID);
 
+    TraversalTask task;
+    unsigned int key;
+    bool adding;
     for (;;)
     {
-        if (!addingTasks && isEmptyTaskQueue(&taskQueue)) break;
-
-        TraversalTask task;
-
-        pthread_mutex_lock(&queueMutex);
-        while (addingTasks && isEmptyTaskQueue(&taskQueue))
+        if (!deQueueTaskQueue(&taskQueue, &task))
         {
-            pthread_cond_wait(&queueCond, &queueMutex);
+            // re-check after announcing, a task or join may have slipped in
+            // (join is read first: anything submitted before it is visible)
+            key = prepareWait(&queueEvent);
+            adding = atomic_load(&addingTasks);
+            if (deQueueTaskQueue(&taskQueue, &task))
+            {
+                cancelWait(&queueEvent);
+            }
+            else if (!adding)
+            {
+                // whoever still runs a task drains what it submits
+                cancelWait(&queueEvent);
+                break;
+            }
+            else
+            {
+                commitWait(&queueEvent, key);
+                continue;
+            }
         }
 
-        if (!addingTasks && isEmptyTaskQueue(&taskQueue)) {
-            pthread_mutex_unlock(&queueMutex);
-            break;
-        };
-
-        // this queue can be improved/optimized
-        task = deQueueTaskQueue(&taskQueue);
-        pthread_mutex_unlock(&queueMutex);
         // printf("Executing Task: Node ID = %d\n", task.root->id);
         execTraversalTask(&task, threadInfo); 
-
-        pthread_mutex_lock(&queueMutex);
-        threadCount++;
-        pthread_mutex_unlock(&queueMutex);
+        atomic_fetch_add(&threadCount, 1);
     }
 
     // printf("Finishing Thread\n");
@@ -175,19 +335,20 @@ void initThreadPool()
 {
     // printf("Initializing Threads from Main Thread\n");
 
-    pthread_mutex_init(&queueMutex, NULL);
-    pthread_cond_init(&queueCond, NULL);
+    if (numThreads <= 0) numThreads = getNumThreads(0, NULL);
+    threadPool = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
+    threadInfoArray = (ThreadInfo *) malloc(numThreads * sizeof(ThreadInfo));
+    initTaskQueue(&taskQueue, numThreads);
 
-    resetTaskQueue(&taskQueue);
-    threadCount = NUM_THREADS-1;
-    addingTasks = true;
+    atomic_store(&threadCount, numThreads-1);
+    atomic_store(&addingTasks, true);
 
     threadInfoArray[0].threadID = 0;
     threadInfoArray[0].tasks = 1;
     threadInfoArray[0].callbacks = 0;
 
     int t;
-    for (t=0; t<NUM_THREADS-1; t++)
+    for (t=0; t<numThreads-1; t++)
     {
         threadInfoArray[t+1].threadID = t+1;
         threadInfoArray[t+1].tasks = 0;
@@ -207,15 +368,13 @@ void joinThreadPool()
 {
     // printf("Joining Threads from Main Thread\n");
 
-    pthread_mutex_lock(&queueMutex);
-    addingTasks = false;
-    pthread_cond_broadcast(&queueCond);
-    pthread_mutex_unlock(&queueMutex);
+    atomic_store(&addingTasks, false);
+    notifyEvent(&queueEvent, INT_MAX);
 
     // printf("Set Adding Tasks to False\n");
 
     int t;
-    for (t=0; t<NUM_THREADS-1; t++)
+    for (t=0; t<numThreads-1; t++)
     {
         if (pthread_join(threadPool[t], NULL) != 0)
         {
@@ -224,7 +383,7 @@ void joinThreadPool()
     }
 
     int i;
-    for (i=0; i<NUM_THREADS; i++)
+    for (i=0; i<numThreads; i++)
     {
         printf(
             "Thread: %d , Tasks: %d , Callbacks: %d\n", 
@@ -232,11 +391,10 @@ void joinThreadPool()
         );
     }
 
-    threadCount = 0;
-    // freeTaskQueue(&taskQueue);
-
-    pthread_mutex_destroy(&queueMutex);
-    pthread_cond_destroy(&queueCond);
+    atomic_store(&threadCount, 0);
+    freeTaskQueue(&taskQueue);
+    free(threadInfoArray);
+    free(threadPool);
 
     // printf("Finished Joining Threads from Main Thread\n");
 }
@@ -703,16 +861,6 @@ void joinThreadPool()
 
 
 
-int getThreadCount()
-{
-    // pthread_mutex_lock(&queueMutex);
-    int count = threadCount;
-    // pthread_mutex_unlock(&queueMutex);
-    return count;
-    // printf("Thread Count: %d\n", count);
-    // return 1;
-}
-
 void preOrderMT(Tree * root, TreeCallback callback, ThreadInfo *threadInfo)
 {
     callback(root);
@@ -720,7 +868,7 @@ void preOrderMT(Tree * root, TreeCallback callback, ThreadInfo *threadInfo)
 
 	if (root->left != NULL)
 	{
-        if (getThreadCount() > 0)
+        if (claimIdleThread())
         {
             TraversalTask task = {
                 .traversalFunc = preOrderMT,
@@ -737,7 +885,7 @@ void preOrderMT(Tree * root, TreeCallback callback, ThreadInfo *threadInfo)
 
 	if (root->right != NULL)
 	{
-        if (getThreadCount() > 0)
+        if (claimIdleThread())
         {
             TraversalTask task = {
                 .traversalFunc = preOrderMT,
@@ -761,7 +909,7 @@ void masterPreOrderMT(Tree *root, TreeCallback callback, ThreadInfo *threadInfo)
 	{
         if (root->right != NULL)
         {
-            if (getThreadCount() > 0)
+            if (claimIdleThread())
             {
                 TraversalTask task = {
                     .traversalFunc = preOrderMT,
@@ -803,7 +951,7 @@ void postOrderMT(Tree *root, TreeCallback callback, ThreadInfo *threadInfo)
 {
 	if (root->left != NULL)
 	{
-        if (getThreadCount() > 0)
+        if (claimIdleThread())
         {
             TraversalTask task = {
                 .traversalFunc = postOrderMT,
@@ -820,7 +968,7 @@ void postOrderMT(Tree *root, TreeCallback callback, ThreadInfo *threadInfo)
 
 	if (root->right != NULL)
 	{
-        if (getThreadCount() > 0)
+        if (claimIdleThread())
         {
             TraversalTask task = {
                 .traversalFunc = postOrderMT,
@@ -844,7 +992,7 @@ void masterPostOrderMT(Tree *root, TreeCallback callback, ThreadInfo *threadInfo
 	{
         if (root->right != NULL)
         {
-            if (getThreadCount() > 0)
+            if (claimIdleThread())
             {
                 TraversalTask task = {
                     .traversalFunc = postOrderMT,
@@ -17,6 +17,7 @@
 ------------------------------- IMPORTS & PARAMS -------------------------------
 *******************************************************************************/
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "binaryTree.h"
@@ -132,6 +133,89 @@ void traversalBatchCB(
 
 /* -------------------------------------------------------------------------- */
 
+/* traversalBatchCB's trees, each timed at every thread count by 
+	timeTraversalScaling, speedup and efficiency are against 1 thread */
+void scalingBatchCB(
+	int depth, int samples, int maxThreads, TreeCallback callback, 
+	const char callbackName[], bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+	int minThreads = 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+
+	TraversalFuncCB preOrderTraversalCB = &preOrderMTWrapper;
+	TraversalFuncCB postOrderTraversalCB = &postOrderMTWrapper;
+
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genRandomTreeOptimized(invTable, itNodeArray, N, false);
+	timeTraversalScaling(
+		treeInfo, preOrderTraversalCB, callback, minThreads, maxThreads, samples, 
+		printResults, verbose, "random", "fragmented", "pre-order", callbackName
+	);
+	timeTraversalScaling(
+		treeInfo, postOrderTraversalCB, callback, minThreads, maxThreads, samples, 
+		printResults, verbose, "random", "fragmented", "post-order", callbackName
+	);
+	make_empty(treeInfo.root);
+
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, N, false);
+	timeTraversalScaling(
+		treeInfo, preOrderTraversalCB, callback, minThreads, maxThreads, samples, 
+		printResults, verbose, "random", "contiguous", "pre-order", callbackName
+	);
+	timeTraversalScaling(
+		treeInfo, postOrderTraversalCB, callback, minThreads, maxThreads, samples, 
+		printResults, verbose, "random", "contiguous", "post-order", callbackName
+	);
+
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genBalancedTreeOptimized(invTable, itNodeArray, depth, false);
+	timeTraversalScaling(
+		treeInfo, preOrderTraversalCB, callback, minThreads, maxThreads, samples, 
+		printResults, verbose, "balanced", "fragmented", "pre-order", callbackName
+	);
+	timeTraversalScaling(
+		treeInfo, postOrderTraversalCB, callback, minThreads, maxThreads, samples, 
+		printResults, verbose, "balanced", "fragmented", "post-order", callbackName
+	);
+	make_empty(treeInfo.root);
+
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, false);
+	timeTraversalScaling(
+		treeInfo, preOrderTraversalCB, callback, minThreads, maxThreads, samples, 
+		printResults, verbose, "balanced", "contiguous", "pre-order", callbackName
+	);
+	timeTraversalScaling(
+		treeInfo, postOrderTraversalCB, callback, minThreads, maxThreads, samples, 
+		printResults, verbose, "balanced", "contiguous", "post-order", callbackName
+	);
+
+	/* ---------------------------------------------------------------------- */
+
+	setNumThreads(maxThreads);
+
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
 /******************************************************************************* 
 --------------------------------- END OF FILE ----------------------------------
 *******************************************************************************/
\ No newline at end of file
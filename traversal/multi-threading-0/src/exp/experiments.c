@@ -18,8 +18,10 @@
 *******************************************************************************/
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "binaryTree.h"
+#include "threadpool.h"
 #include "util.h"
 
 #include "batches.h"
@@ -49,6 +51,16 @@ int main(int argc, char *argv[])
 	bool printResults = true;
 	bool verbose = false;
 
+	// usage: exp [scale] [-t numThreads] (or set TREE_NUM_THREADS)
+	int numThreads = getNumThreads(argc, argv);
+	bool scaleMode = false;
+	int a;
+	for (a=1; a<argc; a++)
+	{
+		if (strcmp(argv[a], "scale") == 0) scaleMode = true;
+	}
+	setNumThreads(numThreads);
+
 	/* ---------------------------------------------------------------------- */
 	int depth, i, runs;
 
@@ -66,6 +78,19 @@ int main(int argc, char *argv[])
 			// else 					{runs = 1;}
 			runs = 1;
 
+			if (scaleMode)
+			{
+				scalingBatchCB(
+					depth, runs, numThreads, incrementCallback,
+					"increment-id", printResults, verbose
+				);
+				scalingBatchCB(
+					depth, runs, numThreads, searchCallback,
+					"search-id", printResults, verbose
+				);
+				continue;
+			}
+
 			// traversalBatch(depth, runs, printResults, verbose);
 
 			traversalBatchCB(depth, runs, incrementCallback, "increment-id", printResults, verbose);
@@ -23,6 +23,7 @@
 
 #include "types.h"
 #include "queue.h"
+#include "threadpool.h"
 
 #include "exp.h"
 
@@ -59,6 +60,29 @@ double wallTimeDiff(struct timeval start, struct timeval end)
 	return (double) micros / 1000000;
 }
 
+/* one row per thread count, speedup and efficiency are against the first count */
+void printScaleResults(
+	TreeInfo treeInfo, TimeInfo timeInfo, int numThreads, double speedup, 
+	double efficiency, const char treeType[], const char storageType[], 
+	const char traversalType[], const char callbackName[], bool verbose
+)
+{
+	if (verbose)
+	{
+		fprintf(
+			stdout, "TreeType = %s , StorageType = %s , TraversalType = %s , Callback = %s , N = %d , Depth = %d , Threads = %d , Samples = %d , AvgWallSeconds = %f , Speedup = %.3f , Efficiency = %.3f\n",
+			treeType, storageType, traversalType, callbackName, treeInfo.size, treeInfo.depth, numThreads, timeInfo.samples, timeInfo.avgWallTime, speedup, efficiency
+		);
+	}
+	else
+	{
+		fprintf(
+			stdout, "%s,%s,%s,%s,%d,%f,%f,%f\n",
+			treeType, storageType, traversalType, callbackName, numThreads, timeInfo.avgWallTime, speedup, efficiency
+		);
+	}
+}
+
 
 
 /******************************************************************************* 
@@ -323,6 +347,47 @@ TimeInfo timeTraversalContCB(
 
 /* -------------------------------------------------------------------------- */
 
+/* every traversal starts its own pool of numThreads, so the sweep only has to 
+	setNumThreads before timing. efficiency is speedup over the thread ratio, 
+	so the first count always reads 1 */
+TimeInfo timeTraversalScaling(
+	TreeInfo treeInfo, TraversalFuncCB traversalFunc, TreeCallback callback,
+	int minThreads, int maxThreads, int samples, bool printResults, bool verbose, 
+	const char treeType[], const char storageType[], const char traversalName[], 
+	const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+	double baseWallTime = 0;
+	double speedup, efficiency;
+
+	int n;
+	for (n=minThreads; n<=maxThreads; n++)
+	{
+		setNumThreads(n);
+		timeInfo = timeTraversalCB(
+			treeInfo, traversalFunc, callback, samples, false, verbose, 
+			treeType, storageType, traversalName, callbackName
+		);
+		if (n == minThreads) baseWallTime = timeInfo.avgWallTime;
+
+		speedup = (timeInfo.avgWallTime > 0) ? baseWallTime / timeInfo.avgWallTime : 0;
+		efficiency = speedup * minThreads / n;
+
+		if (printResults)
+		{
+			printScaleResults(
+				treeInfo, timeInfo, n, speedup, efficiency, treeType, 
+				storageType, traversalName, callbackName, verbose
+			);
+		}
+	}
+
+	return timeInfo;
+}
+
+/* -------------------------------------------------------------------------- */
+
 /******************************************************************************* 
 --------------------------------- END OF FILE ----------------------------------
 *******************************************************************************/
\ No newline at end of file
@@ -46,6 +46,9 @@
 #define	TEST_8_N		15
 #define TEST_8_DEPTH	3
 
+#define TEST_9_DEPTH	14
+#define TEST_9_RUNS		4
+
 
 /******************************************************************************* 
 ------------------------------- HELPER FUNCTIONS -------------------------------
@@ -604,6 +607,43 @@ void validateMultiThread()
 	
 }
 
+/* every multi-threaded traversal must reach each node exactly once, many 
+	small tasks go through the lock-free queue on the balanced tree */
+void validateTaskQueue()
+{
+	int N = (1<<(TEST_9_DEPTH+1)) - 1;
+	int *invTable = (int *) malloc(N * sizeof(int));
+	Tree *btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	ITNode *itNodeArray = (ITNode *) malloc(N * sizeof(ITNode));
+	int *ids = (int *) malloc(N * sizeof(int));
+	const char *treeTypes[2] = {"Random", "Balanced"};
+	TreeInfo treeInfo;
+	int i, r, t, wrong[2];
+
+	for (t=0; t<2; t++)
+	{
+		if (t == 0) treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, N, false);
+		else treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_9_DEPTH, false);
+		for (i=0; i<N; i++) ids[i] = btNodeArray[i].id;
+
+		wrong[0] = wrong[1] = 0;
+		for (r=1; r<=TEST_9_RUNS; r++)
+		{
+			preOrderMTWrapper(treeInfo.root, &incrementID);
+			for (i=0; i<N; i++) wrong[0] += btNodeArray[i].id != ids[i] + 2*r-1;
+			postOrderMTWrapper(treeInfo.root, &incrementID);
+			for (i=0; i<N; i++) wrong[1] += btNodeArray[i].id != ids[i] + 2*r;
+		}
+		printf("\n%s Tree: N = %d , Runs = %d , Pre-Order Wrong = %d , Post-Order Wrong = %d\n\n", 
+			treeTypes[t], N, TEST_9_RUNS, wrong[0], wrong[1]);
+	}
+
+	free(ids);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
 /******************************************************************************* 
 ------------------------------------- MAIN -------------------------------------
 *******************************************************************************/
@@ -618,6 +658,7 @@ int main(int argc, char *argv[])
 
 	int testNum = 1;
 	init_genrand64(time(0));
+	setNumThreads(getNumThreads(argc, argv));
 
 
 	/* ---------------------------------------------------------------------- */
@@ -662,6 +703,11 @@ int main(int argc, char *argv[])
 
 	/* ---------------------------------------------------------------------- */
 
+	printUnitTestMsg(&testNum, "Validate Lock-Free Task Queue Under Load");
+	validateTaskQueue();
+
+	/* ---------------------------------------------------------------------- */
+
 	return (0);
 }
 
@@ -24,7 +24,8 @@
 
 #include "types.h"
 
-#define NUM_THREADS 5
+/* env var read by getNumThreads when no -t/--threads flag is passed */
+#define NUM_THREADS_ENV "TREE_NUM_THREADS"
 #define TASK_QUEUE_SIZE 1<<16
 
 
@@ -34,6 +35,8 @@
 *******************************************************************************/
 
 /* functions for thread pool and task queue */
+extern int getNumThreads(int argc, char *argv[]);
+extern void setNumThreads(int n);
 extern void execTraversalTask(TraversalTask *task);
 extern void submitTraversalTask(TraversalTask task);
 extern void * startThread(void *args);
@@ -36,6 +36,13 @@ extern void traversalBatchCB(
 	bool printResults, bool verbose
 );
 
+/* traversalBatchCB's trees at each thread count from 2 (main + 1 worker) to 
+	maxThreads, with speedup and efficiency against 2 threads */
+extern void scalingBatchCB(
+	int depth, int samples, int maxThreads, TreeCallback callback, 
+	const char callbackName[], bool printResults, bool verbose
+);
+
 
 
 #endif
@@ -21,6 +21,8 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "types.h"
 #include "threadpool.h"
@@ -31,7 +33,10 @@
 ------------------------------- GLOBAL VARIABLES -------------------------------
 *******************************************************************************/
 
-pthread_t threadPool[NUM_THREADS-1];
+/* total threads incl. main (0 = pick with getNumThreads on first use) */
+int numThreads = 0;
+
+pthread_t *threadPool = NULL;
 volatile int threadCount = 0;
 
 TraversalTask taskQueue[TASK_QUEUE_SIZE];
@@ -45,6 +50,37 @@ bool addingTasks = false;
 /******************************************************************************* 
 ------------------------------- THREAD FUNCTIONS -------------------------------
 *******************************************************************************/
+/* total threads (workers + main) from -t N / --threads N / --threads=N, then 
+    NUM_THREADS_ENV, then the number of online cores (copy of the one in 
+    traversal/multi-threading-new/src/core/threadpool.c, keep them identical) */
+int getNumThreads(int argc, char *argv[])
+{
+    const char *value = NULL;
+    int i;
+    for (i=1; i<argc; i++)
+    {
+        if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) && i+1 < argc)
+        {
+            value = argv[i+1];
+        }
+        else if (strncmp(argv[i], "--threads=", 10) == 0)
+        {
+            value = argv[i] + 10;
+        }
+    }
+    if (value == NULL) value = getenv(NUM_THREADS_ENV);
+
+    int count = (value != NULL) ? atoi(value) : 0;
+    if (count <= 0) count = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (count <= 0) count = 1;
+    return count;
+}
+
+void setNumThreads(int n)
+{
+    numThreads = n;
+}
+
 
 void execTraversalTask(TraversalTask *task)
 {
@@ -104,13 +140,18 @@ void initThreadPool()
 {
     // printf("Initializing Threads from Main Thread\n");
 
+    if (numThreads <= 0) numThreads = getNumThreads(0, NULL);
+    // main only submits tasks, so at least one worker has to drain the queue
+    if (numThreads < 2) numThreads = 2;
+    threadPool = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
+
     pthread_mutex_init(&queueMutex, NULL);
     pthread_cond_init(&queueCond, NULL);
 
     addingTasks = true;
 
     int t;
-    for (t=0; t<NUM_THREADS-1; t++)
+    for (t=0; t<numThreads-1; t++)
     {
         if (pthread_create(&threadPool[t], NULL, &startThread, NULL) != 0)
         {
@@ -137,7 +178,7 @@ void joinThreadPool()
     // printf("Set Adding Tasks to False\n");
 
     int t;
-    for (t=0; t<NUM_THREADS-1; t++)
+    for (t=0; t<numThreads-1; t++)
     {
         if (pthread_join(threadPool[t], NULL) != 0)
         {
@@ -153,6 +194,9 @@ void joinThreadPool()
     pthread_mutex_destroy(&queueMutex);
     pthread_cond_destroy(&queueCond);
 
+    free(threadPool);
+    threadPool = NULL;
+
     // printf("Finished Joining Threads from Main Thread\n");
 }
 
@@ -19,9 +19,11 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <time.h>
+#include <sys/time.h>
 
 #include "types.h"
 #include "queue.h"
+#include "threadpool.h"
 
 #include "exp.h"
 
@@ -51,6 +53,36 @@ void printExpResults(
 	}
 }
 
+double wallTimeDiff(struct timeval start, struct timeval end)
+{
+    long seconds = (end.tv_sec - start.tv_sec);
+    long micros = ((seconds * 1000000) + end.tv_usec) - (start.tv_usec);
+	return (double) micros / 1000000;
+}
+
+/* one row per thread count, speedup and efficiency are against the first count */
+void printScaleResults(
+	TreeInfo treeInfo, TimeInfo timeInfo, int numThreads, double speedup, 
+	double efficiency, const char treeType[], const char storageType[], 
+	const char traversalType[], const char callbackName[], bool verbose
+)
+{
+	if (verbose)
+	{
+		fprintf(
+			stdout, "TreeType = %s , StorageType = %s , TraversalType = %s , Callback = %s , N = %d , Depth = %d , Threads = %d , Samples = %d , AvgWallSeconds = %f , Speedup = %.3f , Efficiency = %.3f\n",
+			treeType, storageType, traversalType, callbackName, treeInfo.size, treeInfo.depth, numThreads, timeInfo.samples, timeInfo.avgWallTime, speedup, efficiency
+		);
+	}
+	else
+	{
+		fprintf(
+			stdout, "%s,%s,%s,%s,%d,%f,%f,%f\n",
+			treeType, storageType, traversalType, callbackName, numThreads, timeInfo.avgWallTime, speedup, efficiency
+		);
+	}
+}
+
 // void mem_flush(const void *p, unsigned int allocation_size){
 //     const size_t cache_line = 64;
 //     const char *cp = (const char *)p;
@@ -102,21 +134,26 @@ TimeInfo timeTraversal(
 
 	int i;
 	clock_t tic, toc;
+	struct timeval startTime, endTime;
 
 	// mem_flush(treeInfo.root, treeInfo.size * sizeof(Tree));
 
+	gettimeofday(&startTime, NULL);
 	tic = clock();
 	for (i=0; i<samples; i++)
 	{
 		traversalFunc(treeInfo.root);
 	}
 	toc = clock();
+	gettimeofday(&endTime, NULL);
 
-	timeInfo.samples 	= samples;
-	timeInfo.cycles		= toc - tic;
-	timeInfo.seconds	= (double) (toc - tic) / CLOCKS_PER_SEC;
-	timeInfo.avgCycles	= (double) timeInfo.cycles / timeInfo.samples;
-	timeInfo.avgSeconds	= timeInfo.seconds / timeInfo.samples;
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
 
 	if (printResults)
 	{
@@ -141,19 +178,24 @@ TimeInfo timeTraversalCB(
 
 	int i;
 	clock_t tic, toc;
+	struct timeval startTime, endTime;
 
+	gettimeofday(&startTime, NULL);
 	tic = clock();
 	for (i=0; i<samples; i++)
 	{
 		traversalFunc(treeInfo.root, callback);
 	}
 	toc = clock();
+	gettimeofday(&endTime, NULL);
 
-	timeInfo.samples 	= samples;
-	timeInfo.cycles		= toc - tic;
-	timeInfo.seconds	= (double) (toc - tic) / CLOCKS_PER_SEC;
-	timeInfo.avgCycles	= (double) timeInfo.cycles / timeInfo.samples;
-	timeInfo.avgSeconds	= timeInfo.seconds / timeInfo.samples;
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
 
 	if (printResults)
 	{
@@ -178,19 +220,24 @@ TimeInfo timeTraversalLevel(
 
 	int i;
 	clock_t tic, toc;
+	struct timeval startTime, endTime;
 
+	gettimeofday(&startTime, NULL);
 	tic = clock();
 	for (i=0; i<samples; i++)
 	{
 		traversalFunc(treeInfo.root, treeQueue);
 	}
 	toc = clock();
+	gettimeofday(&endTime, NULL);
 
-	timeInfo.samples 	= samples;
-	timeInfo.cycles		= toc - tic;
-	timeInfo.seconds	= (double) (toc - tic) / CLOCKS_PER_SEC;
-	timeInfo.avgCycles	= (double) timeInfo.cycles / timeInfo.samples;
-	timeInfo.avgSeconds	= timeInfo.seconds / timeInfo.samples;
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
 
 	if (printResults)
 	{
@@ -217,19 +264,24 @@ TimeInfo timeTraversalLevelCB(
 
 	int i;
 	clock_t tic, toc;
+	struct timeval startTime, endTime;
 
+	gettimeofday(&startTime, NULL);
 	tic = clock();
 	for (i=0; i<samples; i++)
 	{
 		traversalFunc(treeInfo.root, treeQueue, callback);
 	}
 	toc = clock();
+	gettimeofday(&endTime, NULL);
 
-	timeInfo.samples 	= samples;
-	timeInfo.cycles		= toc - tic;
-	timeInfo.seconds	= (double) (toc - tic) / CLOCKS_PER_SEC;
-	timeInfo.avgCycles	= (double) timeInfo.cycles / timeInfo.samples;
-	timeInfo.avgSeconds	= timeInfo.seconds / timeInfo.samples;
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
 
 	if (printResults)
 	{
@@ -256,19 +308,24 @@ TimeInfo timeTraversalCont(
 
 	int i;
 	clock_t tic, toc;
+	struct timeval startTime, endTime;
 
+	gettimeofday(&startTime, NULL);
 	tic = clock();
 	for (i=0; i<samples; i++)
 	{
 		traversalFunc(btNodeArray, treeInfo.size);
 	}
 	toc = clock();
+	gettimeofday(&endTime, NULL);
 
-	timeInfo.samples 	= samples;
-	timeInfo.cycles		= toc - tic;
-	timeInfo.seconds	= (double) (toc - tic) / CLOCKS_PER_SEC;
-	timeInfo.avgCycles	= (double) timeInfo.cycles / timeInfo.samples;
-	timeInfo.avgSeconds	= timeInfo.seconds / timeInfo.samples;
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
 
 	if (printResults)
 	{
@@ -293,19 +350,24 @@ TimeInfo timeTraversalContCB(
 
 	int i;
 	clock_t tic, toc;
+	struct timeval startTime, endTime;
 
+	gettimeofday(&startTime, NULL);
 	tic = clock();
 	for (i=0; i<samples; i++)
 	{
 		traversalFunc(btNodeArray, treeInfo.size, callback);
 	}
 	toc = clock();
+	gettimeofday(&endTime, NULL);
 
-	timeInfo.samples 	= samples;
-	timeInfo.cycles		= toc - tic;
-	timeInfo.seconds	= (double) (toc - tic) / CLOCKS_PER_SEC;
-	timeInfo.avgCycles	= (double) timeInfo.cycles / timeInfo.samples;
-	timeInfo.avgSeconds	= timeInfo.seconds / timeInfo.samples;
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
 
 	if (printResults)
 	{
@@ -320,6 +382,47 @@ TimeInfo timeTraversalContCB(
 
 /* -------------------------------------------------------------------------- */
 
+/* every traversal starts its own pool of numThreads, so the sweep only has to 
+	setNumThreads before timing. efficiency is speedup over the thread ratio, 
+	so the first count always reads 1 */
+TimeInfo timeTraversalScaling(
+	TreeInfo treeInfo, TraversalFuncCB traversalFunc, TreeCallback callback,
+	int minThreads, int maxThreads, int samples, bool printResults, bool verbose, 
+	const char treeType[], const char storageType[], const char traversalName[], 
+	const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+	double baseWallTime = 0;
+	double speedup, efficiency;
+
+	int n;
+	for (n=minThreads; n<=maxThreads; n++)
+	{
+		setNumThreads(n);
+		timeInfo = timeTraversalCB(
+			treeInfo, traversalFunc, callback, samples, false, verbose, 
+			treeType, storageType, traversalName, callbackName
+		);
+		if (n == minThreads) baseWallTime = timeInfo.avgWallTime;
+
+		speedup = (timeInfo.avgWallTime > 0) ? baseWallTime / timeInfo.avgWallTime : 0;
+		efficiency = speedup * minThreads / n;
+
+		if (printResults)
+		{
+			printScaleResults(
+				treeInfo, timeInfo, n, speedup, efficiency, treeType, 
+				storageType, traversalName, callbackName, verbose
+			);
+		}
+	}
+
+	return timeInfo;
+}
+
+/* -------------------------------------------------------------------------- */
+
 /******************************************************************************* 
 --------------------------------- END OF FILE ----------------------------------
 *******************************************************************************/
\ No newline at end of file
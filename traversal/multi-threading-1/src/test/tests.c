@@ -595,6 +595,7 @@ int main(int argc, char *argv[])
 
 	int testNum = 1;
 	init_genrand64(time(0));
+	setNumThreads(getNumThreads(argc, argv));
 
 
 	/* ---------------------------------------------------------------------- */
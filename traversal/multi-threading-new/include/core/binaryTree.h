@@ -35,17 +35,35 @@ extern Tree * make_empty(Tree *t);
 extern Tree * find_min(Tree *t);
 extern Tree * find_max(Tree *t);
 extern Tree * find(int id, Tree *t);
+extern void findBatch(int *keys, int n, Tree **results, Tree *t);
+extern void findBatchGroup(int *keys, int n, Tree **results, Tree *t, int group);
 extern Tree * insert(int id, void *data, Tree *t);
 extern Tree * delete(int id, Tree * t, void *data);
+extern void setBalanceMode(BalanceMode mode);
+extern BalanceMode getBalanceMode();
+extern const char * balanceModeName(BalanceMode mode);
 extern void printNode(Tree *t);
 extern void printNodeStdErr(Tree *t);
 extern void incrementID(Tree *t);
 extern void searchKey(Tree *t);
 extern void sleepNode(Tree *t);
 extern void randArray(Tree *t);
+extern void setSearchTreeDepth(int depth);
+extern int getSearchTreeDepth();
+extern void setSearchStructure(SearchStructure structure);
+extern SearchStructure getSearchStructure();
 extern void initSearchTree();
 extern void freeSearchTree();
+extern Tree * findSearchTree(int id);
 extern void searchTreeBenchmark(Tree *t);
+extern void incrementIDCompact(CompactTree *t);
+extern void searchKeyCompact(CompactTree *t);
+extern void sleepNodeCompact(CompactTree *t);
+extern void randArrayCompact(CompactTree *t);
+extern void incrementIDBatch(Tree **nodes, int n, void *ctx);
+extern void searchKeyBatch(Tree **nodes, int n, void *ctx);
+extern void randArrayBatch(Tree **nodes, int n, void *ctx);
+extern void searchTreeBenchmarkBatch(Tree **nodes, int n, void *ctx);
 
 /* traversals */
 extern void preOrder(Tree *root);
@@ -59,6 +77,54 @@ extern void postOrderCB(Tree *root, TreeCallback callBack);
 extern void levelOrderCB(Tree *root, TreeQueue *treeQueue, TreeCallback callBack);
 extern void contiguousOrderCB(Tree *treeArray, int N, TreeCallback callBack);
 
+/* software-prefetching traversals, the look-ahead distance is shared */
+extern void setPrefetchDistance(int distance);
+extern int getPrefetchDistance();
+extern void preOrderPrefetchCB(Tree *root, TreeCallback callback);
+extern void postOrderPrefetchCB(Tree *root, TreeCallback callback);
+extern void preOrderLookaheadCB(Tree *root, TreeCallback callback);
+
+/* batched traversals buffer CALLBACK_BATCH_SIZE nodes per callback */
+extern void initTreeBatch(TreeBatch *batch, TreeBatchCallback callback, void *ctx);
+extern void flushTreeBatch(TreeBatch *batch);
+extern void pushTreeBatch(TreeBatch *batch, Tree *node);
+extern void preOrderBatchFill(Tree *root, TreeBatch *batch);
+extern void preOrderBatchCB(Tree *root, TreeBatchCallback callback, void *ctx);
+extern void postOrderBatchCB(Tree *root, TreeBatchCallback callback, void *ctx);
+extern void levelOrderBatchCB(Tree *root, TreeQueue *treeQueue, TreeBatchCallback callback, void *ctx);
+extern void contiguousOrderBatchCB(Tree *treeArray, int N, TreeBatchCallback callback, void *ctx);
+
+/* serial reduce over all nodes, see traverseReduce for the multi-threaded one */
+extern int64_t preOrderReduce(Tree *root, ReduceOp *op, int64_t acc);
+extern int64_t traverseReduceSerial(Tree *root, ReduceMap map, ReduceCombine combine, int64_t identity, void *ctx);
+extern void preOrderReduceAcc(Tree *root, ReduceAccOp *op, void *acc);
+
+/* serial find-first, stops at the first match in pre-order */
+extern Tree * preOrderFind(Tree *root, TreePredicate predicate, void *ctx);
+extern bool matchKeyPredicate(Tree *t, void *ctx);
+extern Tree * findKeyMT(int id, Tree *root, ThreadPool *threadPool, StartThreadArgs *startArgs);
+
+/* maps and combines the callbacks above are rebuilt on (searchKeyMT and the 
+	statistics below are race-free versions of searchKey and friends), the 
+	treeStats accumulator gathers every statistic in one pass */
+extern int64_t countMap(Tree *t, void *ctx);
+extern int64_t matchKeyMap(Tree *t, void *ctx);
+extern int64_t idMap(Tree *t, void *ctx);
+extern int64_t leafMap(Tree *t, void *ctx);
+extern int64_t addCombine(int64_t a, int64_t b);
+extern int64_t minCombine(int64_t a, int64_t b);
+extern int64_t maxCombine(int64_t a, int64_t b);
+extern void treeStatsInit(void *acc);
+extern void treeStatsFold(void *acc, Tree *t, void *ctx);
+extern void treeStatsMerge(void *dst, void *src);
+extern int64_t searchKeyMT(Tree *root, ThreadPool *threadPool, StartThreadArgs *startArgs);
+extern TreeStats treeStatsMT(Tree *root, ThreadPool *threadPool, StartThreadArgs *startArgs);
+
+/* index-based traversals over compact trees */
+extern void preOrderCompactCB(CompactTree *nodes, uint32_t root, CompactCallback callback);
+extern void postOrderCompactCB(CompactTree *nodes, uint32_t root, CompactCallback callback);
+extern void levelOrderCompactCB(CompactTree *nodes, uint32_t root, uint32_t *queue, CompactCallback callback);
+
 
 
 #endif
@@ -29,6 +29,11 @@
 /******************************************************************************* 
 --------------------------------- DECLARATIONS ---------------------------------
 *******************************************************************************/
+/* random generator used by all random entry points (default invtable) */ 
+extern void setRandomTreeGen(RandomTreeGen gen);
+extern RandomTreeGen getRandomTreeGen();
+extern const char * randomTreeGenName(RandomTreeGen gen);
+
 /* basic tree generators */ 
 extern Tree * genRandomTree(int N, bool isBST);
 extern Tree * genContRandomTree(Tree *btNodeArray, int N, bool isBST);
@@ -41,14 +46,33 @@ extern TreeInfo genContRandomTreeOptimized(int *invTable, Tree *btNodeArray, ITN
 extern TreeInfo genBalancedTreeOptimized(int *invTable, ITNode *itNodeArray, int depth, bool isBST);
 extern TreeInfo genContBalancedTreeOptimized(int *invTable, Tree *btNodeArray, ITNode *itNodeArray, int depth, bool isBST);
 
+/* compact (index-based) tree generators, root is index 0 */ 
+extern TreeInfo genCompactRandomTree(int *invTable, CompactTree *ctNodeArray, ITNode *itNodeArray, int N, bool isBST);
+extern TreeInfo genCompactBalancedTree(int *invTable, CompactTree *ctNodeArray, ITNode *itNodeArray, int depth, bool isBST);
+
+/* structure-of-arrays tree generators, root is index 0 */ 
+extern TreeInfo genSoARandomTree(int *invTable, SoATree *soaTree, ITNode *itNodeArray, int N, bool isBST);
+extern TreeInfo genSoABalancedTree(int *invTable, SoATree *soaTree, ITNode *itNodeArray, int depth, bool isBST);
+
 /* other useful functions */ 
 extern Tree * invTab2BT(int *invTable, int N);
 extern Tree * invTab2ContBT(int *invTable, Tree *btNodeArray, int N);
 extern Tree * invTab2BTOptimized(int *invTable, ITNode *itNodeArray, int N);
 extern Tree * invTab2ContBTOptimized(int *invTable, Tree *btNodeArray, ITNode *itNodeArray, int N);
 extern void convert2BST(Tree *root);
+extern int computeSubtreeSizes(Tree *root);
+extern void invTab2Indices(
+	int *invTable, ITNode *itNodeArray, uint32_t *left, uint32_t *right, int stride, int N
+);
+extern void invTab2CompactBT(int *invTable, CompactTree *ctNodeArray, ITNode *itNodeArray, int N);
+extern uint32_t contTree2Compact(Tree *root, Tree *btNodeArray, CompactTree *ctNodeArray, int N);
+extern void invTab2SoABT(int *invTable, SoATree *soaTree, ITNode *itNodeArray, int N);
 extern void genTree2StdOut(int N);
 extern void genInversionTable(int *invTable, int N);
+extern void genInversionTableDyck(int *invTable, int N, TreeInfo *treeInfo);
+extern void genRandomInvTable(int *invTable, int N, TreeInfo *treeInfo);
+extern int assignUniform(int N, int i, int j, double x);
+extern void genBalancedIT(int *invTable, int depth);
 extern void printInvTab(int *invTable, int N, bool vert);
 extern void initITNode(ITNode *node);
 
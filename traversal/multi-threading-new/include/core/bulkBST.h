@@ -0,0 +1,60 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file bulkBST.h
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Bulk BST construction and insertion from sorted keys.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef	__BINARYTREE_BULKBST_H
+#define	__BINARYTREE_BULKBST_H
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include "types.h"
+
+/* the skeleton splits until no piece has over n/BULK_SKELETON_SPLIT keys, 
+	pieces are then grouped into BULK_CHUNKS_PER_THREAD runs per thread */
+#define BULK_SKELETON_SPLIT		256
+#define BULK_CHUNKS_PER_THREAD	4
+
+/* below this many keys the serial versions are used */
+#define BULK_MIN_PARALLEL		(1<<16)
+
+
+
+/******************************************************************************* 
+--------------------------------- DECLARATIONS ---------------------------------
+*******************************************************************************/
+/* perfectly balanced BST over keys[0, N) (strictly increasing), laid out in 
+	pre-order in btNodeArray if given, else from allocNode. subtreeSize is set */
+extern TreeInfo buildBSTSorted(int *keys, int N, Tree *btNodeArray);
+extern TreeInfo buildBSTSortedMT(
+	int *keys, int N, Tree *btNodeArray,
+	ThreadPool *threadPool, StartThreadArgs *startArgs
+);
+
+/* merges keys[0, n) (strictly increasing) into root: the batch is split on 
+	each node's id, keys already present are skipped and every empty subtree 
+	a run of keys lands in gets a balanced subtree. returns the new root, 
+	subtreeSize stays exact if it was */
+extern Tree * insertSorted(Tree *root, int *keys, int n);
+extern Tree * insertSortedMT(
+	Tree *root, int *keys, int n,
+	ThreadPool *threadPool, StartThreadArgs *startArgs
+);
+
+
+
+#endif
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
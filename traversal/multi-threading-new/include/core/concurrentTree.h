@@ -0,0 +1,59 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file concurrentTree.h
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief BST that can be searched and modified by many threads at once.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef	__BINARYTREE_CONCURRENT_H
+#define	__BINARYTREE_CONCURRENT_H
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include "types.h"
+
+/* most threads using concurrent trees at once (a slot is freed on thread exit) */
+#define EBR_MAX_THREADS		256
+
+/* retires between attempts to advance the global epoch */
+#define EBR_RETIRE_BATCH	64
+
+
+
+/******************************************************************************* 
+--------------------------------- DECLARATIONS ---------------------------------
+*******************************************************************************/
+/* keys must be below INT_MAX (the sentinel's), destroy and count need every 
+	other thread to be out of all concurrent tree operations */
+extern void initConcurrentTree(ConcurrentTree *tree);
+extern void destroyConcurrentTree(ConcurrentTree *tree);
+extern int concurrentTreeCount(ConcurrentTree *tree);
+
+/* safe from any number of threads at once, find never blocks. insert/delete 
+	return false if the key was already in/not in the tree */
+extern bool concurrentFind(ConcurrentTree *tree, int id);
+extern bool concurrentInsert(ConcurrentTree *tree, int id, void *data);
+extern bool concurrentDelete(ConcurrentTree *tree, int id);
+
+/* epoch-based reclamation, nodes retired inside an operation are freed once 
+	every thread has left the epochs that could still see them */
+extern void epochEnter();
+extern void epochExit();
+extern void epochRetire(ConcurrentNode *node);
+extern long epochPendingNodes();
+
+
+
+#endif
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
@@ -0,0 +1,56 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file nodeAlloc.h
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Pluggable node allocators used by the pointer-based tree generators.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef	__BINARYTREE_NODEALLOC_H
+#define	__BINARYTREE_NODEALLOC_H
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include "types.h"
+
+/* default nodes per slab (2 MB of 32 byte nodes) */
+#define NODE_SLAB_SIZE		(1<<16)
+
+
+
+/******************************************************************************* 
+--------------------------------- DECLARATIONS ---------------------------------
+*******************************************************************************/
+/* slabNodes <= 0 picks NODE_SLAB_SIZE, shuffleDegree (0..1) is the chance 
+	each slot of a shuffled slab is swapped with a random later one */
+extern void initNodeAllocator(NodeAllocator *allocator, NodeAllocMode mode, int slabNodes, double shuffleDegree);
+extern void destroyNodeAllocator(NodeAllocator *allocator);
+extern void resetNodeAllocator(NodeAllocator *allocator);
+
+/* a NULL allocator means plain malloc/free, none of them are thread-safe */
+extern Tree * allocTreeNode(NodeAllocator *allocator);
+extern void freeTreeNode(NodeAllocator *allocator, Tree *node);
+extern bool nodeAllocatorFrees(NodeAllocator *allocator);
+extern long nodeAllocatorBytes(NodeAllocator *allocator);
+extern const char * nodeAllocModeName(NodeAllocMode mode);
+
+/* allocator used by the generators, insert and make_empty (NULL = malloc) */
+extern void setNodeAllocator(NodeAllocator *allocator);
+extern NodeAllocator * getNodeAllocator();
+extern Tree * allocNode();
+extern void freeNode(Tree *node);
+
+
+
+#endif
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
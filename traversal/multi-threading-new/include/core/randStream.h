@@ -0,0 +1,55 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file randStream.h
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Independent random number streams, one per traversal thread, so
+ * 	callbacks and parallel generators don't share the global generator.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef	__BINARYTREE_RANDSTREAM_H
+#define	__BINARYTREE_RANDSTREAM_H
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include "types.h"
+
+/* seed thread pools start with (see seedThreadPool) */
+#define RAND_STREAM_SEED		0x2545F4914F6CDD1DULL
+
+/* threads outside any pool get stream ids from here on */
+#define RAND_FALLBACK_STREAM	(1ULL<<32)
+
+/* step of the SplitMix64 state, draw k from a state is mix64(state + k*gamma) */
+#define SPLITMIX_GAMMA			0x9E3779B97F4A7C15ULL
+
+
+
+/******************************************************************************* 
+--------------------------------- DECLARATIONS ---------------------------------
+*******************************************************************************/
+/* streams with the same seed and different ids are independent */
+extern void initRandStream(RandStream *stream, uint64_t seed, uint64_t streamID);
+extern uint64_t randStreamNext(RandStream *stream);
+extern double randStreamReal(RandStream *stream);
+extern uint64_t randStreamBelow(RandStream *stream, uint64_t m);
+
+/* stream of the calling thread: the TraversalThread's while it works for a 
+	pool, otherwise a private fallback stream */
+extern RandStream * threadRandStream();
+extern RandStream * swapThreadRandStream(RandStream *stream);
+
+
+
+#endif
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
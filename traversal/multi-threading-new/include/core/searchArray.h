@@ -0,0 +1,57 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file searchArray.h
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Implicit (pointer-free) search arrays built from a BST's keys.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef	__BINARYTREE_SEARCHARRAY_H
+#define	__BINARYTREE_SEARCHARRAY_H
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include "types.h"
+
+/* keys are aligned so an Eytzinger block of 16 descendants or a B-tree node
+	is one cache line */
+#define SEARCH_ALIGN				64
+
+/* keys per B-tree node, one cache line of ints */
+#define SEARCH_BTREE_B				16
+
+/* an Eytzinger descent prefetches the 16 descendants 4 levels down */
+#define SEARCH_EYTZINGER_PREFETCH	16
+
+
+
+/******************************************************************************* 
+--------------------------------- DECLARATIONS ---------------------------------
+*******************************************************************************/
+/* build from the keys of a BST (in-order), the BST must outlive the array */
+extern void initEytzinger(SearchArray *searchArray, Tree *bst);
+extern void initSearchBTree(SearchArray *searchArray, Tree *bst);
+extern void freeSearchArray(SearchArray *searchArray);
+extern const char * searchStructureName(SearchStructure structure);
+
+/* same result as find() on the BST the array was built from */
+extern Tree * findEytzinger(int id, SearchArray *searchArray);
+extern Tree * findSearchBTree(int id, SearchArray *searchArray);
+
+/* scalar reference for findSearchBTree's node search */
+extern Tree * findSearchBTreeScalar(int id, SearchArray *searchArray);
+
+
+
+#endif
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
@@ -0,0 +1,58 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file soaTree.h
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Structure-of-arrays trees and vectorized bulk kernels over them.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef	__BINARYTREE_SOA_H
+#define	__BINARYTREE_SOA_H
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include "types.h"
+
+/* columns are aligned for full-width vector loads */
+#define SOA_ALIGN			32
+
+/* rounds of the random generator per node, matches the loop in randArray */
+#define SOA_RAND_ROUNDS		100
+
+
+
+/******************************************************************************* 
+--------------------------------- DECLARATIONS ---------------------------------
+*******************************************************************************/
+/* allocate/free the columns of an N node tree */
+extern void initSoATree(SoATree *soaTree, int N);
+extern void freeSoATree(SoATree *soaTree);
+
+/* bulk versions of incrementID, searchKey and randArray, each picks the widest
+	instruction set the cpu supports (see soaSimdName) */
+extern void soaIncrementID(SoATree *soaTree);
+extern void soaSearchKey(SoATree *soaTree);
+extern void soaRandArray(SoATree *soaTree);
+extern int soaCountKey(SoATree *soaTree, int key);
+
+/* scalar references for the kernels above */
+extern void soaIncrementIDScalar(SoATree *soaTree);
+extern int soaCountKeyScalar(SoATree *soaTree, int key);
+extern void soaRandArrayScalar(SoATree *soaTree);
+
+extern const char * soaSimdName();
+
+
+
+#endif
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
@@ -22,7 +22,19 @@
 *******************************************************************************/
 #include "types.h"
 
-#define NUM_THREADS 2
+/* env var read by getNumThreads when no -t/--threads flag is passed */
+#define NUM_THREADS_ENV "TREE_NUM_THREADS"
+
+/* max pending subtrees per thread (power of 2), deeper spawns run inline */
+#define DEQUE_CAPACITY (1<<12)
+
+/* level-order splits a level into this many chunks per thread, but never into 
+    chunks smaller than LEVEL_MIN_CHUNK nodes (smaller levels run serially) */
+#define LEVEL_CHUNKS_PER_THREAD 4
+#define LEVEL_MIN_CHUNK 1024
+
+/* upper bound for setBlockingLimit, spare slots are reserved at init */
+#define POOL_MAX_SPARE_THREADS 16
 
 
 
@@ -31,12 +43,69 @@
 *******************************************************************************/
 
 /* functions for thread pool and task queue */
+extern int getNumThreads(int argc, char *argv[]);
 extern void initThreadPool(ThreadPool *threadPool, StartThreadArgs *startArgs, int size);
 extern void destroyThreadPool(ThreadPool *threadPool, StartThreadArgs *startArgs);
+extern void launchPersistentThreadPool(ThreadPool *threadPool, StartThreadArgs *startArgs);
+extern void shutdownPersistentThreadPool(ThreadPool *threadPool);
+extern void setGrainPolicy(ThreadPool *threadPool, GrainPolicy grainPolicy, int grainCutoff);
+extern const char * grainPolicyName(GrainPolicy grainPolicy);
+extern void seedThreadPool(ThreadPool *threadPool, uint64_t seed);
+extern int poolThreadCount(ThreadPool *threadPool);
+
+/* callbacks wrap sleeps/io in poolBeginBlocking/poolEndBlocking, while a 
+    thread is blocked a parked spare worker steals in its place (at most 
+    maxSpares at once, 0 disables, only change it between traversals) */
+extern void setBlockingLimit(ThreadPool *threadPool, int maxSpares);
+extern void shutdownSpareThreads(ThreadPool *threadPool);
+extern void poolBeginBlocking();
+extern void poolEndBlocking();
+
+/* building blocks for jobs run on the pool that are not traversals */
+extern bool pushDeque(WorkDeque *deque, void *work);
+extern void * popDeque(WorkDeque *deque);
+extern long sizeDeque(WorkDeque *deque);
+extern void runJobMT(ThreadPool *threadPool, StartThreadArgs *startArgs,
+    TraversalFuncMT jobFunc, StolenFuncMT stolenFunc, void *ctx);
+
+/* pre-order reduce over all nodes, each thread folds into its own padded 
+    accumulator and they are combined at join (see ReduceOp) */
+extern int64_t traverseReduce(
+    Tree *root, ReduceMap map, ReduceCombine combine, int64_t identity, void *ctx,
+    ThreadPool *threadPool, StartThreadArgs *startArgs
+);
+
+/* same with an accumulator of op->accSize bytes (one per thread, each on its 
+    own cache lines), merged into *result at join */
+extern void traverseReduceAcc(
+    Tree *root, ReduceAccOp *op, void *result,
+    ThreadPool *threadPool, StartThreadArgs *startArgs
+);
+
+/* parallel search that cancels the other threads once any of them finds a 
+    node satisfying predicate, returns that node or NULL */
+extern Tree * findFirstMT(
+    Tree *root, TreePredicate predicate, void *ctx,
+    ThreadPool *threadPool, StartThreadArgs *startArgs
+);
 
 /* new multi-threaded traversal functions */
 extern void preOrderMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs);
 extern void postOrderMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs);
+extern void levelOrderMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs);
+
+/* software-prefetching traversals, see setPrefetchDistance */
+extern void preOrderPrefetchMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs);
+extern void postOrderPrefetchMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs);
+
+/* batched-callback multi-threaded traversals (no post-order: a buffered child 
+    could reach the callback after its parent) */
+extern void preOrderBatchMTWrapper(Tree *root, TreeBatchCallback callback, void *ctx, ThreadPool *threadPool, StartThreadArgs *startArgs);
+extern void levelOrderBatchMTWrapper(Tree *root, TreeBatchCallback callback, void *ctx, ThreadPool *threadPool, StartThreadArgs *startArgs);
+
+/* index-based multi-threaded traversals over compact trees */
+extern void preOrderCompactMTWrapper(CompactTree *nodes, uint32_t root, CompactCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs);
+extern void postOrderCompactMTWrapper(CompactTree *nodes, uint32_t root, CompactCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs);
 
 
 
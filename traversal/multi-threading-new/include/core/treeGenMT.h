@@ -0,0 +1,58 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file treeGenMT.h
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Multi-threaded generators for contiguous random and balanced trees.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef	__BINARYTREE_GENMT_H
+#define	__BINARYTREE_GENMT_H
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include "types.h"
+
+/* the skeleton splits until no piece is over N/GEN_SKELETON_SPLIT nodes (not 
+	tied to the thread count so neither is the tree), pieces are then grouped 
+	into GEN_CHUNKS_PER_THREAD runs of similar size per thread */
+#define GEN_SKELETON_SPLIT		256
+#define GEN_CHUNKS_PER_THREAD	4
+
+/* below this many nodes the serial generators are used */
+#define GEN_MIN_PARALLEL		(1<<16)
+
+
+
+/******************************************************************************* 
+--------------------------------- DECLARATIONS ---------------------------------
+*******************************************************************************/
+/* same output as genContRandomTreeOptimized/genContBalancedTreeOptimized 
+	(pre-order node array, inversion table, TreeInfo), the tree depends only 
+	on the pool's seed (see seedThreadPool) and not on the thread count */
+extern TreeInfo genContRandomTreeMT(
+	int *invTable, Tree *btNodeArray, ITNode *itNodeArray, int N, bool isBST,
+	ThreadPool *threadPool, StartThreadArgs *startArgs
+);
+extern TreeInfo genContBalancedTreeMT(
+	int *invTable, Tree *btNodeArray, ITNode *itNodeArray, int depth, bool isBST,
+	ThreadPool *threadPool, StartThreadArgs *startArgs
+);
+
+/* left subtree size of a uniform random n node tree given a uniform x */
+extern int sampleCatalanSplit(int n, double x);
+
+
+
+#endif
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
@@ -0,0 +1,42 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file treeLayout.h
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Rewrites contiguous binary trees into cache-friendlier node orders.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef	__BINARYTREE_LAYOUT_H
+#define	__BINARYTREE_LAYOUT_H
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include "types.h"
+
+/* blocked layout packs complete subtrees into LAYOUT_BLOCK_BYTES, a single 
+	64 byte line only holds 2 nodes so blocks span several lines */
+#define LAYOUT_BLOCK_BYTES	(8*CACHE_LINE_SIZE)
+
+
+
+/******************************************************************************* 
+--------------------------------- DECLARATIONS ---------------------------------
+*******************************************************************************/
+extern Tree * relayoutContTree(Tree *root, Tree *btNodeArray, int N, TreeLayout layout);
+extern const char * layoutName(TreeLayout layout);
+extern int treeHeight(Tree *root);
+
+
+
+#endif
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
\ No newline at end of file
@@ -20,23 +20,81 @@
 ------------------------------- IMPORTS & PARAMS -------------------------------
 *******************************************************************************/
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CACHE_LINE_SIZE 64
 
 
 /******************************************************************************* 
 --------------------------------- BINARY TREE ----------------------------------
 *******************************************************************************/
 
-/* basic binary tree (primary type used in module) */
+/* basic binary tree (primary type used in module), subtreeSize sits in the 
+	padding after id so the node stays 32 bytes */
 typedef struct Tree Tree;
 struct Tree
 {
 	int id;
+	int subtreeSize;
 	void *data;
 	Tree *left;
 	Tree *right;
 };
 
+/* what insert/delete do to keep a BST in shape: nothing (the original), or 
+	rebalance it as a weight-balanced tree on subtreeSize, which they keep exact */
+typedef enum BalanceMode
+{
+	BALANCE_NONE,
+	BALANCE_WEIGHT
+} BalanceMode;
+
+/* compact node for contiguous trees: children are indices into the node array 
+	(COMPACT_NULL if missing) and there is no data, 12 bytes instead of 32 */
+typedef struct CompactTree
+{
+	int id;
+	uint32_t left;
+	uint32_t right;
+} CompactTree;
+
+#define COMPACT_NULL UINT32_MAX
+
+/* structure-of-arrays tree, node i is spread over id[i], left[i], right[i] 
+	and data[i] (children are indices, COMPACT_NULL if missing, root is 0) so 
+	bulk kernels can stream a single column */
+typedef struct SoATree
+{
+	int N;
+	int *id;
+	uint32_t *left;
+	uint32_t *right;
+	void **data;
+} SoATree;
+
+/* implicit search array built from a BST's sorted keys, key[i] lives in BST 
+	node node[i] so lookups return the same Tree * as find(). the Eytzinger 
+	layout is 1-indexed (children of i at 2i and 2i+1), the B-tree layout packs 
+	SEARCH_BTREE_B keys per block (blocks > 0, padded with INT_MAX) */
+typedef struct SearchArray
+{
+	int N;
+	int blocks;
+	int *key;
+	Tree **node;
+} SearchArray;
+
+/* what searchTreeBenchmark looks its leaves up in */
+typedef enum SearchStructure
+{
+	SEARCH_BST,
+	SEARCH_EYTZINGER,
+	SEARCH_BTREE
+} SearchStructure;
+
 
 
 /******************************************************************************* 
@@ -52,6 +110,55 @@ struct ITNode
 	ITNode *parent;
 };
 
+/* node orders a contiguous tree can be rewritten into (pre-order is the order 
+	the generators produce) */
+typedef enum TreeLayout
+{
+	LAYOUT_PREORDER,
+	LAYOUT_BFS,
+	LAYOUT_VEB,
+	LAYOUT_BLOCKED
+} TreeLayout;
+
+/* where pointer-based generators get their nodes: plain malloc, a bump arena 
+	(freed all at once on reset), a pool that recycles freed nodes, or slabs 
+	handed out in a shuffled order to model a fragmented heap */
+typedef enum NodeAllocMode
+{
+	ALLOC_MALLOC,
+	ALLOC_ARENA,
+	ALLOC_POOL,
+	ALLOC_SHUFFLED
+} NodeAllocMode;
+
+typedef struct NodeSlab NodeSlab;
+struct NodeSlab
+{
+	int used;
+	int capacity;
+	int *order;
+	Tree *nodes;
+	NodeSlab *next;
+};
+
+/* slabs is newest first, freeList (pool only) is linked through left */
+typedef struct NodeAllocator
+{
+	NodeAllocMode mode;
+	int slabNodes;
+	double shuffleDegree;
+	NodeSlab *slabs;
+	Tree *freeList;
+} NodeAllocator;
+
+/* which inversion table generator the random entry points use: the original 
+	floating-point sampler (assign) or the integer-only bracket word sampler */
+typedef enum RandomTreeGen
+{
+	RANDOM_GEN_INVTABLE,
+	RANDOM_GEN_DYCK
+} RandomTreeGen;
+
 /* type used to get info about generated binary tree */
 typedef struct TreeInfo
 {
@@ -71,6 +178,76 @@ typedef struct TreeInfo
 /* defines callback function type for performing actions during tree traversal */
 typedef void (*TreeCallback)(Tree *);
 
+/* batched callback, gets n visited nodes at once (in visiting order) plus the 
+	ctx pointer handed to the traversal */
+typedef void (*TreeBatchCallback)(Tree **, int, void *);
+
+/* reduce traversals: map turns a node into a value and combine folds two 
+	values, combine must be associative and commutative since per-thread 
+	results are merged in any order */
+typedef int64_t (*ReduceMap)(Tree *, void *);
+typedef int64_t (*ReduceCombine)(int64_t, int64_t);
+
+typedef struct ReduceOp
+{
+	ReduceMap map;
+	ReduceCombine combine;
+	int64_t identity;
+	void *ctx;
+} ReduceOp;
+
+/* reduce traversals with an accumulator of accSize bytes, so several results 
+	come out of one pass: init sets one to the identity, fold adds a node to 
+	it and merge folds src into dst (associative and commutative as combine). 
+	accs/stride are the per-thread accumulators, set up by traverseReduceAcc */
+typedef void (*ReduceInit)(void *);
+typedef void (*ReduceFold)(void *, Tree *, void *);
+typedef void (*ReduceMerge)(void *, void *);
+
+typedef struct ReduceAccOp
+{
+	ReduceInit init;
+	ReduceFold fold;
+	ReduceMerge merge;
+	size_t accSize;
+	void *ctx;
+	char *accs;
+	size_t stride;
+} ReduceAccOp;
+
+/* predicate for find-first traversals, ctx is passed through */
+typedef bool (*TreePredicate)(Tree *, void *);
+
+/* statistics gathered by treeStatsMT */
+typedef struct TreeStats
+{
+	int64_t nodes;
+	int64_t leaves;
+	int64_t sumID;
+	int64_t minID;
+	int64_t maxID;
+} TreeStats;
+
+/* default look-ahead of the prefetching traversals (in pending subtrees) and 
+	initial size of their explicit stack */
+#define PREFETCH_DISTANCE	4
+#define PREFETCH_STACK_SIZE	64
+
+/* nodes buffered by batched traversals before being flushed to the callback */
+#define CALLBACK_BATCH_SIZE	64
+
+/* searches findBatch keeps in flight at once, and the most findBatchGroup takes */
+#define FIND_BATCH_GROUP		32
+#define FIND_BATCH_MAX_GROUP	64
+
+typedef struct TreeBatch
+{
+	int n;
+	TreeBatchCallback callback;
+	void *ctx;
+	Tree *nodes[CALLBACK_BATCH_SIZE];
+} TreeBatch;
+
 /* binary tree queue, used for level-order traversal */
 typedef struct TreeQueue
 {
@@ -88,6 +265,18 @@ typedef void (*TraversalFuncLevel)(Tree *, TreeQueue *);
 typedef void (*TraversalFuncLevelCB)(Tree *, TreeQueue *, TreeCallback);
 typedef void (*TraversalFuncCont)(Tree *, int);
 typedef void (*TraversalFuncContCB)(Tree *, int, TreeCallback);
+typedef void (*TraversalFuncBatchCB)(Tree *, TreeBatchCallback, void *);
+typedef void (*TraversalFuncLevelBatchCB)(Tree *, TreeQueue *, TreeBatchCallback, void *);
+typedef void (*TraversalFuncContBatchCB)(Tree *, int, TreeBatchCallback, void *);
+
+/* same as above for compact trees (node array + root index), level-order 
+	takes a queue of N indices */
+typedef void (*CompactCallback)(CompactTree *);
+typedef void (*TraversalFuncCompactCB)(CompactTree *, uint32_t, CompactCallback);
+typedef void (*TraversalFuncCompactLevelCB)(CompactTree *, uint32_t, uint32_t *, CompactCallback);
+
+/* bulk kernel applied to every node of a SoA tree at once */
+typedef void (*SoAKernel)(SoATree *);
 
 
 
@@ -99,42 +288,229 @@ typedef struct TraversalThread TraversalThread;
 typedef struct ThreadPool ThreadPool;
 typedef struct StartThreadArgs StartThreadArgs;
 
-/* types for passing function pointer to multi-threaded traversal functions */
+/* types for passing function pointer to multi-threaded traversal functions 
+    (StolenFuncMT resumes whatever work item a traversal pushed to its deque) */
 typedef void (*TraversalFuncMT)(Tree *, TreeCallback, TraversalThread *, ThreadPool *);
+typedef void (*StolenFuncMT)(void *, TreeCallback, TraversalThread *, ThreadPool *);
 typedef void (*TraversalFuncMTWrapper)(Tree *, TreeCallback, ThreadPool *, StartThreadArgs *);
+typedef void (*TraversalFuncCompactMTWrapper)(CompactTree *, uint32_t, CompactCallback, ThreadPool *, StartThreadArgs *);
+typedef void (*TraversalFuncBatchMTWrapper)(Tree *, TreeBatchCallback, void *, ThreadPool *, StartThreadArgs *);
+
+/* contiguous generators (size is N or depth), serial and multi-threaded */
+typedef TreeInfo (*ContTreeGenFunc)(int *, Tree *, ITNode *, int, bool);
+typedef TreeInfo (*ContTreeGenFuncMT)(int *, Tree *, ITNode *, int, bool, ThreadPool *, StartThreadArgs *);
+
+/* controls where multi-threaded traversals stop exposing subtrees to thieves: 
+    depth/size cutoffs switch to the serial traversal below the cutoff, lazy 
+    splitting only pushes while the thread's own deque is nearly empty */
+typedef enum GrainPolicy
+{
+    GRAIN_NONE,
+    GRAIN_DEPTH,
+    GRAIN_SIZE,
+    GRAIN_LAZY
+} GrainPolicy;
+
+/* shared state of a find-first traversal: the first thread to match claims 
+	match and raises cancelled, which every thread polls before each node */
+typedef struct FindState
+{
+	TreePredicate predicate;
+	void *ctx;
+	_Alignas(CACHE_LINE_SIZE) atomic_bool cancelled;
+	_Atomic(Tree *) match;
+} FindState;
 
-/* stores task executed by each thread */
+/* stores task executed by each thread (compact traversals set compactNodes 
+	and use compactRoot/compactCallback in place of root/callback, batched 
+	traversals set batchCallback instead of callback, reduce and find-first 
+	traversals set reduce (or reduceAcc)/find, jobs that are not traversals 
+	such as the parallel generators keep their state in jobCtx) */
 typedef struct TraversalTask {
 	TraversalFuncMT traversalFunc;
+	StolenFuncMT stolenFunc;
 	Tree * root;
 	TreeCallback callback;
+	CompactTree *compactNodes;
+	uint32_t compactRoot;
+	CompactCallback compactCallback;
+	TreeBatchCallback batchCallback;
+	void *batchCtx;
+	ReduceOp *reduce;
+	ReduceAccOp *reduceAcc;
+	FindState *find;
+	void *jobCtx;
 } TraversalTask;
 
-/* stores threads and info related to each (such as current task) */
+/* Chase-Lev work-stealing deque of pending work items (owner pushes/pops at 
+    bottom without locks, thieves steal the oldest items from the top) */
+typedef struct WorkDeque
+{
+    _Alignas(CACHE_LINE_SIZE) atomic_long top;
+    _Alignas(CACHE_LINE_SIZE) atomic_long bottom;
+    long capacity;
+    _Atomic(void *) *tasks;
+} WorkDeque;
+
+/* join point for parallel post-order, pending counts children not yet done 
+    and whoever finishes the last one runs node's callback (node is a Tree or 
+    CompactTree, parent doubles as the free list link once released) */
+typedef struct PostOrderFrame PostOrderFrame;
+struct PostOrderFrame
+{
+    atomic_int pending;
+    void *node;
+    PostOrderFrame *parent;
+};
+
+/* slice [begin, end) of the current level given to one thread, its children 
+    are gathered in a private buffer and later copied to offset in next level */
+typedef struct LevelChunk
+{
+    long begin;
+    long end;
+    long count;
+    long offset;
+    long capacity;
+    Tree **children;
+} LevelChunk;
+
+/* frontiers for level-synchronous traversal, kept in the pool so the 
+    buffers are reused between traversals */
+typedef struct LevelOrderState
+{
+    Tree **frontier;
+    Tree **next;
+    long capacity;
+    bool copyPhase;
+    int maxChunks;
+    LevelChunk *chunks;
+    _Alignas(CACHE_LINE_SIZE) atomic_int pendingChunks;
+} LevelOrderState;
+
+/* subtree handed out by the parallel generators: nodes [begin, begin+size) of 
+    the pre-order node array, its inversion table entries are offset by base 
+    (left edges above it) and its root is depth levels down. The generating 
+    thread fills in height and leaves */
+typedef struct GenPiece
+{
+    int begin;
+    int size;
+    int base;
+    int depth;
+    uint64_t seed;
+    int height;
+    int leaves;
+} GenPiece;
+
+/* run of consecutive pieces given to one thread */
+typedef struct GenChunk
+{
+    int first;
+    int last;
+} GenChunk;
+
+typedef struct TreeGenJob
+{
+    bool balanced;
+    int *invTable;
+    Tree *btNodeArray;
+    ITNode *itNodeArray;
+    int numPieces;
+    int pieceCapacity;
+    GenPiece *pieces;
+    int numChunks;
+    GenChunk *chunks;
+} TreeGenJob;
+
+/* item of a bulk BST build/merge, in post-order of the skeleton: a piece 
+    merges keys [lo, lo+n) into the subtree at link (building it in pre-order 
+    at btNodeArray+begin if contiguous), a split is a skeleton node (first is 
+    the first item below it). inserted counts the keys an item added (a split 
+    node created by the skeleton counts itself) and leaves the leaves it built */
+typedef struct BulkItem
+{
+    Tree **link;
+    Tree *split;
+    int lo;
+    int n;
+    int begin;
+    int first;
+    int inserted;
+    int leaves;
+} BulkItem;
+
+/* keys are strictly increasing, btNodeArray is NULL unless the tree is built 
+    contiguously, chunks are runs of items (see GenChunk) */
+typedef struct BulkBSTJob
+{
+    int *keys;
+    Tree *btNodeArray;
+    int grain;
+    int numItems;
+    int itemCapacity;
+    BulkItem *items;
+    int numChunks;
+    GenChunk *chunks;
+} BulkBSTJob;
+
+/* private result of a reduce traversal, alone on its cache line so threads 
+    folding into their own accumulators don't share lines */
+typedef struct ReduceAccumulator
+{
+    _Alignas(CACHE_LINE_SIZE) int64_t value;
+} ReduceAccumulator;
+
+/* SplitMix64 state, see randStream.h */
+typedef struct RandStream
+{
+    uint64_t state;
+} RandStream;
+
+/* stores threads and info related to each (such as its deque of subtrees and 
+    the random stream its callbacks draw from) */
 typedef struct TraversalThread
 {
     int threadID;
     bool started;
-    bool busy;
-    TraversalTask task;
+    unsigned int victimSeed;
+    RandStream rng;
+    ReduceAccumulator acc;
+    WorkDeque deque;
+    PostOrderFrame *freeFrames;
+    TreeBatch batch;
     pthread_t thread;
-    pthread_mutex_t mutex;
-    pthread_cond_t cond;
 
     int totalTasks;
+    int totalSteals;
     int totalCallbacks;
 } TraversalThread;
 
-/* pool that stores all threads and info used during mult-threaded traversal */
+/* pool that stores all threads and info used during mult-threaded traversal 
+    (persistent pools park their workers between traversals until the epoch 
+    is bumped, non-persistent pools spawn/join workers for every traversal) */
 typedef struct ThreadPool
 {
     int size;
-    int taskCount;
-    int availThreads;
-    int nextThread;
-    bool addingTasks;
-	bool finished;
+    bool persistent;
+    bool shutdown;
+    unsigned long epoch;
+    int parkedThreads;
     pthread_mutex_t mutex;
+    pthread_cond_t wakeCond;
+    pthread_cond_t parkedCond;
+    TraversalTask task;
+    GrainPolicy grainPolicy;
+    int grainCutoff;
+    LevelOrderState level;
+    int spareThreads;
+    int spareLimit;
+    bool spareShutdown;
+    pthread_cond_t spareCond;
+    StartThreadArgs *spareArgs;
+    _Alignas(CACHE_LINE_SIZE) atomic_int blockedThreads;
+    atomic_int activeSpares;
+    _Alignas(CACHE_LINE_SIZE) atomic_int pendingTasks;
     TraversalThread *threads;
 } ThreadPool;
 
@@ -145,6 +521,41 @@ typedef struct StartThreadArgs
     TraversalThread * thread;
 } StartThreadArgs;
 
+/* node of the concurrent BST: readers follow left/right without locks, writers 
+    lock the node they change. deleted nodes stay as routing nodes until they 
+    have at most one child and get unlinked (removed), after which they wait on 
+    a limbo list (linked through retired) until no reader can still hold them */
+typedef struct ConcurrentNode ConcurrentNode;
+struct ConcurrentNode
+{
+    int id;
+    atomic_flag lock;
+    atomic_bool deleted;
+    atomic_bool removed;
+    void *data;
+    _Atomic(ConcurrentNode *) left;
+    _Atomic(ConcurrentNode *) right;
+    ConcurrentNode *retired;
+};
+
+/* root is a sentinel keyed INT_MAX, the tree hangs off its left */
+typedef struct ConcurrentTree
+{
+    ConcurrentNode *root;
+} ConcurrentTree;
+
+/* one per live thread taking part in epoch-based reclamation (inUse while 
+    claimed), epoch is 0 outside an operation and (epoch << 1) | 1 inside, 
+    limbo[i] holds the nodes retired during epoch limboEpoch[i] */
+typedef struct EpochSlot
+{
+    _Alignas(CACHE_LINE_SIZE) atomic_ulong epoch;
+    atomic_bool inUse;
+    unsigned long retiredCount;
+    unsigned long limboEpoch[3];
+    ConcurrentNode *limbo[3];
+} EpochSlot;
+
 
 
 
@@ -35,7 +35,9 @@ extern float treeDensity(int N, int l);
 
 /* random number generation */
 extern double genrand64_real2(void);
+extern unsigned long long genrand64_int64(void);
 extern void init_genrand64(unsigned long long seed);
+extern void genZipfKeys(int *keys, int n, int universe, double s);
 
 /* tree printing */
 extern void print_ascii_tree(Tree * t);
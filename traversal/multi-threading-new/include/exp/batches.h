@@ -26,10 +26,117 @@
 ---------------------------------- FUNC DECL -----------------------------------
 *******************************************************************************/
 
-/* functions for timing multi-threaded tree traversal */
+/* functions for timing multi-threaded tree traversal (grainPolicy/grainCutoff 
+	pick where spawning stops, see setGrainPolicy) */
 extern void traversalBatchMT(
 	int depth, int samples, TreeCallback callback, 
 	ThreadPool *threadPool, StartThreadArgs *startArgs,
+	GrainPolicy grainPolicy, int grainCutoff,
+	const char callbackName[], bool printResults, bool verbose
+);
+
+/* sweeps thread counts for every tree type, storage type and traversal */
+extern void scalingBatchMT(
+	int depth, int samples, int maxThreads, TreeCallback callback, 
+	const char callbackName[], bool printResults, bool verbose
+);
+
+/* times find() on contiguous BSTs rewritten into each TreeLayout */
+extern void layoutSearchBatch(
+	int depth, int numKeys, bool printResults, bool verbose
+);
+
+/* lookups/sec of find() vs. findBatchGroup for every group size (powers of 
+	2 up to FIND_BATCH_MAX_GROUP) on balanced BSTs of each depth */
+extern void findBatchSweep(
+	int minDepth, int maxDepth, int numKeys, bool printResults, bool verbose
+);
+
+/* lookups/sec of find() vs. the Eytzinger and B-tree search arrays */
+extern void searchStructureSweep(
+	int minDepth, int maxDepth, int numKeys, bool printResults, bool verbose
+);
+
+/* insert/find/delete throughput of the unbalanced vs. weight-balanced BST 
+	for sorted, uniform and Zipf(0.99) key streams */
+extern void bstOpsBatch(int numKeys, bool printResults, bool verbose);
+
+/* mixed find/insert/delete throughput of the concurrent BST vs. a mutex 
+	around the plain one, 1..maxThreads threads and 0-100% writes */
+extern void concurrentBSTBatch(
+	int maxThreads, int numOps, int keyRange, bool printResults, bool verbose
+);
+
+/* loading numKeys keys by per-key insert vs. the serial/parallel sorted 
+	builds, then merging a sorted batch of batchSize new keys */
+extern void bulkBSTBatch(
+	int numKeys, int batchSize, ThreadPool *threadPool, StartThreadArgs *startArgs, 
+	bool printResults, bool verbose
+);
+
+/* searchTreeBenchmark over each search structure (search tree of searchDepth), 
+	serial and multi-threaded */
+extern void searchStructureMT(
+	int depth, int searchDepth, int samples, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	bool printResults, bool verbose
+);
+
+/* compares serial BFS, parallel pre-order and frontier-parallel BFS on balanced trees */
+extern void levelOrderBatchMT(
+	int depth, int samples, TreeCallback callback, 
+	ThreadPool *threadPool, StartThreadArgs *startArgs,
+	const char callbackName[], bool printResults, bool verbose
+);
+
+/* compares 32-byte pointer nodes against 12-byte index nodes of the same shape */
+extern void compactBatchMT(
+	int depth, int samples, TreeCallback callback, CompactCallback compactCallback,
+	ThreadPool *threadPool, StartThreadArgs *startArgs,
+	const char callbackName[], bool printResults, bool verbose
+);
+
+/* per-node callbacks on contiguous trees vs. vectorized bulk kernels on SoA trees */
+extern void soaBatch(
+	int depth, int samples, bool printResults, bool verbose
+);
+
+/* per-node callbacks vs. their batched versions for every traversal */
+extern void callbackBatchMT(
+	int depth, int samples, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	bool printResults, bool verbose
+);
+
+/* build, teardown and pre-order time of pointer trees for every node allocator */
+extern void allocatorBatch(
+	int depth, int samples, TreeCallback callback, 
+	const char callbackName[], bool printResults, bool verbose
+);
+
+/* id lookups on unordered trees: full reduce traversal vs. serial and 
+	parallel find-first (keys are uniform, so a serial search stops halfway 
+	on average) */
+extern void findFirstBatchMT(
+	int depth, int numKeys, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	bool printResults, bool verbose
+);
+
+/* sleeping callbacks on balanced trees with no spares vs. up to maxSpares 
+	spare workers standing in for blocked threads */
+extern void blockingBatchMT(
+	int depth, int samples, int maxSpares, ThreadPool *threadPool, 
+	StartThreadArgs *startArgs, bool printResults, bool verbose
+);
+
+/* serial vs. multi-threaded generation of contiguous random/balanced trees */
+extern void genBatchMT(
+	int depth, int samples, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	bool printResults, bool verbose
+);
+
+/* compares serial traversal against spawn-per-traversal and persistent pools */
+extern void poolBreakEvenBatch(
+	int minDepth, int maxDepth, int samples, TreeCallback callback, 
+	ThreadPool *threadPool, StartThreadArgs *startArgs,
 	const char callbackName[], bool printResults, bool verbose
 );
 
@@ -40,6 +40,21 @@ typedef struct TimeInfo
   double avgWallTime;
 } TimeInfo;
 
+/* one thread of the mixed read/write BST benchmark, tree NULL runs the plain 
+  BST (root) under coarseLock instead of the concurrent one */
+typedef struct MixedOpsArgs
+{
+  ConcurrentTree *tree;
+  Tree **root;
+  pthread_mutex_t *coarseLock;
+  pthread_barrier_t *barrier;
+  int threadID;
+  int numOps;
+  int writePercent;
+  int keyRange;
+  long hits;
+} MixedOpsArgs;
+
 #endif
 /******************************************************************************* 
 --------------------------------- END OF FILE ----------------------------------
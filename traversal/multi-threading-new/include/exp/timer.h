@@ -34,6 +34,13 @@ extern TimeInfo timeTraversalMT(
 	const char storageType[], const char traversalName[], const char callbackName[]
 );
 
+/* sweeps 1..maxThreads threads and reports speedup/efficiency vs. 1 thread */
+extern TimeInfo timeTraversalScaling(
+	TreeInfo treeInfo, TraversalFuncMTWrapper traversalFunc, TreeCallback callback,
+	int maxThreads, int samples, bool printResults, bool verbose, const char treeType[], 
+	const char storageType[], const char traversalName[], const char callbackName[]
+);
+
 
 /* functions for timing each tree traversal */
 extern TimeInfo timeTraversal(
@@ -72,6 +79,133 @@ extern TimeInfo timeTraversalContCB(
 	const char traversalName[], const char callbackName[]
 );
 
+/* same as above for batched callbacks (ctx is passed through) */
+extern TimeInfo timeTraversalBatchCB(
+	TreeInfo treeInfo, TraversalFuncBatchCB traversalFunc, TreeBatchCallback callback, void *ctx, 
+	int samples, bool printResults, bool verbose, const char treeType[], const char storageType[],
+	const char traversalName[], const char callbackName[]
+);
+
+extern TimeInfo timeTraversalLevelBatchCB(
+	TreeInfo treeInfo, TreeQueue *treeQueue, TraversalFuncLevelBatchCB traversalFunc, 
+	TreeBatchCallback callback, void *ctx, int samples, bool printResults, bool verbose, 
+	const char treeType[], const char storageType[], const char traversalName[], const char callbackName[]
+);
+
+extern TimeInfo timeTraversalContBatchCB(
+	TreeInfo treeInfo, Tree *btNodeArray, TraversalFuncContBatchCB traversalFunc, 
+	TreeBatchCallback callback, void *ctx, int samples, bool printResults, bool verbose, 
+	const char treeType[], const char storageType[], const char traversalName[], const char callbackName[]
+);
+
+extern TimeInfo timeTraversalBatchMT(
+	TreeInfo treeInfo, TraversalFuncBatchMTWrapper traversalFunc, TreeBatchCallback callback, 
+	void *ctx, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	int samples, bool printResults, bool verbose, const char treeType[], 
+	const char storageType[], const char traversalName[], const char callbackName[]
+);
+
+/* times traverseReduce, the reduced value goes to *result */
+extern TimeInfo timeReduceMT(
+	TreeInfo treeInfo, ReduceMap map, ReduceCombine combine, int64_t identity, void *ctx, 
+	int64_t *result, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	int samples, bool printResults, bool verbose, const char treeType[], 
+	const char storageType[], const char traversalName[], const char callbackName[]
+);
+
+/* same as above for compact trees (node array + root index) */
+extern TimeInfo timeTraversalCompactCB(
+	TreeInfo treeInfo, CompactTree *ctNodeArray, uint32_t root, TraversalFuncCompactCB traversalFunc, 
+	CompactCallback callback, int samples, bool printResults, bool verbose, const char treeType[], 
+	const char storageType[], const char traversalName[], const char callbackName[]
+);
+
+extern TimeInfo timeTraversalCompactLevelCB(
+	TreeInfo treeInfo, CompactTree *ctNodeArray, uint32_t root, uint32_t *queue, 
+	TraversalFuncCompactLevelCB traversalFunc, CompactCallback callback, int samples, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[], 
+	const char traversalName[], const char callbackName[]
+);
+
+extern TimeInfo timeTraversalCompactMT(
+	TreeInfo treeInfo, CompactTree *ctNodeArray, uint32_t root, 
+	TraversalFuncCompactMTWrapper traversalFunc, CompactCallback callback,
+	ThreadPool *threadPool, StartThreadArgs *startArgs,
+	int samples, bool printResults, bool verbose, const char treeType[], 
+	const char storageType[], const char traversalName[], const char callbackName[]
+);
+
+/* times a bulk kernel over every node of a SoA tree */
+extern TimeInfo timeSoAKernel(
+	TreeInfo treeInfo, SoATree *soaTree, SoAKernel kernel, int samples, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[],
+	const char traversalName[], const char callbackName[]
+);
+
+/* times numKeys lookups with find() on a BST */
+extern TimeInfo timeFind(
+	TreeInfo treeInfo, int *keys, int numKeys, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[]
+);
+
+/* times numKeys interleaved lookups with findBatchGroup and reports 
+	lookups/sec (group 0 times a plain find() loop) */
+extern TimeInfo timeFindBatch(
+	TreeInfo treeInfo, int *keys, int numKeys, int group, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[]
+);
+
+/* insert/find/delete throughput of one key stream (printed per phase, the 
+	tree's depth is taken after the inserts) */
+extern TimeInfo timeBSTOps(
+	int *keys, int numKeys, BalanceMode mode, bool printResults, bool verbose, 
+	const char keyStream[]
+);
+
+/* ops/sec of numThreads threads mixing finds with writePercent% inserts and 
+	deletes, on the concurrent BST or the plain one behind a single mutex (the 
+	thread count is reported in the group column) */
+extern TimeInfo timeMixedBST(
+	int numThreads, int numOps, int writePercent, int keyRange, bool concurrent, 
+	bool printResults, bool verbose
+);
+
+/* loading numKeys sorted keys by per-key insert (of shuffled, the same keys 
+	shuffled), by buildBSTSorted and by buildBSTSortedMT, then merging a sorted 
+	batch with insertSorted vs. insertSortedMT (thread count in the group column) */
+extern TimeInfo timeBulkBST(
+	int *keys, int *shuffled, int numKeys, int *batch, int batchSize, 
+	ThreadPool *threadPool, StartThreadArgs *startArgs, bool printResults, bool verbose
+);
+
+/* same for find() on the BST vs. its Eytzinger / B-tree search arrays */
+extern TimeInfo timeSearchStructure(
+	TreeInfo treeInfo, SearchStructure structure, int *keys, int numKeys, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[]
+);
+
+/* times numKeys find-first searches by id, serial preOrderFind when 
+	threadPool is NULL and findFirstMT otherwise */
+extern TimeInfo timeFindFirst(
+	TreeInfo treeInfo, int *keys, int numKeys, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	bool printResults, bool verbose, const char treeType[], const char storageType[], 
+	const char traversalName[]
+);
+
+/* serial vs. multi-threaded contiguous tree generation */
+extern TimeInfo timeContTreeGen(
+	ContTreeGenFunc genFunc, ContTreeGenFuncMT genFuncMT, int size,
+	int *invTable, Tree *btNodeArray, ITNode *itNodeArray,
+	ThreadPool *threadPool, StartThreadArgs *startArgs, int samples, 
+	bool printResults, bool verbose, const char treeType[], const char genName[]
+);
+
+/* build/teardown of a pointer tree through the current node allocator */
+extern TimeInfo timeTreeBuild(
+	TreeInfo treeInfo, int *invTable, ITNode *itNodeArray, int samples, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[]
+);
+
 
 #endif
 /******************************************************************************* 
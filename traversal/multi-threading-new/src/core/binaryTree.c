@@ -23,32 +23,47 @@
 
 #include "types.h"
 #include "binaryTreeGen.h"
+#include "nodeAlloc.h"
+#include "randStream.h"
+#include "searchArray.h"
+#include "threadpool.h"
 #include "util.h"
 
-static int sampleKey = 849037849;
+static atomic_int sampleKey = 849037849;
 static double testArray[100];
 
-#define searchTreeDepth	10
+/* weight-balanced tree parameters <3,2>: a subtree may weigh (size + 1) at 
+	most WB_DELTA times its sibling, WB_GAMMA picks single vs. double rotation */
+#define WB_DELTA	3
+#define WB_GAMMA	2
+
+static BalanceMode balanceMode = BALANCE_NONE;
+
+static int searchTreeDepth = 10;
 static Tree *searchTree;
+static SearchStructure searchStructure = SEARCH_BST;
+static SearchArray searchArray;
 
 /******************************************************************************* 
 -------------------------------- FUNCTION DEFS ---------------------------------
 *******************************************************************************/
 void initTree(Tree *tree)
 {
-	tree->id	= 0;
-	tree->data	= NULL;
-	tree->left	= NULL;
-	tree->right	= NULL;
+	tree->id			= 0;
+	tree->subtreeSize	= 0;
+	tree->data			= NULL;
+	tree->left			= NULL;
+	tree->right			= NULL;
 }
 
 Tree * make_empty(Tree *t)
 {
-	if (t != NULL)
+	/* arena/shuffled nodes go all at once with resetNodeAllocator */
+	if (t != NULL && nodeAllocatorFrees(getNodeAllocator()))
 	{
 	make_empty(t->left);
 	make_empty(t->right);
-	free(t);
+	freeNode(t);
 	}
 
 	return NULL;
@@ -107,15 +122,215 @@ Tree * find(int id, Tree *t)
 	}
 }
 
+/* up to group searches advance one level per round and prefetch their next 
+	node, so their misses overlap instead of forming one dependent chain, a 
+	search that ends hands its lane to the next key */
+void findBatchGroup(int *keys, int n, Tree **results, Tree *t, int group)
+{
+	Tree *node[FIND_BATCH_MAX_GROUP];
+	int slot[FIND_BATCH_MAX_GROUP];
+	int g, key, next, active;
+	Tree *cur;
+
+	if (group > FIND_BATCH_MAX_GROUP) group = FIND_BATCH_MAX_GROUP;
+	if (group > n) group = n;
+	if (group < 1) return;
+
+	for (g=0; g<group; g++)
+	{
+		node[g] = t;
+		slot[g] = g;
+	}
+	next = group;
+	active = group;
+
+	while (active > 0)
+	{
+		for (g=0; g<group; g++)
+		{
+			if (slot[g] < 0) continue;
+
+			cur = node[g];
+			key = keys[slot[g]];
+			if (cur == NULL || cur->id == key)
+			{
+				results[slot[g]] = cur;
+				if (next < n)
+				{
+					node[g] = t;
+					slot[g] = next++;
+				}
+				else
+				{
+					slot[g] = -1;
+					active--;
+				}
+				continue;
+			}
+
+			cur = (key < cur->id) ? cur->left : cur->right;
+			__builtin_prefetch(cur);
+			node[g] = cur;
+		}
+	}
+}
+
+/* find() for n keys, results[i] is the node for keys[i] (NULL if missing) */
+void findBatch(int *keys, int n, Tree **results, Tree *t)
+{
+	findBatchGroup(keys, n, results, t, FIND_BATCH_GROUP);
+}
+
+int wbWeight(Tree *t)
+{
+	return (t == NULL) ? 1 : t->subtreeSize + 1;
+}
+
+void wbUpdate(Tree *t)
+{
+	t->subtreeSize = wbWeight(t->left) + wbWeight(t->right) - 1;
+}
+
+Tree * rotateLeft(Tree *t)
+{
+	Tree *r = t->right;
+	t->right = r->left;
+	r->left = t;
+	wbUpdate(t);
+	wbUpdate(r);
+	return r;
+}
+
+Tree * rotateRight(Tree *t)
+{
+	Tree *l = t->left;
+	t->left = l->right;
+	l->right = t;
+	wbUpdate(t);
+	wbUpdate(l);
+	return l;
+}
+
+/* one insert/delete below t can only tip it by one rotation (single or double) */
+Tree * wbBalance(Tree *t)
+{
+	wbUpdate(t);
+	if (wbWeight(t->right) > WB_DELTA * wbWeight(t->left))
+	{
+		if (wbWeight(t->right->left) >= WB_GAMMA * wbWeight(t->right->right))
+		{
+			t->right = rotateRight(t->right);
+		}
+		t = rotateLeft(t);
+	}
+	else if (wbWeight(t->left) > WB_DELTA * wbWeight(t->right))
+	{
+		if (wbWeight(t->left->right) >= WB_GAMMA * wbWeight(t->left->left))
+		{
+			t->left = rotateLeft(t->left);
+		}
+		t = rotateRight(t);
+	}
+	return t;
+}
+
+Tree * insertWeightBalanced(int id, void *data, Tree *t)
+{
+	Tree *new_node;
+
+	if (t == NULL)
+	{
+		new_node = allocNode();
+		if (new_node == NULL)
+		{
+			return t;
+		}
+
+		new_node->id = id;
+		new_node->data = data;
+		new_node->subtreeSize = 1;
+		new_node->left = new_node->right = NULL;
+		return new_node;
+	}
+
+	if (id < t->id)
+	{
+		t->left = insertWeightBalanced(id, data, t->left);
+	}
+	else if (id > t->id)
+	{
+		t->right = insertWeightBalanced(id, data, t->right);
+	}
+	else
+	{
+		return t;
+	}
+	return wbBalance(t);
+}
+
+Tree * deleteWeightBalanced(int id, Tree *t)
+{
+	Tree *tmp_cell;
+
+	if (t == NULL) return NULL;
+
+	if (id < t->id)
+	{
+		t->left = deleteWeightBalanced(id, t->left);
+	}
+	else if (id > t->id)
+	{
+		t->right = deleteWeightBalanced(id, t->right);
+	}
+	else if (t->left && t->right)
+	{
+		tmp_cell = find_min(t->right);
+		t->id = tmp_cell->id;
+		t->data = tmp_cell->data;
+		t->right = deleteWeightBalanced(t->id, t->right);
+	}
+	else
+	{
+		tmp_cell = t;
+		t = (t->left == NULL) ? t->right : t->left;
+		freeNode(tmp_cell);
+		return t;
+	}
+	return wbBalance(t);
+}
+
+/* applies to every later insert/delete, a tree built in one mode needs 
+	computeSubtreeSizes before the weight-balanced mode can take it over */
+void setBalanceMode(BalanceMode mode)
+{
+	balanceMode = mode;
+}
+
+BalanceMode getBalanceMode()
+{
+	return balanceMode;
+}
+
+const char * balanceModeName(BalanceMode mode)
+{
+	switch (mode)
+	{
+		case BALANCE_WEIGHT:	return "weight-balanced";
+		default:				return "unbalanced";
+	}
+}
+
 //Insert i into the tree t, duplicate will be discarded
 //Return a pointer to the resulting tree.                 
 Tree * insert(int id, void *data, Tree *t) 
 {
 	Tree * new_node;
 	
+	if (balanceMode == BALANCE_WEIGHT) return insertWeightBalanced(id, data, t);
+
 	if (t == NULL) 
 	{
-		new_node = (Tree *) malloc (sizeof (Tree));
+		new_node = allocNode();
 		if (new_node == NULL) 
 		{
 			return t;
@@ -149,6 +364,8 @@ Tree * delete(int id, Tree * t, void *data)
 	// Return a pointer to the resulting tree
 	Tree *tmp_cell;
 	
+	if (balanceMode == BALANCE_WEIGHT) return deleteWeightBalanced(id, t);
+
 	if (t==NULL) return NULL;
 	
 	if (id < t->id) 
@@ -178,7 +395,7 @@ Tree * delete(int id, Tree * t, void *data)
 			t = t->left;
 		}
 		data = tmp_cell->data;
-		free(tmp_cell);
+		freeNode(tmp_cell);
 	}
 
 	return t;
@@ -199,49 +416,285 @@ void incrementID(Tree *t)
 	(t->id)++;
 }
 
+/* the key is shared by every thread of a multi-threaded traversal, a match 
+	moves it on only if nobody else has yet */
 void searchKey(Tree *t)
 {
-	bool isMatch = (t->id) == sampleKey;
-	if (isMatch) sampleKey++;
+	int key = atomic_load_explicit(&sampleKey, memory_order_relaxed);
+	if (t->id == key) atomic_compare_exchange_strong_explicit(&sampleKey, &key, key+1, memory_order_relaxed, memory_order_relaxed);
 }
 
+/* stands in for io, lets the pool run a spare while it sleeps */
 void sleepNode(Tree *t)
 {
+	poolBeginBlocking();
 	usleep(10);
+	poolEndBlocking();
 }
 
+/* draws from the calling thread's stream, see threadRandStream */
 void randArray(Tree *t)
 {
 	int i;
+	RandStream *rng = threadRandStream();
+	for (i=0; i<100; i++)
+	{
+		t->id = (int) randStreamReal(rng);
+	}
+}
+
+
+void incrementIDCompact(CompactTree *t)
+{
+	(t->id)++;
+}
+
+void searchKeyCompact(CompactTree *t)
+{
+	int key = atomic_load_explicit(&sampleKey, memory_order_relaxed);
+	if (t->id == key) atomic_compare_exchange_strong_explicit(&sampleKey, &key, key+1, memory_order_relaxed, memory_order_relaxed);
+}
+
+void sleepNodeCompact(CompactTree *t)
+{
+	poolBeginBlocking();
+	usleep(10);
+	poolEndBlocking();
+}
+
+void randArrayCompact(CompactTree *t)
+{
+	int i;
+	RandStream *rng = threadRandStream();
 	for (i=0; i<100; i++)
 	{
-		t->id = (int) genrand64_real2();
+		t->id = (int) randStreamReal(rng);
 	}
 }
 
 
+/* depth of the BST searchTreeBenchmark looks leaves up in, takes effect at 
+	the next initSearchTree (10 fits in cache, ~20 makes every lookup miss) */
+void setSearchTreeDepth(int depth)
+{
+	searchTreeDepth = depth;
+}
+
+int getSearchTreeDepth()
+{
+	return searchTreeDepth;
+}
+
+/* layout searchTreeBenchmark searches, the implicit arrays are built from the 
+	BST at the next initSearchTree and return its nodes */
+void setSearchStructure(SearchStructure structure)
+{
+	searchStructure = structure;
+}
+
+SearchStructure getSearchStructure()
+{
+	return searchStructure;
+}
+
 void initSearchTree()
 {
 	searchTree = genBalancedTree(searchTreeDepth, true);
+	if (searchStructure == SEARCH_EYTZINGER) initEytzinger(&searchArray, searchTree);
+	else if (searchStructure == SEARCH_BTREE) initSearchBTree(&searchArray, searchTree);
 }
 
 void freeSearchTree()
 {
+	freeSearchArray(&searchArray);
 	searchTree = make_empty(searchTree);
 }
 
+Tree * findSearchTree(int id)
+{
+	switch (searchStructure)
+	{
+		case SEARCH_EYTZINGER:	return findEytzinger(id, &searchArray);
+		case SEARCH_BTREE:		return findSearchBTree(id, &searchArray);
+		default:				return find(id, searchTree);
+	}
+}
+
 void searchTreeBenchmark(Tree *t)
 {
 	if (t->left == NULL && t->right == NULL)
 	{
 		t->id++;
-		t->data = (void *) find(t->id, searchTree);
+		t->data = (void *) findSearchTree(t->id);
 		// Tree *tmpTree = genRandomTree(32, true);
 		// tmpTree = make_empty(tmpTree);
 	}
 }
 
 
+/* batched versions of the callbacks above, ctx is unused */
+void incrementIDBatch(Tree **nodes, int n, void *ctx)
+{
+	int i;
+	for (i=0; i<n; i++)
+	{
+		(nodes[i]->id)++;
+	}
+}
+
+void searchKeyBatch(Tree **nodes, int n, void *ctx)
+{
+	int i, key = atomic_load_explicit(&sampleKey, memory_order_relaxed);
+	for (i=0; i<n; i++)
+	{
+		if (nodes[i]->id == key && atomic_compare_exchange_strong_explicit(
+			&sampleKey, &key, key+1, memory_order_relaxed, memory_order_relaxed)) key++;
+	}
+}
+
+void randArrayBatch(Tree **nodes, int n, void *ctx)
+{
+	int i, j;
+	RandStream *rng = threadRandStream();
+	for (i=0; i<n; i++)
+	{
+		for (j=0; j<100; j++)
+		{
+			nodes[i]->id = (int) randStreamReal(rng);
+		}
+	}
+}
+
+/* the batch's leaf lookups go through findBatch together (BST only) */
+void searchTreeBenchmarkBatch(Tree **nodes, int n, void *ctx)
+{
+	int keys[CALLBACK_BATCH_SIZE];
+	Tree *leaves[CALLBACK_BATCH_SIZE], *found[CALLBACK_BATCH_SIZE];
+	int i, m = 0;
+	Tree *t;
+	for (i=0; i<n; i++)
+	{
+		t = nodes[i];
+		if (t->left == NULL && t->right == NULL)
+		{
+			t->id++;
+			leaves[m] = t;
+			keys[m++] = t->id;
+		}
+	}
+
+	// the implicit layouts don't chase pointers, so they are just looped over
+	if (searchStructure == SEARCH_BST)
+	{
+		findBatch(keys, m, found, searchTree);
+		for (i=0; i<m; i++) leaves[i]->data = (void *) found[i];
+	}
+	else
+	{
+		for (i=0; i<m; i++) leaves[i]->data = (void *) findSearchTree(keys[i]);
+	}
+}
+
+
+/* find-first predicate, ctx is the key */
+bool matchKeyPredicate(Tree *t, void *ctx)
+{
+	return t->id == *(int *) ctx;
+}
+
+/* find() for trees that aren't BSTs: any node with the id, NULL if none */
+Tree * findKeyMT(int id, Tree *root, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+	return findFirstMT(root, &matchKeyPredicate, &id, threadPool, startArgs);
+}
+
+/* maps and combines for reduce traversals, ctx of matchKeyMap is the key */
+int64_t countMap(Tree *t, void *ctx)
+{
+	return 1;
+}
+
+int64_t matchKeyMap(Tree *t, void *ctx)
+{
+	return t->id == *(int *) ctx;
+}
+
+int64_t idMap(Tree *t, void *ctx)
+{
+	return t->id;
+}
+
+int64_t leafMap(Tree *t, void *ctx)
+{
+	return t->left == NULL && t->right == NULL;
+}
+
+int64_t addCombine(int64_t a, int64_t b)
+{
+	return a + b;
+}
+
+int64_t minCombine(int64_t a, int64_t b)
+{
+	return (a < b) ? a : b;
+}
+
+int64_t maxCombine(int64_t a, int64_t b)
+{
+	return (a > b) ? a : b;
+}
+
+/* TreeStats accumulator for traverseReduceAcc */
+void treeStatsInit(void *acc)
+{
+	TreeStats *stats = (TreeStats *) acc;
+	stats->nodes	= 0;
+	stats->leaves	= 0;
+	stats->sumID	= 0;
+	stats->minID	= INT64_MAX;
+	stats->maxID	= INT64_MIN;
+}
+
+void treeStatsFold(void *acc, Tree *t, void *ctx)
+{
+	TreeStats *stats = (TreeStats *) acc;
+	stats->nodes++;
+	stats->leaves += (t->left == NULL && t->right == NULL);
+	stats->sumID += t->id;
+	if (t->id < stats->minID) stats->minID = t->id;
+	if (t->id > stats->maxID) stats->maxID = t->id;
+}
+
+void treeStatsMerge(void *dst, void *src)
+{
+	TreeStats *a = (TreeStats *) dst, *b = (TreeStats *) src;
+	a->nodes += b->nodes;
+	a->leaves += b->leaves;
+	a->sumID += b->sumID;
+	a->minID = minCombine(a->minID, b->minID);
+	a->maxID = maxCombine(a->maxID, b->maxID);
+}
+
+/* searchKey as a reduce: matches are counted against the current key, which 
+	then moves on by the count (as soaSearchKey) */
+int64_t searchKeyMT(Tree *root, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+	int key = atomic_load(&sampleKey);
+	int64_t matches = traverseReduce(root, &matchKeyMap, &addCombine, 0, &key, threadPool, startArgs);
+	atomic_fetch_add(&sampleKey, (int) matches);
+	return matches;
+}
+
+/* every statistic in one pass */
+TreeStats treeStatsMT(Tree *root, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+	TreeStats stats;
+	ReduceAccOp op = {&treeStatsInit, &treeStatsFold, &treeStatsMerge, sizeof(TreeStats), NULL};
+	traverseReduceAcc(root, &op, &stats, threadPool, startArgs);
+	return stats;
+}
+
+
 /******************************************************************************* 
 ---------------------------------- UNIT TESTS ----------------------------------
 *******************************************************************************/
@@ -17,12 +17,17 @@
 ------------------------------- IMPORTS & PARAMS -------------------------------
 *******************************************************************************/
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 
 #include "binaryTree.h"
+#include "nodeAlloc.h"
 #include "util.h"
 
+/* generator behind the random entry points, see setRandomTreeGen */
+static RandomTreeGen randomTreeGen = RANDOM_GEN_INVTABLE;
+
 
 /******************************************************************************* 
 ------------------------------- HELPER FUNCTIONS -------------------------------
@@ -44,12 +49,12 @@ double getQ(double N, double j, double k)
 	return  ( (k+1)*(N-j+k+1) ) / ( (k+2)*(2*(N-j)+k-1) );
 }
 
-int assign(int N, int i, int j)
+/* x is the uniform draw in [0, 1) that picks the entry */
+int assignUniform(int N, int i, int j, double x)
 {
 	int k = i + 1;
 	double P = getP(N, i, j);
 	double sum = P;
-	double x = genrand64_real2();
 	while ((1-x) > sum)
 	{
 		P *= getQ(N, j, k);
@@ -59,6 +64,11 @@ int assign(int N, int i, int j)
 	return k;
 }
 
+int assign(int N, int i, int j)
+{
+	return assignUniform(N, i, j, genrand64_real2());
+}
+
 void genInversionTable(int *invTable, int N)
 {
 	*invTable = 0;
@@ -71,12 +81,17 @@ void genInversionTable(int *invTable, int N)
 	}
 }
 
+/* lastDepth[v] is the depth of the latest node with value v, which is where a 
+	node with value v that isn't a left child hangs as the right child */
 void genInversionTableOptimized(int *invTable, int N, TreeInfo *treeInfo)
 {
 	treeInfo->size 		= 1;
 	treeInfo->depth		= 0;
 	treeInfo->leaves	= 1;
 
+	int *lastDepth = (int *) malloc(N * sizeof(int));
+	lastDepth[0] = 0;
+
 	*invTable = 0;
 	int i, depth;
 	for (depth=0; treeInfo->size < N; (treeInfo->size)++)
@@ -88,21 +103,110 @@ void genInversionTableOptimized(int *invTable, int N, TreeInfo *treeInfo)
 		if (*invTable >= i)
 		{
 			depth++;
-			if (depth > treeInfo->depth)
-			{
-				treeInfo->depth = depth;
-			}
 		}
 		else
 		{
 			(treeInfo->leaves)++;
-			depth -= (i - *invTable - 1);
+			depth = lastDepth[*invTable] + 1;
+		}
+		if (depth > treeInfo->depth)
+		{
+			treeInfo->depth = depth;
 		}
+		lastDepth[*invTable] = depth;
 	}
 
+	free(lastDepth);
 	treeInfo->density = treeDensity(treeInfo->size, treeInfo->leaves);
 }
 
+/* uniform integer in [0, m) by multiply-shift, the bias is below m / 2^64 */
+uint64_t randBelow(uint64_t m)
+{
+	return (uint64_t) (((unsigned __int128) genrand64_int64() * m) >> 64);
+}
+
+/* word bit p is 1 for a node and 0 for an empty child slot */
+uint64_t wordBit(uint64_t *word, long p)
+{
+	return (word[p >> 6] >> (p & 63)) & 1;
+}
+
+/* uniform trees without floating point: a word of N ones and N+1 zeros is 
+	drawn one symbol at a time (a one with probability ones left / symbols 
+	left, so every word is equally likely). By the cycle lemma exactly one 
+	rotation of it, the one starting after the first minimum of the prefix 
+	sums, is the pre-order encoding of a tree, so each tree gets 2N+1 words. 
+	Leaves are the cyclic "100" patterns, which rotation doesn't change. The 
+	rotation is decoded into the inversion table with a stack of pending child 
+	slots holding (value, depth); both loops are branchless on the symbol since 
+	it is a coin flip */
+void genInversionTableDyck(int *invTable, int N, TreeInfo *treeInfo)
+{
+	long len = 2L * N + 1;
+	long p, i, start = 0, ones = N, sum = 0, minSum = 0, top;
+	uint64_t *word = (uint64_t *) calloc((len + 63) / 64, sizeof(uint64_t));
+	uint64_t bit, last = 0, window = 0;
+	int val, depth, maxDepth = 0, leaves = 0;
+	int *slots = (int *) malloc(2 * (N + 2) * sizeof(int));
+
+	for (p=0; p<len; p++)
+	{
+		bit = randBelow(len - p) < (uint64_t) ones;
+		word[p >> 6] |= bit << (p & 63);
+		ones -= bit;
+		sum += 2 * (long) bit - 1;
+		window = ((window << 1) | bit) & 7;
+		leaves += window == 4;
+		if (sum < minSum)
+		{
+			minSum = sum;
+			start = p + 1;
+		}
+	}
+	/* patterns that wrap around the end */
+	last = wordBit(word, len - 1);
+	leaves += last && !wordBit(word, 0) && !wordBit(word, 1);
+	leaves += wordBit(word, len - 2) && !last && !wordBit(word, 0);
+
+	/* the rotation ends in zeros, so decoding stops at the N-th node */
+	slots[0] = 0;
+	slots[1] = 0;
+	top = 1;
+	for (i=0, p=start; i<N; p++)
+	{
+		if (p == len) p = 0;
+		bit = wordBit(word, p);
+		val = slots[2*top-2];
+		depth = slots[2*top-1];
+		invTable[i] = val;
+		i += bit;
+		maxDepth = depth > maxDepth && bit ? depth : maxDepth;
+
+		/* a node replaces its slot by its right and left slots (left on top), 
+			an empty slot is just popped and the writes land above the top */
+		slots[2*top-2] = val;
+		slots[2*top-1] = depth + 1;
+		slots[2*top] = val + 1;
+		slots[2*top+1] = depth + 1;
+		top += 2 * (long) bit - 1;
+	}
+
+	free(word);
+	free(slots);
+	treeInfo->size		= N;
+	treeInfo->depth		= maxDepth;
+	treeInfo->leaves	= leaves;
+	treeInfo->density	= treeDensity(N, leaves);
+}
+
+/* fills invTable and treeInfo with the selected random generator */
+void genRandomInvTable(int *invTable, int N, TreeInfo *treeInfo)
+{
+	if (randomTreeGen == RANDOM_GEN_DYCK) genInversionTableDyck(invTable, N, treeInfo);
+	else genInversionTableOptimized(invTable, N, treeInfo);
+}
+
 void genBalancedIT(int *invTable, int depth)
 {
 	*invTable = 0;
@@ -153,10 +257,21 @@ void genTree2StdOut(int N)
 	}
 }
 
+/* pre-order builders: a node's subtree ends where the walk up passes it, so 
+	subtreeSize is the index it ended at minus its own. closes the chain left 
+	open at the end of the table */
+void closeSubtrees(ITNode *currentIT, ITNode *itNodeArray, int N)
+{
+	for (; currentIT != NULL; currentIT = currentIT->parent)
+	{
+		currentIT->tree->subtreeSize = N - (currentIT - itNodeArray);
+	}
+}
+
 Tree * invTab2BT(int *invTable, int N)
 {
 	ITNode *itNodeArray = (ITNode *) malloc(N * sizeof(ITNode));
-	Tree *root = (Tree *) malloc(sizeof(Tree));
+	Tree *root = allocNode();
 
 	ITNode *currentIT, *prevIT;
 	Tree *currentBT, *prevBT;
@@ -179,7 +294,7 @@ Tree * invTab2BT(int *invTable, int N)
 		prevIT = currentIT;
 		prevBT = currentBT;
 
-		currentBT 			= (Tree *) malloc(sizeof(Tree));
+		currentBT 			= allocNode();
 		currentBT->id		= i;
 		currentBT->data		= NULL;
 		currentBT->left		= NULL;
@@ -201,6 +316,7 @@ Tree * invTab2BT(int *invTable, int N)
 			while (currentIT->val < prevIT->val) 
 			{
 				// printf("Moving Up\n");
+				prevIT->tree->subtreeSize = i - (prevIT - itNodeArray);
 				prevIT = prevIT->parent;
 			};
 			// printf("Moving Right\n");
@@ -209,6 +325,8 @@ Tree * invTab2BT(int *invTable, int N)
 		}
 	}
 
+	// nodes still on the parent chain end with the last node
+	closeSubtrees(currentIT, itNodeArray, N);
 	free(itNodeArray);
 
 	return root;
@@ -261,6 +379,7 @@ Tree * invTab2ContBT(int *invTable, Tree *btNodeArray, int N)
 			while (currentIT->val < prevIT->val) 
 			{
 				// printf("Moving Up\n");
+				prevIT->tree->subtreeSize = i - (prevIT - itNodeArray);
 				prevIT = prevIT->parent;
 			};
 			// printf("Moving Right\n");
@@ -269,6 +388,8 @@ Tree * invTab2ContBT(int *invTable, Tree *btNodeArray, int N)
 		}
 	}
 
+	// nodes still on the parent chain end with the last node
+	closeSubtrees(currentIT, itNodeArray, N);
 	free(itNodeArray);
 
 	return root;
@@ -276,7 +397,7 @@ Tree * invTab2ContBT(int *invTable, Tree *btNodeArray, int N)
 
 Tree * invTab2BTOptimized(int *invTable, ITNode *itNodeArray, int N)
 {
-	Tree *root = (Tree *) malloc(sizeof(Tree));
+	Tree *root = allocNode();
 
 	ITNode *currentIT, *prevIT;
 	Tree *currentBT, *prevBT;
@@ -299,7 +420,7 @@ Tree * invTab2BTOptimized(int *invTable, ITNode *itNodeArray, int N)
 		prevIT = currentIT;
 		prevBT = currentBT;
 
-		currentBT 			= (Tree *) malloc(sizeof(Tree));
+		currentBT 			= allocNode();
 		currentBT->id		= i;
 		currentBT->data		= NULL;
 		currentBT->left		= NULL;
@@ -321,6 +442,7 @@ Tree * invTab2BTOptimized(int *invTable, ITNode *itNodeArray, int N)
 			while (currentIT->val < prevIT->val) 
 			{
 				// printf("Moving Up\n");
+				prevIT->tree->subtreeSize = i - (prevIT - itNodeArray);
 				prevIT = prevIT->parent;
 			};
 			// printf("Moving Right\n");
@@ -329,6 +451,9 @@ Tree * invTab2BTOptimized(int *invTable, ITNode *itNodeArray, int N)
 		}
 	}
 
+	// nodes still on the parent chain end with the last node
+	closeSubtrees(currentIT, itNodeArray, N);
+
 	return root;
 }
 
@@ -378,6 +503,7 @@ Tree * invTab2ContBTOptimized(int *invTable, Tree *btNodeArray, ITNode *itNodeAr
 			while (currentIT->val < prevIT->val) 
 			{
 				// printf("Moving Up\n");
+				prevIT->tree->subtreeSize = i - (prevIT - itNodeArray);
 				prevIT = prevIT->parent;
 			};
 			// printf("Moving Right\n");
@@ -386,9 +512,105 @@ Tree * invTab2ContBTOptimized(int *invTable, Tree *btNodeArray, ITNode *itNodeAr
 		}
 	}
 
+	// nodes still on the parent chain end with the last node
+	closeSubtrees(currentIT, itNodeArray, N);
+
 	return root;
 }
 
+/* same construction as invTab2ContBTOptimized but with child indices (node i 
+	of the inversion table is index i, root is 0). children go to 
+	left[i*stride]/right[i*stride], so one builder serves both compact nodes 
+	and SoA columns */
+void invTab2Indices(
+	int *invTable, ITNode *itNodeArray, uint32_t *left, uint32_t *right, int stride, int N
+)
+{
+	ITNode *currentIT, *prevIT;
+
+	left[0]		= COMPACT_NULL;
+	right[0]	= COMPACT_NULL;
+
+	currentIT 			= itNodeArray;
+	currentIT->val		= *invTable;
+	currentIT->tree		= NULL;
+	currentIT->parent	= NULL;
+	
+	uint32_t i;
+	for (i=1; i<(uint32_t) N; i++)
+	{
+		invTable++;
+		prevIT = currentIT;
+
+		left[i*stride]	= COMPACT_NULL;
+		right[i*stride]	= COMPACT_NULL;
+
+		currentIT++;
+		currentIT->val		= *invTable;
+		currentIT->tree		= NULL;
+		currentIT->parent	= NULL;
+
+		if (currentIT->val > prevIT->val)
+		{
+			left[(i-1)*stride] = i;
+			currentIT->parent = prevIT;
+		}
+		else 
+		{
+			while (currentIT->val < prevIT->val) 
+			{
+				prevIT = prevIT->parent;
+			};
+			right[(prevIT - itNodeArray)*stride] = i;
+			currentIT->parent = prevIT;
+		}
+	}
+}
+
+void invTab2CompactBT(int *invTable, CompactTree *ctNodeArray, ITNode *itNodeArray, int N)
+{
+	int i;
+	for (i=0; i<N; i++) ctNodeArray[i].id = i;
+	invTab2Indices(
+		invTable, itNodeArray, &(ctNodeArray->left), &(ctNodeArray->right), 
+		sizeof(CompactTree) / sizeof(uint32_t), N
+	);
+}
+
+/* the same again into separate id/left/right/data columns */
+void invTab2SoABT(int *invTable, SoATree *soaTree, ITNode *itNodeArray, int N)
+{
+	int i;
+	for (i=0; i<N; i++)
+	{
+		soaTree->id[i]		= i;
+		soaTree->data[i]	= NULL;
+	}
+	invTab2Indices(invTable, itNodeArray, soaTree->left, soaTree->right, 1, N);
+}
+
+void soa2BST(SoATree *soaTree, uint32_t root, int *id)
+{
+	if (root != COMPACT_NULL)
+	{
+		soa2BST(soaTree, soaTree->left[root], id);
+		soaTree->id[root] = *id;
+		(*id)++;
+		soa2BST(soaTree, soaTree->right[root], id);
+	}
+}
+
+void compact2BST(CompactTree *ctNodeArray, uint32_t root, int *id)
+{
+	if (root != COMPACT_NULL)
+	{
+		compact2BST(ctNodeArray, ctNodeArray[root].left, id);
+		ctNodeArray[root].id = *id;
+		(*id)++;
+		compact2BST(ctNodeArray, ctNodeArray[root].right, id);
+	}
+}
+
 void bs2BST(Tree *root, int *id)
 {
 	if (root != NULL)
@@ -406,6 +628,29 @@ void convert2BST(Tree *root)
 	bs2BST(root, &id);
 }
 
+/* copies a contiguous tree (in any layout) into compact nodes at the same 
+	positions, returns the root index */
+uint32_t contTree2Compact(Tree *root, Tree *btNodeArray, CompactTree *ctNodeArray, int N)
+{
+	int i;
+	Tree *src;
+	CompactTree *dst;
+	for (i=0, src=btNodeArray, dst=ctNodeArray; i<N; i++, src++, dst++)
+	{
+		dst->id		= src->id;
+		dst->left	= (src->left != NULL) ? (uint32_t) (src->left - btNodeArray) : COMPACT_NULL;
+		dst->right	= (src->right != NULL) ? (uint32_t) (src->right - btNodeArray) : COMPACT_NULL;
+	}
+	return (uint32_t) (root - btNodeArray);
+}
+
+int computeSubtreeSizes(Tree *root)
+{
+	if (root == NULL) return 0;
+	root->subtreeSize = 1 + computeSubtreeSizes(root->left) + computeSubtreeSizes(root->right);
+	return root->subtreeSize;
+}
+
 
 
 /******************************************************************************* 
@@ -414,11 +659,29 @@ void convert2BST(Tree *root)
 
 /* -------------------------------------------------------------------------- */
 
+void setRandomTreeGen(RandomTreeGen gen)
+{
+	randomTreeGen = gen;
+}
+
+RandomTreeGen getRandomTreeGen()
+{
+	return randomTreeGen;
+}
+
+const char * randomTreeGenName(RandomTreeGen gen)
+{
+	return gen == RANDOM_GEN_DYCK ? "dyck" : "invtable";
+}
+
+/* -------------------------------------------------------------------------- */
+
 /* exportable functions that don't require other types (i.e. ITNode) */
 Tree * genRandomTree(int N, bool isBST)
 {
 	int *invTable = (int *) malloc(N * sizeof(int));
-	genInversionTable(invTable, N);
+	TreeInfo treeInfo;
+	genRandomInvTable(invTable, N, &treeInfo);
 	Tree *root = invTab2BT(invTable, N);
 	free(invTable);
 	if (isBST) convert2BST(root);
@@ -428,7 +691,8 @@ Tree * genRandomTree(int N, bool isBST)
 Tree * genContRandomTree(Tree *btNodeArray, int N, bool isBST)
 {
 	int *invTable = (int *) malloc(N * sizeof(int));
-	genInversionTable(invTable, N);	
+	TreeInfo treeInfo;
+	genRandomInvTable(invTable, N, &treeInfo);
 	Tree *root = invTab2ContBT(invTable, btNodeArray, N);
 	free(invTable);
 	if (isBST) convert2BST(root);
@@ -464,7 +728,7 @@ TreeInfo genRandomTreeOptimized(int *invTable, ITNode *itNodeArray, int N, bool
 {	
 	TreeInfo treeInfo = {0};
 	treeInfo.size = N;
-	genInversionTableOptimized(invTable, N, &treeInfo);
+	genRandomInvTable(invTable, N, &treeInfo);
 	treeInfo.root = invTab2BTOptimized(invTable, itNodeArray, N);
 	if (isBST) convert2BST(treeInfo.root);
 	return treeInfo;
@@ -474,7 +738,7 @@ TreeInfo genContRandomTreeOptimized(int *invTable, Tree *btNodeArray, ITNode *it
 {
 	TreeInfo treeInfo = {0};
 	treeInfo.size = N;
-	genInversionTableOptimized(invTable, N, &treeInfo);	
+	genRandomInvTable(invTable, N, &treeInfo);	
 	treeInfo.root = invTab2ContBTOptimized(invTable, btNodeArray, itNodeArray, N);
 	if (isBST) convert2BST(treeInfo.root);
 	return treeInfo;
@@ -508,6 +772,60 @@ TreeInfo genContBalancedTreeOptimized(int *invTable, Tree *btNodeArray, ITNode *
 
 /* -------------------------------------------------------------------------- */
 
+/* compact generators, treeInfo.root is NULL and the root is always index 0 */
+TreeInfo genCompactRandomTree(int *invTable, CompactTree *ctNodeArray, ITNode *itNodeArray, int N, bool isBST)
+{
+	TreeInfo treeInfo = {0};
+	treeInfo.size = N;
+	genRandomInvTable(invTable, N, &treeInfo);
+	invTab2CompactBT(invTable, ctNodeArray, itNodeArray, N);
+	int id = 0;
+	if (isBST) compact2BST(ctNodeArray, 0, &id);
+	return treeInfo;
+}
+
+TreeInfo genCompactBalancedTree(int *invTable, CompactTree *ctNodeArray, ITNode *itNodeArray, int depth, bool isBST)
+{
+	TreeInfo treeInfo = {0};
+	treeInfo.size = (1<<(depth+1))-1;
+	treeInfo.depth = depth;
+	treeInfo.leaves = (1<<depth);
+	treeInfo.density = treeDensity(treeInfo.size, treeInfo.leaves);
+	genBalancedIT(invTable, depth);
+	invTab2CompactBT(invTable, ctNodeArray, itNodeArray, treeInfo.size);
+	int id = 0;
+	if (isBST) compact2BST(ctNodeArray, 0, &id);
+	return treeInfo;
+}
+
+/* soaTree must already hold N (or 2^(depth+1)-1) nodes, see initSoATree */
+TreeInfo genSoARandomTree(int *invTable, SoATree *soaTree, ITNode *itNodeArray, int N, bool isBST)
+{
+	TreeInfo treeInfo = {0};
+	treeInfo.size = N;
+	genRandomInvTable(invTable, N, &treeInfo);
+	invTab2SoABT(invTable, soaTree, itNodeArray, N);
+	int id = 0;
+	if (isBST) soa2BST(soaTree, 0, &id);
+	return treeInfo;
+}
+
+TreeInfo genSoABalancedTree(int *invTable, SoATree *soaTree, ITNode *itNodeArray, int depth, bool isBST)
+{
+	TreeInfo treeInfo = {0};
+	treeInfo.size = (1<<(depth+1))-1;
+	treeInfo.depth = depth;
+	treeInfo.leaves = (1<<depth);
+	treeInfo.density = treeDensity(treeInfo.size, treeInfo.leaves);
+	genBalancedIT(invTable, depth);
+	invTab2SoABT(invTable, soaTree, itNodeArray, treeInfo.size);
+	int id = 0;
+	if (isBST) soa2BST(soaTree, 0, &id);
+	return treeInfo;
+}
+
+/* -------------------------------------------------------------------------- */
+
 /******************************************************************************* 
 --------------------------------- END OF FILE ----------------------------------
 *******************************************************************************/
\ No newline at end of file
@@ -0,0 +1,370 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file bulkBST.c
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Bulk BST construction and insertion from sorted keys: a serial
+ *  skeleton splits the keys on node ids (or midpoints where the tree is
+ *  empty) and the thread pool merges/builds the independent pieces.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "types.h"
+#include "bulkBST.h"
+#include "nodeAlloc.h"
+#include "threadpool.h"
+#include "util.h"
+
+
+
+/******************************************************************************* 
+------------------------------- HELPER FUNCTIONS -------------------------------
+*******************************************************************************/
+/* arena/pool/shuffled allocators aren't thread-safe, so with one of those
+	installed fragmented pieces are built by the calling thread only */
+bool bulkParallelAlloc(BulkBSTJob *job)
+{
+	NodeAllocator *allocator = getNodeAllocator();
+	return job->btNodeArray != NULL || allocator == NULL || allocator->mode == ALLOC_MALLOC;
+}
+
+Tree * bulkNode(BulkBSTJob *job, int begin)
+{
+	return (job->btNodeArray != NULL) ? job->btNodeArray + begin : allocNode();
+}
+
+/* first of keys[lo, lo+n) that is >= id, as an offset from lo */
+int bulkLowerBound(int *keys, int lo, int n, int id)
+{
+	int first = 0, half;
+	while (n > 0)
+	{
+		half = n / 2;
+		if (keys[lo + first + half] < id)
+		{
+			first += half + 1;
+			n -= half + 1;
+		}
+		else
+		{
+			n = half;
+		}
+	}
+	return first;
+}
+
+/* same split as genBalancedIT (right side gets the extra node), the subtree
+	is written in pre-order from begin when contiguous */
+Tree * buildSortedRange(BulkBSTJob *job, int lo, int n, int begin, int *leaves)
+{
+	int left = (n-1) / 2;
+	Tree *node;
+
+	if (n <= 0) return NULL;
+	node = bulkNode(job, begin);
+	node->id			= job->keys[lo + left];
+	node->subtreeSize	= n;
+	node->data			= NULL;
+	node->left			= buildSortedRange(job, lo, left, begin+1, leaves);
+	node->right			= buildSortedRange(job, lo+left+1, n-1-left, begin+1+left, leaves);
+	*leaves += (n == 1);
+	return node;
+}
+
+/* returns the number of keys added below link */
+int mergeSortedRange(BulkBSTJob *job, Tree **link, int lo, int n, int begin, int *leaves)
+{
+	Tree *t = *link;
+	int k, dup, inserted;
+
+	if (n <= 0) return 0;
+	if (t == NULL)
+	{
+		*link = buildSortedRange(job, lo, n, begin, leaves);
+		return n;
+	}
+
+	k = bulkLowerBound(job->keys, lo, n, t->id);
+	dup = (k < n && job->keys[lo + k] == t->id);
+	inserted = mergeSortedRange(job, &(t->left), lo, k, 0, leaves)
+		+ mergeSortedRange(job, &(t->right), lo+k+dup, n-k-dup, 0, leaves);
+	t->subtreeSize += inserted;
+	return inserted;
+}
+
+BulkItem * addBulkItem(BulkBSTJob *job)
+{
+	BulkItem *item;
+	if (job->numItems == job->itemCapacity)
+	{
+		job->itemCapacity *= 2;
+		job->items = (BulkItem *) realloc(job->items, job->itemCapacity * sizeof(BulkItem));
+	}
+	item = job->items + (job->numItems)++;
+	item->link		= NULL;
+	item->split		= NULL;
+	item->lo		= 0;
+	item->n			= 0;
+	item->begin		= 0;
+	item->first		= 0;
+	item->inserted	= 0;
+	item->leaves	= 0;
+	return item;
+}
+
+/* splits keys [lo, lo+n) going into link until every run fits in grain keys,
+	an empty subtree is split on its midpoint (that node is created here) and
+	an existing one on its id. the split node is added after everything below
+	it so items end up in post-order */
+void splitBulk(BulkBSTJob *job, Tree **link, int lo, int n, int begin)
+{
+	Tree *t = *link;
+	BulkItem *item;
+	int first = job->numItems, created = 0, left, k, dup;
+
+	if (n <= 0) return;
+	if (n <= job->grain)
+	{
+		item = addBulkItem(job);
+		item->link	= link;
+		item->lo	= lo;
+		item->n		= n;
+		item->begin	= begin;
+		return;
+	}
+
+	if (t == NULL)
+	{
+		left = (n-1) / 2;
+		t = bulkNode(job, begin);
+		t->id			= job->keys[lo + left];
+		t->subtreeSize	= 0;
+		t->data			= NULL;
+		t->left			= NULL;
+		t->right		= NULL;
+		*link = t;
+		created = 1;
+		splitBulk(job, &(t->left), lo, left, begin+1);
+		splitBulk(job, &(t->right), lo+left+1, n-1-left, begin+1+left);
+	}
+	else
+	{
+		k = bulkLowerBound(job->keys, lo, n, t->id);
+		dup = (k < n && job->keys[lo + k] == t->id);
+		splitBulk(job, &(t->left), lo, k, 0);
+		splitBulk(job, &(t->right), lo+k+dup, n-k-dup, 0);
+	}
+
+	item = addBulkItem(job);
+	item->split		= t;
+	item->first		= first;
+	item->inserted	= created;
+}
+
+/* consecutive items holding roughly n/numChunks keys each (as buildChunks) */
+void buildBulkChunks(BulkBSTJob *job, int n, int numChunks)
+{
+	long target = ((long) n + numChunks - 1) / numChunks, filled = 0;
+	int i;
+
+	job->chunks = (GenChunk *) malloc((job->numItems + 1) * sizeof(GenChunk));
+	job->numChunks = 0;
+	job->chunks[0].first = 0;
+	for (i=0; i<job->numItems; i++)
+	{
+		filled += job->items[i].n;
+		if (filled >= target || i == job->numItems-1)
+		{
+			job->chunks[job->numChunks].last = i+1;
+			job->numChunks++;
+			job->chunks[job->numChunks].first = i+1;
+			filled = 0;
+		}
+	}
+}
+
+void runBulkChunk(BulkBSTJob *job, GenChunk *chunk, TraversalThread *thread)
+{
+	BulkItem *item;
+	int i;
+	for (i=chunk->first; i<chunk->last; i++)
+	{
+		item = job->items + i;
+		if (item->split != NULL) continue;
+		item->inserted = mergeSortedRange(job, item->link, item->lo, item->n, item->begin, &(item->leaves));
+		if (thread != NULL) thread->totalCallbacks += item->n;
+	}
+}
+
+/* hands chunks 1..n-1 to thieves and runs the rest itself (as genTreeMT) */
+void bulkBSTMT(
+	Tree *root, TreeCallback callback,
+	TraversalThread *thread, ThreadPool *threadPool
+)
+{
+	BulkBSTJob *job = (BulkBSTJob *) threadPool->task.jobCtx;
+	GenChunk *chunk;
+	int i;
+
+	for (i=1; i<job->numChunks; i++)
+	{
+		if (!pushDeque(&(thread->deque), job->chunks + i))
+		{
+			runBulkChunk(job, job->chunks + i, thread);
+		}
+	}
+
+	runBulkChunk(job, job->chunks, thread);
+	while ((chunk = (GenChunk *) popDeque(&(thread->deque))) != NULL)
+	{
+		runBulkChunk(job, chunk, thread);
+	}
+}
+
+void bulkBSTMTStolen(
+	void *work, TreeCallback callback,
+	TraversalThread *thread, ThreadPool *threadPool
+)
+{
+	runBulkChunk((BulkBSTJob *) threadPool->task.jobCtx, (GenChunk *) work, thread);
+}
+
+/* skeleton, pieces on the pool, then the skeleton's sizes: a split's subtree
+	is the run of items [first, itself], so prefix sums of inserted give what
+	was added below it. returns the keys inserted */
+int runBulkJob(
+	BulkBSTJob *job, Tree **root, int n, int *leaves,
+	ThreadPool *threadPool, StartThreadArgs *startArgs
+)
+{
+	long *prefix;
+	int i, inserted;
+	BulkItem *item;
+
+	job->grain = (n / BULK_SKELETON_SPLIT > 0) ? n / BULK_SKELETON_SPLIT : 1;
+	job->numItems = 0;
+	job->itemCapacity = 64;
+	job->items = (BulkItem *) malloc(job->itemCapacity * sizeof(BulkItem));
+	splitBulk(job, root, 0, n, 0);
+	buildBulkChunks(job, n, BULK_CHUNKS_PER_THREAD * (threadPool->size + 1));
+
+	if (bulkParallelAlloc(job))
+	{
+		runJobMT(threadPool, startArgs, bulkBSTMT, bulkBSTMTStolen, job);
+	}
+	else
+	{
+		for (i=0; i<job->numChunks; i++) runBulkChunk(job, job->chunks + i, NULL);
+	}
+
+	prefix = (long *) malloc((job->numItems + 1) * sizeof(long));
+	prefix[0] = 0;
+	*leaves = 0;
+	for (i=0, item=job->items; i<job->numItems; i++, item++)
+	{
+		prefix[i+1] = prefix[i] + item->inserted;
+		*leaves += item->leaves;
+		if (item->split != NULL) item->split->subtreeSize += prefix[i+1] - prefix[item->first];
+	}
+	inserted = prefix[job->numItems];
+
+	free(prefix);
+	free(job->items);
+	free(job->chunks);
+	return inserted;
+}
+
+TreeInfo bulkTreeInfo(Tree *root, int N, int leaves)
+{
+	TreeInfo treeInfo = {0};
+	int height;
+
+	for (height=0; (1L << height) - 1 < N; height++);
+	treeInfo.size		= N;
+	treeInfo.leaves		= leaves;
+	treeInfo.depth		= (height > 0) ? height - 1 : 0;
+	treeInfo.density	= (N > 0) ? treeDensity(N, leaves) : 0;
+	treeInfo.root		= root;
+	return treeInfo;
+}
+
+
+
+/******************************************************************************* 
+------------------------------- PRIMARY EXPORTS --------------------------------
+*******************************************************************************/
+TreeInfo buildBSTSorted(int *keys, int N, Tree *btNodeArray)
+{
+	BulkBSTJob job = {0};
+	int leaves = 0;
+	Tree *root;
+
+	job.keys = keys;
+	job.btNodeArray = btNodeArray;
+	root = buildSortedRange(&job, 0, N, 0, &leaves);
+	return bulkTreeInfo(root, N, leaves);
+}
+
+TreeInfo buildBSTSortedMT(
+	int *keys, int N, Tree *btNodeArray,
+	ThreadPool *threadPool, StartThreadArgs *startArgs
+)
+{
+	BulkBSTJob job = {0};
+	int leaves = 0;
+	Tree *root = NULL;
+
+	if (N < BULK_MIN_PARALLEL) return buildBSTSorted(keys, N, btNodeArray);
+
+	job.keys = keys;
+	job.btNodeArray = btNodeArray;
+	runBulkJob(&job, &root, N, &leaves, threadPool, startArgs);
+	return bulkTreeInfo(root, N, leaves);
+}
+
+/* -------------------------------------------------------------------------- */
+
+Tree * insertSorted(Tree *root, int *keys, int n)
+{
+	BulkBSTJob job = {0};
+	int leaves = 0;
+
+	job.keys = keys;
+	mergeSortedRange(&job, &root, 0, n, 0, &leaves);
+	return root;
+}
+
+Tree * insertSortedMT(
+	Tree *root, int *keys, int n,
+	ThreadPool *threadPool, StartThreadArgs *startArgs
+)
+{
+	BulkBSTJob job = {0};
+	int leaves = 0;
+
+	if (n < BULK_MIN_PARALLEL) return insertSorted(root, keys, n);
+
+	job.keys = keys;
+	runBulkJob(&job, &root, n, &leaves, threadPool, startArgs);
+	return root;
+}
+
+/* -------------------------------------------------------------------------- */
+
+
+
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
@@ -0,0 +1,531 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file concurrentTree.c
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Concurrent BST with lock-free finds, per-node locks for inserts and
+ *  deletes, and epoch-based reclamation of unlinked nodes.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "types.h"
+#include "concurrentTree.h"
+
+/* the global epoch starts at 1 so a slot's 0 always means "outside" */
+static _Alignas(CACHE_LINE_SIZE) atomic_ulong globalEpoch = 1;
+static atomic_int epochSlotCount = 0;
+static EpochSlot epochSlots[EBR_MAX_THREADS];
+static _Thread_local EpochSlot *epochSlot = NULL;
+
+/* limbo lists of exited threads, bucket i holds nodes retired in orphanEpoch[i] */
+static atomic_flag orphanLock = ATOMIC_FLAG_INIT;
+static unsigned long orphanEpoch[3];
+static ConcurrentNode *orphanLimbo[3];
+
+/* the key's destructor gives a thread's slot back when it exits */
+static pthread_once_t epochKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t epochKey;
+
+
+
+/******************************************************************************* 
+------------------------------- HELPER FUNCTIONS -------------------------------
+*******************************************************************************/
+void lockConcurrentNode(ConcurrentNode *node)
+{
+	while (atomic_flag_test_and_set_explicit(&(node->lock), memory_order_acquire))
+	{
+		sched_yield();
+	}
+}
+
+void unlockConcurrentNode(ConcurrentNode *node)
+{
+	atomic_flag_clear_explicit(&(node->lock), memory_order_release);
+}
+
+ConcurrentNode * newConcurrentNode(int id, void *data)
+{
+	ConcurrentNode *node = (ConcurrentNode *) malloc(sizeof(ConcurrentNode));
+	node->id = id;
+	atomic_flag_clear(&(node->lock));
+	atomic_init(&(node->deleted), false);
+	atomic_init(&(node->removed), false);
+	node->data = data;
+	atomic_init(&(node->left), NULL);
+	atomic_init(&(node->right), NULL);
+	node->retired = NULL;
+	return node;
+}
+
+void freeConcurrentNodes(ConcurrentNode *node)
+{
+	if (node == NULL) return;
+	freeConcurrentNodes(atomic_load_explicit(&(node->left), memory_order_relaxed));
+	freeConcurrentNodes(atomic_load_explicit(&(node->right), memory_order_relaxed));
+	free(node);
+}
+
+bool isDeleted(ConcurrentNode *node)
+{
+	return atomic_load_explicit(&(node->deleted), memory_order_acquire);
+}
+
+bool isRemoved(ConcurrentNode *node)
+{
+	return atomic_load_explicit(&(node->removed), memory_order_acquire);
+}
+
+
+
+/******************************************************************************* 
+------------------------------ EPOCH RECLAMATION -------------------------------
+*******************************************************************************/
+void freeRetired(ConcurrentNode *node)
+{
+	ConcurrentNode *next;
+	while (node != NULL)
+	{
+		next = node->retired;
+		free(node);
+		node = next;
+	}
+}
+
+void freeLimbo(EpochSlot *slot, int i)
+{
+	freeRetired(slot->limbo[i]);
+	slot->limbo[i] = NULL;
+}
+
+void lockOrphans()
+{
+	while (atomic_flag_test_and_set_explicit(&orphanLock, memory_order_acquire))
+	{
+		sched_yield();
+	}
+}
+
+void unlockOrphans()
+{
+	atomic_flag_clear_explicit(&orphanLock, memory_order_release);
+}
+
+/* a list retired in epoch goes to bucket epoch % 3. of it and the list already 
+	there, the older one is at least 3 epochs back and can be freed now */
+void adoptLimbo(ConcurrentNode *list, unsigned long epoch)
+{
+	ConcurrentNode *tail;
+	int i = epoch % 3;
+
+	if (list == NULL) return;
+	if (orphanEpoch[i] > epoch)
+	{
+		freeRetired(list);
+		return;
+	}
+	if (orphanEpoch[i] < epoch)
+	{
+		freeRetired(orphanLimbo[i]);
+		orphanLimbo[i] = NULL;
+		orphanEpoch[i] = epoch;
+	}
+	for (tail=list; tail->retired!=NULL; tail=tail->retired);
+	tail->retired = orphanLimbo[i];
+	orphanLimbo[i] = list;
+}
+
+/* called by whoever moves the epoch on, skipped if the orphans are busy */
+void freeOrphans(unsigned long epoch)
+{
+	int i;
+	if (atomic_flag_test_and_set_explicit(&orphanLock, memory_order_acquire)) return;
+	for (i=0; i<3; i++)
+	{
+		if (orphanLimbo[i] != NULL && orphanEpoch[i] + 2 <= epoch)
+		{
+			freeRetired(orphanLimbo[i]);
+			orphanLimbo[i] = NULL;
+		}
+	}
+	unlockOrphans();
+}
+
+/* thread exit (always outside an operation): the limbo lists outlive the 
+	thread as orphans and the slot can be claimed again */
+void releaseEpochSlot(void *arg)
+{
+	EpochSlot *slot = (EpochSlot *) arg;
+	int i;
+
+	lockOrphans();
+	for (i=0; i<3; i++)
+	{
+		adoptLimbo(slot->limbo[i], slot->limboEpoch[i]);
+		slot->limbo[i] = NULL;
+		slot->limboEpoch[i] = 0;
+	}
+	unlockOrphans();
+	atomic_store_explicit(&(slot->epoch), 0, memory_order_relaxed);
+	atomic_store_explicit(&(slot->inUse), false, memory_order_release);
+}
+
+void createEpochKey()
+{
+	pthread_key_create(&epochKey, releaseEpochSlot);
+}
+
+/* claims the first free slot, epochSlotCount is the highest slot ever claimed 
+	plus one so scans can stop there */
+EpochSlot * threadEpochSlot()
+{
+	int slot, count;
+	bool expected;
+
+	if (epochSlot != NULL) return epochSlot;
+
+	pthread_once(&epochKeyOnce, createEpochKey);
+	for (slot=0; slot<EBR_MAX_THREADS; slot++)
+	{
+		expected = false;
+		if (!atomic_load_explicit(&(epochSlots[slot].inUse), memory_order_relaxed) &&
+			atomic_compare_exchange_strong(&(epochSlots[slot].inUse), &expected, true)) break;
+	}
+	if (slot == EBR_MAX_THREADS) abort();
+
+	count = atomic_load(&epochSlotCount);
+	while (count <= slot && !atomic_compare_exchange_weak(&epochSlotCount, &count, slot + 1));
+	epochSlot = &(epochSlots[slot]);
+	pthread_setspecific(epochKey, epochSlot);
+	return epochSlot;
+}
+
+/* the epoch moves on once every thread inside an operation has seen it */
+void tryAdvanceEpoch()
+{
+	unsigned long epoch = atomic_load(&globalEpoch), announced;
+	int i, count = atomic_load(&epochSlotCount);
+
+	for (i=0; i<count && i<EBR_MAX_THREADS; i++)
+	{
+		announced = atomic_load(&(epochSlots[i].epoch));
+		if ((announced & 1) && (announced >> 1) != epoch) return;
+	}
+	if (atomic_compare_exchange_strong(&globalEpoch, &epoch, epoch + 1)) freeOrphans(epoch + 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* anything retired two epochs back can't be reached by a thread still inside */
+void epochEnter()
+{
+	EpochSlot *slot = threadEpochSlot();
+	unsigned long epoch = atomic_load(&globalEpoch);
+	int i;
+
+	// the announcement has to land before any node is read
+	atomic_store_explicit(&(slot->epoch), (epoch << 1) | 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	for (i=0; i<3; i++)
+	{
+		if (slot->limbo[i] != NULL && slot->limboEpoch[i] + 2 <= epoch) freeLimbo(slot, i);
+	}
+}
+
+void epochExit()
+{
+	atomic_store_explicit(&(threadEpochSlot()->epoch), 0, memory_order_release);
+}
+
+/* only between epochEnter and epochExit, after node has been unlinked. it is 
+	tagged with the global epoch (may be one past ours): readers that could 
+	have reached it announced no later than that */
+void epochRetire(ConcurrentNode *node)
+{
+	EpochSlot *slot = threadEpochSlot();
+	unsigned long epoch = atomic_load(&globalEpoch);
+	int i = epoch % 3;
+
+	// a list left over from epoch - 3 or earlier is already safe to free
+	if (slot->limboEpoch[i] != epoch)
+	{
+		freeLimbo(slot, i);
+		slot->limboEpoch[i] = epoch;
+	}
+	node->retired = slot->limbo[i];
+	slot->limbo[i] = node;
+
+	if (++(slot->retiredCount) % EBR_RETIRE_BATCH == 0) tryAdvanceEpoch();
+}
+
+long epochPendingNodes()
+{
+	ConcurrentNode *node;
+	long pending = 0;
+	int s, i, count = atomic_load(&epochSlotCount);
+
+	for (s=0; s<count && s<EBR_MAX_THREADS; s++)
+	{
+		for (i=0; i<3; i++)
+		{
+			for (node=epochSlots[s].limbo[i]; node!=NULL; node=node->retired) pending++;
+		}
+	}
+	lockOrphans();
+	for (i=0; i<3; i++)
+	{
+		for (node=orphanLimbo[i]; node!=NULL; node=node->retired) pending++;
+	}
+	unlockOrphans();
+	return pending;
+}
+
+
+
+/******************************************************************************* 
+------------------------------- PRIMARY EXPORTS --------------------------------
+*******************************************************************************/
+void initConcurrentTree(ConcurrentTree *tree)
+{
+	tree->root = newConcurrentNode(INT_MAX, NULL);
+}
+
+/* also frees every thread's limbo lists and the orphans, whichever tree their 
+	nodes came from */
+void destroyConcurrentTree(ConcurrentTree *tree)
+{
+	int s, i, count = atomic_load(&epochSlotCount);
+
+	freeConcurrentNodes(tree->root);
+	tree->root = NULL;
+	for (s=0; s<count && s<EBR_MAX_THREADS; s++)
+	{
+		for (i=0; i<3; i++) freeLimbo(&(epochSlots[s]), i);
+	}
+	lockOrphans();
+	for (i=0; i<3; i++)
+	{
+		freeRetired(orphanLimbo[i]);
+		orphanLimbo[i] = NULL;
+	}
+	unlockOrphans();
+}
+
+int countConcurrentNodes(ConcurrentNode *node)
+{
+	if (node == NULL) return 0;
+	return !isDeleted(node)
+		+ countConcurrentNodes(atomic_load(&(node->left)))
+		+ countConcurrentNodes(atomic_load(&(node->right)));
+}
+
+int concurrentTreeCount(ConcurrentTree *tree)
+{
+	return countConcurrentNodes(atomic_load(&(tree->root->left)));
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* unlinking only ever moves a subtree up into its parent's slot, so a reader
+	standing on a removed node still finds its way down to the right place */
+bool concurrentFind(ConcurrentTree *tree, int id)
+{
+	ConcurrentNode *curr;
+	bool found = false;
+
+	epochEnter();
+	curr = atomic_load_explicit(&(tree->root->left), memory_order_acquire);
+	while (curr != NULL)
+	{
+		if (id == curr->id)
+		{
+			found = !isDeleted(curr);
+			break;
+		}
+		curr = atomic_load_explicit((id < curr->id) ? &(curr->left) : &(curr->right), memory_order_acquire);
+	}
+	epochExit();
+
+	return found;
+}
+
+/* a new node goes into an empty slot of a live parent, an existing deleted
+	node is brought back in place. either way the node is locked and rechecked
+	first, and the search starts over if it was removed in the meantime */
+bool concurrentInsert(ConcurrentTree *tree, int id, void *data)
+{
+	ConcurrentNode *curr, *next;
+	_Atomic(ConcurrentNode *) *link;
+	int result = -1;
+
+	epochEnter();
+	while (result < 0)
+	{
+		curr = tree->root;
+		while (true)
+		{
+			link = (id < curr->id) ? &(curr->left) : &(curr->right);
+			next = atomic_load_explicit(link, memory_order_acquire);
+			if (next == NULL || next->id == id) break;
+			curr = next;
+		}
+
+		if (next != NULL)
+		{
+			lockConcurrentNode(next);
+			if (!isRemoved(next))
+			{
+				result = isDeleted(next);
+				if (result)
+				{
+					next->data = data;
+					atomic_store_explicit(&(next->deleted), false, memory_order_release);
+				}
+			}
+			unlockConcurrentNode(next);
+		}
+		else
+		{
+			lockConcurrentNode(curr);
+			if (!isRemoved(curr) && atomic_load_explicit(link, memory_order_relaxed) == NULL)
+			{
+				atomic_store_explicit(link, newConcurrentNode(id, data), memory_order_release);
+				result = 1;
+			}
+			unlockConcurrentNode(curr);
+		}
+	}
+	epochExit();
+
+	return result;
+}
+
+/* node and the slot pointing at it, searching from the sentinel */
+ConcurrentNode * searchConcurrentNode(
+	ConcurrentTree *tree, int id,
+	ConcurrentNode **parent, _Atomic(ConcurrentNode *) **link
+)
+{
+	ConcurrentNode *curr;
+	*parent = tree->root;
+	*link = &(tree->root->left);
+	curr = atomic_load_explicit(*link, memory_order_acquire);
+	while (curr != NULL && curr->id != id)
+	{
+		*parent = curr;
+		*link = (id < curr->id) ? &(curr->left) : &(curr->right);
+		curr = atomic_load_explicit(*link, memory_order_acquire);
+	}
+	return curr;
+}
+
+/* locks parent then node (always top-down). 1 if node was unlinked, 0 if it 
+	doesn't need to be (already removed, back in the tree, or a routing node 
+	with two children) and -1 if parent/link went stale and the caller has to 
+	search again */
+int unlinkConcurrentNode(
+	ConcurrentNode *parent, _Atomic(ConcurrentNode *) *link, ConcurrentNode *node
+)
+{
+	ConcurrentNode *left, *right;
+	int result = 0;
+
+	lockConcurrentNode(parent);
+	lockConcurrentNode(node);
+	left = atomic_load_explicit(&(node->left), memory_order_relaxed);
+	right = atomic_load_explicit(&(node->right), memory_order_relaxed);
+	if (!isRemoved(node) && isDeleted(node) && (left == NULL || right == NULL))
+	{
+		if (isRemoved(parent) || atomic_load_explicit(link, memory_order_relaxed) != node)
+		{
+			result = -1;
+		}
+		else
+		{
+			atomic_store_explicit(link, (left != NULL) ? left : right, memory_order_release);
+			atomic_store_explicit(&(node->removed), true, memory_order_release);
+			result = 1;
+		}
+	}
+	unlockConcurrentNode(node);
+	unlockConcurrentNode(parent);
+
+	if (result == 1) epochRetire(node);
+	return result;
+}
+
+/* unlinks a deleted node, then walks up while that leaves a deleted parent 
+	(routing node) with one child. a stale parent means a fresh search, and if 
+	the search no longer finds the node someone else has removed it */
+void removeConcurrentNode(
+	ConcurrentTree *tree, ConcurrentNode *parent,
+	_Atomic(ConcurrentNode *) *link, ConcurrentNode *node
+)
+{
+	int result;
+	while (true)
+	{
+		result = unlinkConcurrentNode(parent, link, node);
+		if (result == 0) return;
+		if (result == 1)
+		{
+			if (parent == tree->root || !isDeleted(parent)) return;
+			node = parent;
+		}
+		if (searchConcurrentNode(tree, node->id, &parent, &link) != node) return;
+	}
+}
+
+bool concurrentDelete(ConcurrentTree *tree, int id)
+{
+	ConcurrentNode *parent, *curr;
+	_Atomic(ConcurrentNode *) *link;
+	int result = -1;
+
+	epochEnter();
+	while (result < 0)
+	{
+		curr = searchConcurrentNode(tree, id, &parent, &link);
+		if (curr == NULL)
+		{
+			result = 0;
+			break;
+		}
+
+		lockConcurrentNode(curr);
+		if (!isRemoved(curr))
+		{
+			result = !isDeleted(curr);
+			atomic_store_explicit(&(curr->deleted), true, memory_order_release);
+		}
+		unlockConcurrentNode(curr);
+		if (result == 1) removeConcurrentNode(tree, parent, link, curr);
+	}
+	epochExit();
+
+	return result;
+}
+
+/* -------------------------------------------------------------------------- */
+
+
+
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
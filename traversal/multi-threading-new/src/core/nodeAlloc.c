@@ -0,0 +1,217 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file nodeAlloc.c
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Slab-backed node allocators: bump arena, recycling pool and a
+ *  shuffled mode whose placement is randomized to a chosen degree.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "types.h"
+#include "nodeAlloc.h"
+#include "util.h"
+
+/* allocator behind allocNode/freeNode, NULL falls back to malloc */
+static NodeAllocator *nodeAllocator = NULL;
+
+
+
+/******************************************************************************* 
+------------------------------- HELPER FUNCTIONS -------------------------------
+*******************************************************************************/
+/* partial Fisher-Yates: slot i swaps with a random later slot with 
+	probability degree, so 0 keeps allocation order and 1 is a full shuffle */
+void shuffleSlabOrder(int *order, int n, double degree)
+{
+	int i, j, tmp;
+	for (i=0; i<n; i++) order[i] = i;
+	for (i=0; i<n-1; i++)
+	{
+		if (genrand64_real2() >= degree) continue;
+		j = i + (int) (genrand64_real2() * (n - i));
+		tmp = order[i];
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+}
+
+NodeSlab * pushSlab(NodeAllocator *allocator)
+{
+	NodeSlab *slab = (NodeSlab *) malloc(sizeof(NodeSlab));
+	slab->used		= 0;
+	slab->capacity	= allocator->slabNodes;
+	slab->nodes		= (Tree *) malloc(slab->capacity * sizeof(Tree));
+	slab->order		= NULL;
+	slab->next		= allocator->slabs;
+	if (allocator->mode == ALLOC_SHUFFLED)
+	{
+		slab->order = (int *) malloc(slab->capacity * sizeof(int));
+		shuffleSlabOrder(slab->order, slab->capacity, allocator->shuffleDegree);
+	}
+	allocator->slabs = slab;
+	return slab;
+}
+
+void freeSlab(NodeSlab *slab)
+{
+	free(slab->nodes);
+	free(slab->order);
+	free(slab);
+}
+
+
+
+/******************************************************************************* 
+------------------------------- PRIMARY EXPORTS --------------------------------
+*******************************************************************************/
+void initNodeAllocator(NodeAllocator *allocator, NodeAllocMode mode, int slabNodes, double shuffleDegree)
+{
+	allocator->mode				= mode;
+	allocator->slabNodes		= (slabNodes > 0) ? slabNodes : NODE_SLAB_SIZE;
+	allocator->shuffleDegree	= shuffleDegree;
+	allocator->slabs			= NULL;
+	allocator->freeList			= NULL;
+}
+
+void destroyNodeAllocator(NodeAllocator *allocator)
+{
+	NodeSlab *slab, *next;
+	for (slab=allocator->slabs; slab!=NULL; slab=next)
+	{
+		next = slab->next;
+		freeSlab(slab);
+	}
+	allocator->slabs = NULL;
+	allocator->freeList = NULL;
+	if (nodeAllocator == allocator) nodeAllocator = NULL;
+}
+
+/* drops every node at once: all slabs but the oldest are released and the 
+	oldest is rewound (a shuffled slab keeps its order) */
+void resetNodeAllocator(NodeAllocator *allocator)
+{
+	NodeSlab *slab = allocator->slabs, *next;
+	if (slab == NULL) return;
+	while (slab->next != NULL)
+	{
+		next = slab->next;
+		freeSlab(slab);
+		slab = next;
+	}
+	slab->used = 0;
+	allocator->slabs = slab;
+	allocator->freeList = NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+Tree * allocTreeNode(NodeAllocator *allocator)
+{
+	NodeSlab *slab;
+	Tree *node;
+	int i;
+
+	if (allocator == NULL || allocator->mode == ALLOC_MALLOC)
+	{
+		return (Tree *) malloc(sizeof(Tree));
+	}
+
+	if (allocator->freeList != NULL)
+	{
+		node = allocator->freeList;
+		allocator->freeList = node->left;
+		return node;
+	}
+
+	slab = allocator->slabs;
+	if (slab == NULL || slab->used == slab->capacity) slab = pushSlab(allocator);
+	i = (slab->used)++;
+	return slab->nodes + ((slab->order != NULL) ? slab->order[i] : i);
+}
+
+/* arena and shuffled nodes are only released by resetNodeAllocator */
+void freeTreeNode(NodeAllocator *allocator, Tree *node)
+{
+	if (allocator == NULL || allocator->mode == ALLOC_MALLOC)
+	{
+		free(node);
+	}
+	else if (allocator->mode == ALLOC_POOL)
+	{
+		node->left = allocator->freeList;
+		allocator->freeList = node;
+	}
+}
+
+bool nodeAllocatorFrees(NodeAllocator *allocator)
+{
+	return allocator == NULL || allocator->mode == ALLOC_MALLOC 
+		|| allocator->mode == ALLOC_POOL;
+}
+
+/* bytes reserved in slabs, 0 for malloc */
+long nodeAllocatorBytes(NodeAllocator *allocator)
+{
+	NodeSlab *slab;
+	long bytes = 0;
+	if (allocator == NULL) return 0;
+	for (slab=allocator->slabs; slab!=NULL; slab=slab->next)
+	{
+		bytes += (long) slab->capacity * sizeof(Tree);
+	}
+	return bytes;
+}
+
+const char * nodeAllocModeName(NodeAllocMode mode)
+{
+	switch (mode)
+	{
+		case ALLOC_ARENA:		return "arena";
+		case ALLOC_POOL:		return "pool";
+		case ALLOC_SHUFFLED:	return "shuffled";
+		default:				return "malloc";
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+void setNodeAllocator(NodeAllocator *allocator)
+{
+	nodeAllocator = allocator;
+}
+
+NodeAllocator * getNodeAllocator()
+{
+	return nodeAllocator;
+}
+
+Tree * allocNode()
+{
+	return allocTreeNode(nodeAllocator);
+}
+
+void freeNode(Tree *node)
+{
+	freeTreeNode(nodeAllocator, node);
+}
+
+/* -------------------------------------------------------------------------- */
+
+
+
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
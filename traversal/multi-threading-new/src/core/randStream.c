@@ -0,0 +1,98 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file randStream.c
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief SplitMix64 streams with an explicit state, plus the thread-local
+ *  lookup that hands callbacks the stream of the thread running them.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "types.h"
+#include "randStream.h"
+
+/* set by the thread pool while a thread works for it */
+static _Thread_local RandStream *currentStream = NULL;
+static _Thread_local RandStream fallbackStream;
+static atomic_ullong fallbackStreams = 0;
+
+
+
+/******************************************************************************* 
+------------------------------- HELPER FUNCTIONS -------------------------------
+*******************************************************************************/
+uint64_t mix64(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+
+
+/******************************************************************************* 
+------------------------------- PRIMARY EXPORTS --------------------------------
+*******************************************************************************/
+/* the start is a hash of (seed, id), so streams begin at unrelated points of 
+	the 2^64 cycle and won't overlap for any practical run length */
+void initRandStream(RandStream *stream, uint64_t seed, uint64_t streamID)
+{
+	stream->state = mix64(seed ^ mix64(streamID + SPLITMIX_GAMMA));
+}
+
+uint64_t randStreamNext(RandStream *stream)
+{
+	return mix64(stream->state += SPLITMIX_GAMMA);
+}
+
+double randStreamReal(RandStream *stream)
+{
+	return (randStreamNext(stream) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* uniform integer in [0, m) by multiply-shift, the bias is below m / 2^64 */
+uint64_t randStreamBelow(RandStream *stream, uint64_t m)
+{
+	return (uint64_t) (((unsigned __int128) randStreamNext(stream) * m) >> 64);
+}
+
+/* -------------------------------------------------------------------------- */
+
+RandStream * threadRandStream()
+{
+	if (currentStream == NULL)
+	{
+		initRandStream(&fallbackStream, RAND_STREAM_SEED, 
+			RAND_FALLBACK_STREAM + atomic_fetch_add(&fallbackStreams, 1));
+		currentStream = &fallbackStream;
+	}
+	return currentStream;
+}
+
+/* returns the previous stream (NULL if none was set) so it can be restored */
+RandStream * swapThreadRandStream(RandStream *stream)
+{
+	RandStream *previous = currentStream;
+	currentStream = stream;
+	return previous;
+}
+
+/* -------------------------------------------------------------------------- */
+
+
+
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
@@ -0,0 +1,274 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file searchArray.c
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Eytzinger and B-tree layouts of a BST's sorted keys, searched without
+ *  pointer chasing (branchless descent, SSE2/AVX2 node compares).
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "types.h"
+#include "searchArray.h"
+
+/* same runtime dispatch as soaTree.c, emcc builds fall back to scalar */
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SEARCH_X86
+#define SEARCH_AVX2 __attribute__((target("avx2")))
+#endif
+
+
+
+/******************************************************************************* 
+------------------------------- HELPER FUNCTIONS -------------------------------
+*******************************************************************************/
+void * searchAlloc(int N, size_t size)
+{
+	size_t bytes = ((N * size + SEARCH_ALIGN - 1) / SEARCH_ALIGN) * SEARCH_ALIGN;
+	return aligned_alloc(SEARCH_ALIGN, bytes > 0 ? bytes : SEARCH_ALIGN);
+}
+
+int countSearchNodes(Tree *t)
+{
+	return (t == NULL) ? 0 : 1 + countSearchNodes(t->left) + countSearchNodes(t->right);
+}
+
+void collectInOrder(Tree *t, Tree **sorted, int *n)
+{
+	if (t == NULL) return;
+	collectInOrder(t->left, sorted, n);
+	sorted[(*n)++] = t;
+	collectInOrder(t->right, sorted, n);
+}
+
+/* BST nodes in key order, caller frees */
+Tree ** sortedSearchNodes(Tree *bst, int *N)
+{
+	Tree **sorted;
+	int n = 0;
+
+	*N = countSearchNodes(bst);
+	sorted = (Tree **) malloc((*N > 0 ? *N : 1) * sizeof(Tree *));
+	collectInOrder(bst, sorted, &n);
+	return sorted;
+}
+
+/* an in-order walk of the implicit tree hands out the sorted keys */
+void fillEytzinger(SearchArray *searchArray, Tree **sorted, int *i, int k)
+{
+	if (k > searchArray->N) return;
+	fillEytzinger(searchArray, sorted, i, 2*k);
+	searchArray->key[k] = sorted[*i]->id;
+	searchArray->node[k] = sorted[(*i)++];
+	fillEytzinger(searchArray, sorted, i, 2*k + 1);
+}
+
+int searchBTreeChild(int block, int i)
+{
+	return block * (SEARCH_BTREE_B + 1) + i + 1;
+}
+
+void fillSearchBTree(SearchArray *searchArray, Tree **sorted, int *i, int block)
+{
+	int j, slot;
+	if (block >= searchArray->blocks) return;
+	for (j=0; j<SEARCH_BTREE_B; j++)
+	{
+		fillSearchBTree(searchArray, sorted, i, searchBTreeChild(block, j));
+		slot = block * SEARCH_BTREE_B + j;
+		if (*i < searchArray->N)
+		{
+			searchArray->key[slot] = sorted[*i]->id;
+			searchArray->node[slot] = sorted[(*i)++];
+		}
+		else
+		{
+			searchArray->key[slot] = INT_MAX;
+			searchArray->node[slot] = NULL;
+		}
+	}
+	fillSearchBTree(searchArray, sorted, i, searchBTreeChild(block, SEARCH_BTREE_B));
+}
+
+bool searchHasAVX2()
+{
+#ifdef SEARCH_X86
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+
+
+/******************************************************************************* 
+-------------------------------- B-TREE SEARCH ---------------------------------
+*******************************************************************************/
+/* each version returns the slot of the first key >= id (or -1) and counts the
+	keys < id in a node to pick the child */
+int searchBTreeSlotScalar(int id, SearchArray *searchArray)
+{
+	int block = 0, slot = -1, i, *key;
+	while (block < searchArray->blocks)
+	{
+		key = searchArray->key + block * SEARCH_BTREE_B;
+		for (i=0; i<SEARCH_BTREE_B && key[i] < id; i++);
+		if (i < SEARCH_BTREE_B) slot = block * SEARCH_BTREE_B + i;
+		block = searchBTreeChild(block, i);
+	}
+	return slot;
+}
+
+#ifdef SEARCH_X86
+
+int searchBTreeSlotSSE2(int id, SearchArray *searchArray)
+{
+	int block = 0, slot = -1, i, *key;
+	__m128i x = _mm_set1_epi32(id), lo, hi;
+	while (block < searchArray->blocks)
+	{
+		key = searchArray->key + block * SEARCH_BTREE_B;
+		lo = _mm_packs_epi32(
+			_mm_cmpgt_epi32(x, _mm_load_si128((__m128i *) key)),
+			_mm_cmpgt_epi32(x, _mm_load_si128((__m128i *) (key + 4)))
+		);
+		hi = _mm_packs_epi32(
+			_mm_cmpgt_epi32(x, _mm_load_si128((__m128i *) (key + 8))),
+			_mm_cmpgt_epi32(x, _mm_load_si128((__m128i *) (key + 12)))
+		);
+		i = __builtin_popcount(_mm_movemask_epi8(_mm_packs_epi16(lo, hi)));
+		if (i < SEARCH_BTREE_B) slot = block * SEARCH_BTREE_B + i;
+		block = searchBTreeChild(block, i);
+	}
+	return slot;
+}
+
+/* the 16-bit packs interleave the two 128-bit lanes, fine since only the
+	number of set bits matters */
+SEARCH_AVX2 int searchBTreeSlotAVX2(int id, SearchArray *searchArray)
+{
+	int block = 0, slot = -1, i, *key;
+	__m256i x = _mm256_set1_epi32(id), packed;
+	while (block < searchArray->blocks)
+	{
+		key = searchArray->key + block * SEARCH_BTREE_B;
+		packed = _mm256_packs_epi32(
+			_mm256_cmpgt_epi32(x, _mm256_load_si256((__m256i *) key)),
+			_mm256_cmpgt_epi32(x, _mm256_load_si256((__m256i *) (key + 8)))
+		);
+		i = __builtin_popcount(_mm256_movemask_epi8(packed)) >> 1;
+		if (i < SEARCH_BTREE_B) slot = block * SEARCH_BTREE_B + i;
+		block = searchBTreeChild(block, i);
+	}
+	return slot;
+}
+
+#endif
+
+
+
+/******************************************************************************* 
+------------------------------- PRIMARY EXPORTS --------------------------------
+*******************************************************************************/
+void initEytzinger(SearchArray *searchArray, Tree *bst)
+{
+	Tree **sorted = sortedSearchNodes(bst, &searchArray->N);
+	int i = 0;
+
+	searchArray->blocks = 0;
+	searchArray->key = (int *) searchAlloc(searchArray->N + 1, sizeof(int));
+	searchArray->node = (Tree **) malloc((searchArray->N + 1) * sizeof(Tree *));
+	searchArray->key[0] = INT_MAX;
+	searchArray->node[0] = NULL;
+	fillEytzinger(searchArray, sorted, &i, 1);
+	free(sorted);
+}
+
+void initSearchBTree(SearchArray *searchArray, Tree *bst)
+{
+	Tree **sorted = sortedSearchNodes(bst, &searchArray->N);
+	int i = 0;
+
+	searchArray->blocks = (searchArray->N + SEARCH_BTREE_B - 1) / SEARCH_BTREE_B;
+	searchArray->key = (int *) searchAlloc(searchArray->blocks * SEARCH_BTREE_B, sizeof(int));
+	searchArray->node = (Tree **) malloc((searchArray->blocks * SEARCH_BTREE_B + 1) * sizeof(Tree *));
+	fillSearchBTree(searchArray, sorted, &i, 0);
+	free(sorted);
+}
+
+void freeSearchArray(SearchArray *searchArray)
+{
+	free(searchArray->key);
+	free(searchArray->node);
+	searchArray->key = NULL;
+	searchArray->node = NULL;
+	searchArray->N = 0;
+	searchArray->blocks = 0;
+}
+
+const char * searchStructureName(SearchStructure structure)
+{
+	switch (structure)
+	{
+		case SEARCH_EYTZINGER:	return "eytzinger";
+		case SEARCH_BTREE:		return "btree";
+		default:				return "bst";
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* k goes left/right without a branch, the trailing right turns are undone at
+	the end (k becomes the last left turn, 0 if id is past every key) */
+Tree * findEytzinger(int id, SearchArray *searchArray)
+{
+	int k = 1, *key = searchArray->key;
+	while (k <= searchArray->N)
+	{
+		__builtin_prefetch(key + (size_t) k * SEARCH_EYTZINGER_PREFETCH);
+		k = 2*k + (key[k] < id);
+	}
+	k >>= __builtin_ffs(~k);
+	return (k != 0 && key[k] == id) ? searchArray->node[k] : NULL;
+}
+
+Tree * findSearchBTree(int id, SearchArray *searchArray)
+{
+	int slot;
+#ifdef SEARCH_X86
+	if (searchHasAVX2()) slot = searchBTreeSlotAVX2(id, searchArray);
+	else slot = searchBTreeSlotSSE2(id, searchArray);
+#else
+	slot = searchBTreeSlotScalar(id, searchArray);
+#endif
+	return (slot >= 0 && searchArray->key[slot] == id) ? searchArray->node[slot] : NULL;
+}
+
+Tree * findSearchBTreeScalar(int id, SearchArray *searchArray)
+{
+	int slot = searchBTreeSlotScalar(id, searchArray);
+	return (slot >= 0 && searchArray->key[slot] == id) ? searchArray->node[slot] : NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+
+
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
@@ -0,0 +1,353 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file soaTree.c
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Structure-of-arrays trees and SSE2/AVX2 bulk kernels that stream
+ *  their columns instead of calling back per node.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "types.h"
+#include "randStream.h"
+#include "soaTree.h"
+
+/* avx2 paths are compiled per function and picked at runtime, so the default
+	build flags stay portable (emcc builds fall back to scalar) */
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SOA_X86
+#define SOA_AVX2 __attribute__((target("avx2")))
+#endif
+
+/* same key searchKey looks for */
+static int soaSampleKey = 849037849;
+
+
+
+/******************************************************************************* 
+------------------------------- HELPER FUNCTIONS -------------------------------
+*******************************************************************************/
+void * soaAlloc(int N, size_t size)
+{
+	size_t bytes = ((N * size + SOA_ALIGN - 1) / SOA_ALIGN) * SOA_ALIGN;
+	return aligned_alloc(SOA_ALIGN, bytes > 0 ? bytes : SOA_ALIGN);
+}
+
+bool soaHasAVX2()
+{
+#ifdef SOA_X86
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+
+
+/******************************************************************************* 
+--------------------------------- SIMD KERNELS ---------------------------------
+*******************************************************************************/
+#ifdef SOA_X86
+
+SOA_AVX2 void soaIncrementIDAVX2(SoATree *soaTree)
+{
+	int i, *id = soaTree->id;
+	__m256i one = _mm256_set1_epi32(1);
+	for (i=0; i+8<=soaTree->N; i+=8)
+	{
+		__m256i v = _mm256_load_si256((__m256i *) (id + i));
+		_mm256_store_si256((__m256i *) (id + i), _mm256_add_epi32(v, one));
+	}
+	for (; i<soaTree->N; i++) id[i]++;
+}
+
+void soaIncrementIDSSE2(SoATree *soaTree)
+{
+	int i, *id = soaTree->id;
+	__m128i one = _mm_set1_epi32(1);
+	for (i=0; i+4<=soaTree->N; i+=4)
+	{
+		__m128i v = _mm_load_si128((__m128i *) (id + i));
+		_mm_store_si128((__m128i *) (id + i), _mm_add_epi32(v, one));
+	}
+	for (; i<soaTree->N; i++) id[i]++;
+}
+
+SOA_AVX2 int soaCountKeyAVX2(SoATree *soaTree, int key)
+{
+	int i, count = 0, *id = soaTree->id;
+	__m256i k = _mm256_set1_epi32(key);
+	for (i=0; i+8<=soaTree->N; i+=8)
+	{
+		__m256i eq = _mm256_cmpeq_epi32(_mm256_load_si256((__m256i *) (id + i)), k);
+		count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+	}
+	for (; i<soaTree->N; i++) count += id[i] == key;
+	return count;
+}
+
+int soaCountKeySSE2(SoATree *soaTree, int key)
+{
+	int i, count = 0, *id = soaTree->id;
+	__m128i k = _mm_set1_epi32(key);
+	for (i=0; i+4<=soaTree->N; i+=4)
+	{
+		__m128i eq = _mm_cmpeq_epi32(_mm_load_si128((__m128i *) (id + i)), k);
+		count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+	}
+	for (; i<soaTree->N; i++) count += id[i] == key;
+	return count;
+}
+
+/* splitmix is a counter, draw k of the stream is mix64(state + k*gamma), so 
+	lane j can run node i+j's SOA_RAND_ROUNDS draws on its own and the ids and 
+	final stream state come out exactly as soaRandArrayScalar's. avx2 has no 
+	64 bit multiply, it is put together from 32 bit ones */
+SOA_AVX2 __m256i soaMul64AVX2(__m256i a, uint64_t b)
+{
+	__m256i lo = _mm256_set1_epi64x(b & 0xFFFFFFFFULL), hi = _mm256_set1_epi64x(b >> 32);
+	__m256i cross = _mm256_add_epi64(
+		_mm256_mul_epu32(_mm256_srli_epi64(a, 32), lo), _mm256_mul_epu32(a, hi)
+	);
+	return _mm256_add_epi64(_mm256_mul_epu32(a, lo), _mm256_slli_epi64(cross, 32));
+}
+
+SOA_AVX2 __m256i soaMix64AVX2(__m256i z)
+{
+	z = soaMul64AVX2(_mm256_xor_si256(z, _mm256_srli_epi64(z, 30)), 0xBF58476D1CE4E5B9ULL);
+	z = soaMul64AVX2(_mm256_xor_si256(z, _mm256_srli_epi64(z, 27)), 0x94D049BB133111EBULL);
+	return _mm256_xor_si256(z, _mm256_srli_epi64(z, 31));
+}
+
+/* (z >> 11) * 2^-53 as randStreamReal, the 53 bits are converted in two 
+	halves through the 2^52 exponent trick */
+SOA_AVX2 __m256d soaReal64AVX2(__m256i z)
+{
+	__m256i v = _mm256_srli_epi64(z, 11), exp52 = _mm256_set1_epi64x(0x4330000000000000LL);
+	__m256d two52 = _mm256_castsi256_pd(exp52);
+	__m256d lo = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(
+		_mm256_and_si256(v, _mm256_set1_epi64x((1LL << 26) - 1)), exp52)), two52);
+	__m256d hi = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(
+		_mm256_srli_epi64(v, 26), exp52)), two52);
+	return _mm256_mul_pd(
+		_mm256_add_pd(_mm256_mul_pd(hi, _mm256_set1_pd(67108864.0)), lo), 
+		_mm256_set1_pd(1.0 / 9007199254740992.0)
+	);
+}
+
+SOA_AVX2 void soaRandArrayAVX2(SoATree *soaTree)
+{
+	RandStream *rng = threadRandStream();
+	uint64_t gamma = SPLITMIX_GAMMA, start = rng->state;
+	int i, r, *id = soaTree->id;
+	double x = 0;
+	__m256d real = _mm256_setzero_pd();
+	__m256i step = _mm256_set1_epi64x(gamma);
+	__m256i skip = _mm256_set1_epi64x(gamma * 3 * SOA_RAND_ROUNDS);
+	__m256i s = _mm256_set_epi64x(
+		start + gamma * 3 * SOA_RAND_ROUNDS, start + gamma * 2 * SOA_RAND_ROUNDS, 
+		start + gamma * SOA_RAND_ROUNDS, start
+	);
+	for (i=0; i+4<=soaTree->N; i+=4)
+	{
+		for (r=0; r<SOA_RAND_ROUNDS; r++)
+		{
+			s = _mm256_add_epi64(s, step);
+			real = soaReal64AVX2(soaMix64AVX2(s));
+		}
+		_mm_store_si128((__m128i *) (id + i), _mm256_cvttpd_epi32(real));
+		s = _mm256_add_epi64(s, skip);
+	}
+
+	rng->state = start + gamma * SOA_RAND_ROUNDS * (uint64_t) i;
+	for (; i<soaTree->N; i++)
+	{
+		for (r=0; r<SOA_RAND_ROUNDS; r++) x = randStreamReal(rng);
+		id[i] = (int) x;
+	}
+}
+
+__m128i soaMul64SSE2(__m128i a, uint64_t b)
+{
+	__m128i lo = _mm_set1_epi64x(b & 0xFFFFFFFFULL), hi = _mm_set1_epi64x(b >> 32);
+	__m128i cross = _mm_add_epi64(
+		_mm_mul_epu32(_mm_srli_epi64(a, 32), lo), _mm_mul_epu32(a, hi)
+	);
+	return _mm_add_epi64(_mm_mul_epu32(a, lo), _mm_slli_epi64(cross, 32));
+}
+
+__m128i soaMix64SSE2(__m128i z)
+{
+	z = soaMul64SSE2(_mm_xor_si128(z, _mm_srli_epi64(z, 30)), 0xBF58476D1CE4E5B9ULL);
+	z = soaMul64SSE2(_mm_xor_si128(z, _mm_srli_epi64(z, 27)), 0x94D049BB133111EBULL);
+	return _mm_xor_si128(z, _mm_srli_epi64(z, 31));
+}
+
+__m128d soaReal64SSE2(__m128i z)
+{
+	__m128i v = _mm_srli_epi64(z, 11), exp52 = _mm_set1_epi64x(0x4330000000000000LL);
+	__m128d two52 = _mm_castsi128_pd(exp52);
+	__m128d lo = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(
+		_mm_and_si128(v, _mm_set1_epi64x((1LL << 26) - 1)), exp52)), two52);
+	__m128d hi = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(
+		_mm_srli_epi64(v, 26), exp52)), two52);
+	return _mm_mul_pd(
+		_mm_add_pd(_mm_mul_pd(hi, _mm_set1_pd(67108864.0)), lo), 
+		_mm_set1_pd(1.0 / 9007199254740992.0)
+	);
+}
+
+void soaRandArraySSE2(SoATree *soaTree)
+{
+	RandStream *rng = threadRandStream();
+	uint64_t gamma = SPLITMIX_GAMMA, start = rng->state;
+	int i, r, *id = soaTree->id;
+	double x = 0;
+	__m128d real = _mm_setzero_pd();
+	__m128i step = _mm_set1_epi64x(gamma);
+	__m128i skip = _mm_set1_epi64x(gamma * SOA_RAND_ROUNDS);
+	__m128i s = _mm_set_epi64x(start + gamma * SOA_RAND_ROUNDS, start);
+	for (i=0; i+2<=soaTree->N; i+=2)
+	{
+		for (r=0; r<SOA_RAND_ROUNDS; r++)
+		{
+			s = _mm_add_epi64(s, step);
+			real = soaReal64SSE2(soaMix64SSE2(s));
+		}
+		_mm_storel_epi64((__m128i *) (id + i), _mm_cvttpd_epi32(real));
+		s = _mm_add_epi64(s, skip);
+	}
+
+	rng->state = start + gamma * SOA_RAND_ROUNDS * (uint64_t) i;
+	for (; i<soaTree->N; i++)
+	{
+		for (r=0; r<SOA_RAND_ROUNDS; r++) x = randStreamReal(rng);
+		id[i] = (int) x;
+	}
+}
+
+#endif
+
+
+
+/******************************************************************************* 
+-------------------------------- SCALAR KERNELS --------------------------------
+*******************************************************************************/
+void soaIncrementIDScalar(SoATree *soaTree)
+{
+	int i;
+	for (i=0; i<soaTree->N; i++) soaTree->id[i]++;
+}
+
+int soaCountKeyScalar(SoATree *soaTree, int key)
+{
+	int i, count = 0;
+	for (i=0; i<soaTree->N; i++) count += soaTree->id[i] == key;
+	return count;
+}
+
+/* randArray on every node in index order: SOA_RAND_ROUNDS doubles from the 
+	calling thread's stream, the last one truncated becomes the id */
+void soaRandArrayScalar(SoATree *soaTree)
+{
+	RandStream *rng = threadRandStream();
+	int i, r;
+	double x = 0;
+	for (i=0; i<soaTree->N; i++)
+	{
+		for (r=0; r<SOA_RAND_ROUNDS; r++) x = randStreamReal(rng);
+		soaTree->id[i] = (int) x;
+	}
+}
+
+
+
+/******************************************************************************* 
+------------------------------- PRIMARY EXPORTS --------------------------------
+*******************************************************************************/
+void initSoATree(SoATree *soaTree, int N)
+{
+	soaTree->N		= N;
+	soaTree->id		= (int *) soaAlloc(N, sizeof(int));
+	soaTree->left	= (uint32_t *) soaAlloc(N, sizeof(uint32_t));
+	soaTree->right	= (uint32_t *) soaAlloc(N, sizeof(uint32_t));
+	soaTree->data	= (void **) soaAlloc(N, sizeof(void *));
+}
+
+void freeSoATree(SoATree *soaTree)
+{
+	free(soaTree->id);
+	free(soaTree->left);
+	free(soaTree->right);
+	free(soaTree->data);
+	soaTree->N = 0;
+}
+
+const char * soaSimdName()
+{
+#ifdef SOA_X86
+	return soaHasAVX2() ? "avx2" : "sse2";
+#else
+	return "scalar";
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+void soaIncrementID(SoATree *soaTree)
+{
+#ifdef SOA_X86
+	if (soaHasAVX2()) soaIncrementIDAVX2(soaTree);
+	else soaIncrementIDSSE2(soaTree);
+#else
+	soaIncrementIDScalar(soaTree);
+#endif
+}
+
+int soaCountKey(SoATree *soaTree, int key)
+{
+#ifdef SOA_X86
+	if (soaHasAVX2()) return soaCountKeyAVX2(soaTree, key);
+	return soaCountKeySSE2(soaTree, key);
+#else
+	return soaCountKeyScalar(soaTree, key);
+#endif
+}
+
+/* like searchKey the key moves on once it has been seen */
+void soaSearchKey(SoATree *soaTree)
+{
+	soaSampleKey += soaCountKey(soaTree, soaSampleKey);
+}
+
+void soaRandArray(SoATree *soaTree)
+{
+#ifdef SOA_X86
+	if (soaHasAVX2()) soaRandArrayAVX2(soaTree);
+	else soaRandArraySSE2(soaTree);
+#else
+	soaRandArrayScalar(soaTree);
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+
+
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
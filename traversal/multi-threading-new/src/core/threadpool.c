@@ -18,67 +18,249 @@
 ------------------------------- IMPORTS & PARAMS -------------------------------
 *******************************************************************************/
 #include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "types.h"
+#include "binaryTree.h"
+#include "randStream.h"
+#include "threadpool.h"
 
 
 
 /******************************************************************************* 
 ------------------------------- GLOBAL VARIABLES -------------------------------
 *******************************************************************************/
+/* pool whose traversal the calling thread is running, lets blocking sections 
+    find it without the pool being passed through every callback */
+static _Thread_local ThreadPool *currentPool = NULL;
 
 
 
 /******************************************************************************* 
----------------------------------- TASK QUEUE ----------------------------------
+----------------------------- WORK-STEALING DEQUE ------------------------------
 *******************************************************************************/
+void initDeque(WorkDeque *deque, long capacity)
+{
+    atomic_init(&(deque->top), 0);
+    atomic_init(&(deque->bottom), 0);
+    deque->capacity = capacity;
+    deque->tasks = (_Atomic(void *) *) malloc(capacity * sizeof(_Atomic(void *)));
+}
+
+void destroyDeque(WorkDeque *deque)
+{
+    free(deque->tasks);
+    deque->tasks = NULL;
+}
+
+/* owner only: returns false if deque is full (caller should run work inline) */
+bool pushDeque(WorkDeque *deque, void *work)
+{
+    long b = atomic_load_explicit(&(deque->bottom), memory_order_relaxed);
+    long t = atomic_load_explicit(&(deque->top), memory_order_acquire);
+    if (b - t >= deque->capacity) return false;
+
+    // release publishes the item (and anything it points to) to thieves
+    atomic_store_explicit(&(deque->tasks[b & (deque->capacity-1)]), work, memory_order_relaxed);
+    atomic_store_explicit(&(deque->bottom), b+1, memory_order_release);
+    return true;
+}
+
+/* owner only: returns most recently pushed item or NULL if it was stolen */
+void * popDeque(WorkDeque *deque)
+{
+    long b = atomic_load_explicit(&(deque->bottom), memory_order_relaxed) - 1;
+    atomic_store_explicit(&(deque->bottom), b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&(deque->top), memory_order_relaxed);
+
+    void *work = NULL;
+    if (t <= b)
+    {
+        work = atomic_load_explicit(&(deque->tasks[b & (deque->capacity-1)]), memory_order_relaxed);
+        if (t == b)
+        {
+            // last item, race against thieves for it
+            if (!atomic_compare_exchange_strong_explicit(
+                &(deque->top), &t, t+1, memory_order_seq_cst, memory_order_relaxed))
+            {
+                work = NULL;
+            }
+            atomic_store_explicit(&(deque->bottom), b+1, memory_order_relaxed);
+        }
+    }
+    else
+    {
+        atomic_store_explicit(&(deque->bottom), b+1, memory_order_relaxed);
+    }
+    return work;
+}
+
+/* any thread: returns oldest item or NULL. pendingTasks is incremented
+    before claiming the item so the traversal can't be seen as finished
+    between the owner giving it up and the thief starting it */
+void * stealDeque(WorkDeque *deque, atomic_int *pendingTasks)
+{
+    long t = atomic_load_explicit(&(deque->top), memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&(deque->bottom), memory_order_acquire);
+    if (t >= b) return NULL;
+
+    void *work = atomic_load_explicit(&(deque->tasks[t & (deque->capacity-1)]), memory_order_relaxed);
+    atomic_fetch_add(pendingTasks, 1);
+    if (!atomic_compare_exchange_strong_explicit(
+        &(deque->top), &t, t+1, memory_order_seq_cst, memory_order_relaxed))
+    {
+        atomic_fetch_sub(pendingTasks, 1);
+        return NULL;
+    }
+    return work;
+}
+
+/* owner only: approximate number of subtrees still waiting to be stolen */
+long sizeDeque(WorkDeque *deque)
+{
+    long b = atomic_load_explicit(&(deque->bottom), memory_order_relaxed);
+    long t = atomic_load_explicit(&(deque->top), memory_order_relaxed);
+    return b - t;
+}
+
+
+
+/******************************************************************************* 
+--------------------------------- THREAD POOL ----------------------------------
+*******************************************************************************/
+/* total threads (workers + main) from -t N / --threads N / --threads=N, then 
+    NUM_THREADS_ENV, then the number of online cores. this is the reference 
+    copy, multi-threading-0/1 and tree-transformation carry identical ones */
+int getNumThreads(int argc, char *argv[])
+{
+    const char *value = NULL;
+    int i;
+    for (i=1; i<argc; i++)
+    {
+        if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) && i+1 < argc)
+        {
+            value = argv[i+1];
+        }
+        else if (strncmp(argv[i], "--threads=", 10) == 0)
+        {
+            value = argv[i] + 10;
+        }
+    }
+    if (value == NULL) value = getenv(NUM_THREADS_ENV);
 
+    int count = (value != NULL) ? atoi(value) : 0;
+    if (count <= 0) count = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (count <= 0) count = 1;
+    return count;
+}
 
 void initThread(TraversalThread *thread, int threadID)
 {
     thread->threadID = threadID;
-    pthread_mutex_init(&(thread->mutex), NULL);
-    pthread_cond_init(&(thread->cond), NULL);
     thread->started = false;
-    thread->busy = false;
+    thread->victimSeed = 2654435761u * (threadID + 1);
+    initDeque(&(thread->deque), DEQUE_CAPACITY);
+    thread->freeFrames = NULL;
+    initTreeBatch(&(thread->batch), NULL, NULL);
 
     thread->totalTasks = 0;
+    thread->totalSteals = 0;
     thread->totalCallbacks = 0;
 }
 
 void destroyThread(TraversalThread *thread)
 {
-    pthread_mutex_destroy(&(thread->mutex));
-    pthread_cond_destroy(&(thread->cond));
+    destroyDeque(&(thread->deque));
+
+    // frames migrate to whichever thread completed them, so each list is freed here
+    PostOrderFrame *frame;
+    while (thread->freeFrames != NULL)
+    {
+        frame = thread->freeFrames;
+        thread->freeFrames = frame->parent;
+        free(frame);
+    }
+}
+
+void initLevelOrderState(LevelOrderState *level, int maxChunks)
+{
+    level->frontier = NULL;
+    level->next = NULL;
+    level->capacity = 0;
+    level->copyPhase = false;
+    level->maxChunks = maxChunks;
+    level->chunks = (LevelChunk *) calloc(maxChunks, sizeof(LevelChunk));
+    atomic_init(&(level->pendingChunks), 0);
+}
+
+void destroyLevelOrderState(LevelOrderState *level)
+{
+    int i;
+    for (i=0; i<level->maxChunks; i++)
+    {
+        free(level->chunks[i].children);
+    }
+    free(level->chunks);
+    free(level->frontier);
+    free(level->next);
 }
 
 void initThreadPool(ThreadPool *threadPool, StartThreadArgs *startArgs, int size)
 {
-    threadPool->size            = size;
-    threadPool->availThreads    = 0;
-    threadPool->nextThread      = 0;
-    threadPool->taskCount       = 0;
-    threadPool->addingTasks     = true;
-    threadPool->finished        = false;
+    threadPool->size = size;
+    threadPool->persistent = false;
+    threadPool->shutdown = false;
+    threadPool->epoch = 0;
+    threadPool->parkedThreads = 0;
     pthread_mutex_init(&(threadPool->mutex), NULL);
-    // edit this if you remove main thread from threadPool
-    threadPool->threads = (TraversalThread *) malloc((size+1) * sizeof(TraversalThread));
-
+    pthread_cond_init(&(threadPool->wakeCond), NULL);
+    pthread_cond_init(&(threadPool->parkedCond), NULL);
+    threadPool->task.traversalFunc = NULL;
+    threadPool->task.stolenFunc = NULL;
+    threadPool->task.root = NULL;
+    threadPool->task.callback = NULL;
+    threadPool->task.compactNodes = NULL;
+    threadPool->task.compactRoot = COMPACT_NULL;
+    threadPool->task.compactCallback = NULL;
+    threadPool->task.batchCallback = NULL;
+    threadPool->task.batchCtx = NULL;
+    threadPool->task.reduce = NULL;
+    threadPool->task.reduceAcc = NULL;
+    threadPool->task.find = NULL;
+    threadPool->task.jobCtx = NULL;
+    threadPool->grainPolicy = GRAIN_NONE;
+    threadPool->grainCutoff = 0;
+    initLevelOrderState(&(threadPool->level), LEVEL_CHUNKS_PER_THREAD * (size+1));
+    threadPool->spareThreads = 0;
+    threadPool->spareLimit = 0;
+    threadPool->spareShutdown = false;
+    pthread_cond_init(&(threadPool->spareCond), NULL);
+    threadPool->spareArgs = (StartThreadArgs *) malloc(POOL_MAX_SPARE_THREADS * sizeof(StartThreadArgs));
+    atomic_init(&(threadPool->blockedThreads), 0);
+    atomic_init(&(threadPool->activeSpares), 0);
+    atomic_init(&(threadPool->pendingTasks), 0);
+    // edit this if you remove main thread from threadPool (spares follow it 
+    // and are only initialized once setBlockingLimit starts them)
+    threadPool->threads = (TraversalThread *) aligned_alloc(
+        CACHE_LINE_SIZE, (size+1+POOL_MAX_SPARE_THREADS) * sizeof(TraversalThread)
+    );
+
+    // main thread is treated as last in thread pool (it also owns a deque)
     TraversalThread *t;
     int i;
-    for (i=0, t=threadPool->threads; i<threadPool->size; i++, t++)
+    for (i=0, t=threadPool->threads; i<threadPool->size+1; i++, t++)
     {
         initThread(t, i);
     }
-
-    // maybe remove later (treats main thread as last in thread poo)
-    threadPool->threads[size].threadID = size;
-    threadPool->threads[size].totalTasks = 0;
-    threadPool->threads[size].totalCallbacks = 0;
+    seedThreadPool(threadPool, RAND_STREAM_SEED);
 
     StartThreadArgs *s;
     for (i=0, t=threadPool->threads, s=startArgs; i<threadPool->size; i++, t++, s++)
@@ -88,330 +270,1410 @@ void initThreadPool(ThreadPool *threadPool, StartThreadArgs *startArgs, int size
     }
 }
 
+/* GRAIN_DEPTH: cutoff is depth below each task's root, GRAIN_SIZE: cutoff is 
+    a subtree size (the generators set subtreeSize, trees built by hand need 
+    computeSubtreeSizes), GRAIN_LAZY: cutoff is the deque length below which 
+    a thread keeps splitting */
+void setGrainPolicy(ThreadPool *threadPool, GrainPolicy grainPolicy, int grainCutoff)
+{
+    threadPool->grainPolicy = grainPolicy;
+    threadPool->grainCutoff = grainCutoff;
+}
+
+const char * grainPolicyName(GrainPolicy grainPolicy)
+{
+    switch (grainPolicy)
+    {
+        case GRAIN_DEPTH:   return "depth";
+        case GRAIN_SIZE:    return "size";
+        case GRAIN_LAZY:    return "lazy";
+        default:            return "none";
+    }
+}
+
+/* the main thread draws from stream 0 and every other thread (spares 
+    included) from stream threadID+1, so what the main thread generates 
+    doesn't depend on the pool size */
+void seedThreadPool(ThreadPool *threadPool, uint64_t seed)
+{
+    int i;
+    TraversalThread *t;
+    for (i=0, t=threadPool->threads; i<threadPool->size+1+POOL_MAX_SPARE_THREADS; i++, t++)
+    {
+        initRandStream(&(t->rng), seed, (i == threadPool->size) ? 0 : i+1);
+    }
+}
+
+/* workers, main thread and every spare started so far */
+int poolThreadCount(ThreadPool *threadPool)
+{
+    return threadPool->size + 1 + threadPool->spareThreads;
+}
+
 void destroyThreadPool(ThreadPool *threadPool, StartThreadArgs *startArgs)
 {
+    shutdownPersistentThreadPool(threadPool);
+    shutdownSpareThreads(threadPool);
+
     int i;
     TraversalThread *t;
-    for (i=0, t=threadPool->threads; i<threadPool->size; i++, t++)
+    for (i=0, t=threadPool->threads; i<threadPool->size+1; i++, t++)
     {
         destroyThread(t);
     }
     free(threadPool->threads);
+    free(threadPool->spareArgs);
+    destroyLevelOrderState(&(threadPool->level));
 
     pthread_mutex_destroy(&(threadPool->mutex));
+    pthread_cond_destroy(&(threadPool->wakeCond));
+    pthread_cond_destroy(&(threadPool->parkedCond));
+    pthread_cond_destroy(&(threadPool->spareCond));
 }
 
 
 
+void execTraversalTask(TraversalThread *thread, ThreadPool *threadPool, void *work)
+{
+    TraversalTask *task = &(threadPool->task);
+    thread->totalTasks++;
+    task->stolenFunc(work, task->callback, thread, threadPool);
+    atomic_fetch_sub(&(threadPool->pendingTasks), 1);
+}
 
+int nextVictim(TraversalThread *thread, ThreadPool *threadPool)
+{
+    // xorshift32, cheap per-thread victim selection
+    unsigned int x = thread->victimSeed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    thread->victimSeed = x;
+    return x % poolThreadCount(threadPool);
+}
 
-void execTraversalTask(TraversalThread *thread, ThreadPool *threadPool)
-{  
-    TraversalTask task = thread->task;
-    task.traversalFunc(task.root, task.callback, thread, threadPool);
+/* one attempt at a random victim, yields if there was nothing to take */
+void stealOnce(TraversalThread *thread, ThreadPool *threadPool)
+{
+    void *work = NULL;
+    int victim = nextVictim(thread, threadPool);
+    if (victim != thread->threadID)
+    {
+        work = stealDeque(&(threadPool->threads[victim].deque), &(threadPool->pendingTasks));
+    }
 
-    // locks may not be necessary for altering thread (would anyone else try to acquire it while busy = true?)
-    pthread_mutex_lock(&(threadPool->mutex));
-    pthread_mutex_lock(&(thread->mutex));
-    thread->busy = false;
-    threadPool->availThreads++;
-    threadPool->taskCount--;
-    if (threadPool->availThreads == 1)
+    if (work != NULL)
     {
-        threadPool->nextThread = thread->threadID;
+        thread->totalSteals++;
+        execTraversalTask(thread, threadPool, work);
+    }
+    else
+    {
+        sched_yield();
     }
-    pthread_mutex_unlock(&(thread->mutex));
-    pthread_mutex_unlock(&(threadPool->mutex));
 }
 
-void wakeAllThreads(ThreadPool *threadPool, int threadID)
+void workSteal(TraversalThread *thread, ThreadPool *threadPool)
 {
-    threadPool->finished = true;
-    int i;
-    TraversalThread *t;
-    for (i=0, t=threadPool->threads; i<threadPool->size; i++, t++)
+    while (atomic_load_explicit(&(threadPool->pendingTasks), memory_order_acquire) > 0)
     {
-        pthread_mutex_lock(&(t->mutex));
-        pthread_mutex_unlock(&(t->mutex));
-        pthread_cond_signal(&(t->cond));
+        stealOnce(thread, threadPool);
     }
 }
 
-bool shouldExit(ThreadPool *threadPool, int threadID)
+void * startThread(void *args)
 {
-    int callbacks = 0;
-    int i;
-    TraversalThread *t;
+    StartThreadArgs *threadArgs = (StartThreadArgs *) args;
+    swapThreadRandStream(&(threadArgs->thread->rng));
+    currentPool = threadArgs->threadPool;
+    workSteal(threadArgs->thread, threadArgs->threadPool);
+    return NULL;
+}
+
+void * startPersistentThread(void *args)
+{
+    StartThreadArgs *threadArgs = (StartThreadArgs *) args;
+    ThreadPool *threadPool = threadArgs->threadPool;
+    TraversalThread *thread = threadArgs->thread;
 
-    if (threadPool->finished)
+    // pool is launched at epoch 0, every later epoch is one traversal
+    unsigned long seenEpoch = 0;
+    swapThreadRandStream(&(thread->rng));
+    currentPool = threadPool;
+
+    pthread_mutex_lock(&(threadPool->mutex));
+    for (;;)
     {
-        return true;
+        while (threadPool->epoch == seenEpoch && !threadPool->shutdown)
+        {
+            pthread_cond_wait(&(threadPool->wakeCond), &(threadPool->mutex));
+        }
+        if (threadPool->shutdown) break;
+        seenEpoch = threadPool->epoch;
+        pthread_mutex_unlock(&(threadPool->mutex));
+
+        workSteal(thread, threadPool);
+
+        pthread_mutex_lock(&(threadPool->mutex));
+        threadPool->parkedThreads++;
+        if (threadPool->parkedThreads == threadPool->size)
+        {
+            pthread_cond_signal(&(threadPool->parkedCond));
+        }
     }
-    else
+    pthread_mutex_unlock(&(threadPool->mutex));
+
+    return NULL;
+}
+
+
+
+/* caller holds the pool mutex: a spare is wanted while fewer of them run than 
+    threads are blocked (capped by the limit) and a traversal is in flight */
+bool spareNeeded(ThreadPool *threadPool)
+{
+    int blocked = atomic_load(&(threadPool->blockedThreads));
+    if (blocked > threadPool->spareLimit) blocked = threadPool->spareLimit;
+    return atomic_load(&(threadPool->activeSpares)) < blocked
+        && atomic_load(&(threadPool->pendingTasks)) > 0;
+}
+
+/* steals like workSteal but hands its slot in activeSpares back as soon as 
+    more spares run than threads are blocked, only checked between tasks */
+void spareWorkSteal(TraversalThread *thread, ThreadPool *threadPool)
+{
+    int active;
+    while (atomic_load_explicit(&(threadPool->pendingTasks), memory_order_acquire) > 0)
     {
-        pthread_mutex_lock(&(threadPool->mutex));
-        bool result = !(threadPool->addingTasks || threadPool->taskCount > 0);
-        if (result)
+        active = atomic_load(&(threadPool->activeSpares));
+        if (active > atomic_load(&(threadPool->blockedThreads)) 
+            && atomic_compare_exchange_weak(&(threadPool->activeSpares), &active, active-1))
         {
-            wakeAllThreads(threadPool, threadID);
+            return;
         }
-        pthread_mutex_unlock(&(threadPool->mutex));
-        return result;
+        stealOnce(thread, threadPool);
     }
+    atomic_fetch_sub(&(threadPool->activeSpares), 1);
 }
 
-void * startThread(void *args)
+void * startSpareThread(void *args)
 {
     StartThreadArgs *threadArgs = (StartThreadArgs *) args;
     ThreadPool *threadPool = threadArgs->threadPool;
     TraversalThread *thread = threadArgs->thread;
 
+    swapThreadRandStream(&(thread->rng));
+    currentPool = threadPool;
+
+    pthread_mutex_lock(&(threadPool->mutex));
     for (;;)
     {
-        if (shouldExit(threadPool, thread->threadID)) break;
-
-        pthread_mutex_lock(&(thread->mutex));
-        while (!(thread->busy || threadPool->finished))
+        while (!spareNeeded(threadPool) && !threadPool->spareShutdown)
         {
-            pthread_cond_wait(&(thread->cond), &(thread->mutex));
+            pthread_cond_wait(&(threadPool->spareCond), &(threadPool->mutex));
         }
+        if (threadPool->spareShutdown) break;
+        atomic_fetch_add(&(threadPool->activeSpares), 1);
+        pthread_mutex_unlock(&(threadPool->mutex));
 
-        // may cause deadlock here
-        if (shouldExit(threadPool, thread->threadID)) {
-            pthread_mutex_unlock(&(thread->mutex));
-            break;
-        };
-
-        pthread_mutex_unlock(&(thread->mutex));
+        spareWorkSteal(thread, threadPool);
 
-        execTraversalTask(thread, threadPool);
+        pthread_mutex_lock(&(threadPool->mutex));
     }
+    pthread_mutex_unlock(&(threadPool->mutex));
 
     return NULL;
 }
 
+/* spares are started on demand and only stopped by destroyThreadPool, 
+    lowering the limit just leaves the extra ones parked */
+void setBlockingLimit(ThreadPool *threadPool, int maxSpares)
+{
+    if (maxSpares < 0) maxSpares = 0;
+    if (maxSpares > POOL_MAX_SPARE_THREADS) maxSpares = POOL_MAX_SPARE_THREADS;
 
-
-
-void startThreadPool(ThreadPool *threadPool, StartThreadArgs *startArgs)
-{    
-    threadPool->taskCount       = 0;
-    threadPool->availThreads    = threadPool->size;
-    threadPool->nextThread      = 0;
-    threadPool->addingTasks     = true;
-    threadPool->finished        = false;
+    pthread_mutex_lock(&(threadPool->mutex));
+    threadPool->spareLimit = maxSpares;
+    pthread_mutex_unlock(&(threadPool->mutex));
 
     int i;
     TraversalThread *t;
-    for (i=0, t=threadPool->threads; i<threadPool->size; i++, t++)
+    StartThreadArgs *s;
+    while (threadPool->spareThreads < maxSpares)
     {
-        t->started          = true;
-        t->busy             = false;
-        t->totalTasks       = 0;
-        t->totalCallbacks   = 0;
-        if (pthread_create(&(t->thread), NULL, &startThread, (void *) &(startArgs[i])) != 0)
+        i = threadPool->size + 1 + threadPool->spareThreads;
+        t = &(threadPool->threads[i]);
+        s = &(threadPool->spareArgs[threadPool->spareThreads]);
+        initThread(t, i);
+        s->thread = t;
+        s->threadPool = threadPool;
+
+        t->started = true;
+        if (pthread_create(&(t->thread), NULL, &startSpareThread, (void *) s) != 0)
         {
+            t->started = false;
             perror("Failed to create the thread");
+            destroyThread(t);
+            break;
         }
+        threadPool->spareThreads++;
+    }
+    if (threadPool->spareLimit > threadPool->spareThreads) 
+    {
+        threadPool->spareLimit = threadPool->spareThreads;
     }
-
-    // maybe remove later (treats main thread as last in thread poo)
-    t->totalTasks = 0;
-    t->totalCallbacks = 0;  
 }
 
-void joinThreadPool(ThreadPool *threadPool)
+void shutdownSpareThreads(ThreadPool *threadPool)
 {
     pthread_mutex_lock(&(threadPool->mutex));
-    threadPool->addingTasks = false;
-    if (threadPool->taskCount == 0) wakeAllThreads(threadPool, 0);
+    threadPool->spareShutdown = true;
+    pthread_cond_broadcast(&(threadPool->spareCond));
     pthread_mutex_unlock(&(threadPool->mutex));
 
     int i;
     TraversalThread *t;
-    for (i=0, t=threadPool->threads; i<threadPool->size; i++, t++)
+    for (i=0, t=threadPool->threads+threadPool->size+1; i<threadPool->spareThreads; i++, t++)
     {
-        if (pthread_join(t->thread, NULL) != 0)
+        if (t->started && pthread_join(t->thread, NULL) != 0)
         {
             perror("Failed to join the thread");
         }
+        t->started = false;
+        destroyThread(t);
     }
-
-    // // edit this if you remove main thread from threadPool
-    // for (i=0, t=threadPool->threads; i<threadPool->size+1; i++, t++)
-    // {
-    //     printf(
-    //         "Thread: %d , Tasks: %d , Callbacks: %d\n", 
-    //         t->threadID, t->totalTasks, t->totalCallbacks
-    //     );
-    // }
+    threadPool->spareThreads = 0;
+    threadPool->spareLimit = 0;
+    threadPool->spareShutdown = false;
 }
 
+/* no-op outside a pool traversal or with no spares allowed, signalling only 
+    happens while the blocked count is still within the limit */
+void poolBeginBlocking()
+{
+    ThreadPool *threadPool = currentPool;
+    if (threadPool == NULL || threadPool->spareLimit == 0) return;
 
-bool submitTraversalTask(ThreadPool *threadPool, 
-    Tree *root, TraversalFuncMT traversalFunc, TreeCallback callback, int threadID
-)
-{   
-    if (threadPool->availThreads > 0)
+    int blocked = atomic_fetch_add(&(threadPool->blockedThreads), 1) + 1;
+    if (blocked <= threadPool->spareLimit && atomic_load(&(threadPool->activeSpares)) < blocked)
     {
         pthread_mutex_lock(&(threadPool->mutex));
-        if (threadPool->availThreads == 0)
-        {
-            pthread_mutex_unlock(&(threadPool->mutex));
-            return false;
-        }
-        else
-        {
-            // this code may cause deadlock (what due to trying to grab all the locks)
-            TraversalThread *thread = (threadPool->threads + threadPool->nextThread);
-            threadPool->availThreads--;
-            threadPool->taskCount++;
-            if (threadPool->availThreads > 0)
-            {
-                int i = threadPool->nextThread;
-                do {
-                    i++;
-                    if (i==threadPool->size) i=0;
-                } while (threadPool->threads[i].busy);
-                threadPool->nextThread = i;
-            }
-
-            pthread_mutex_lock(&(thread->mutex));
-            thread->busy = true;
-            thread->task.root = root;
-            thread->task.traversalFunc = traversalFunc;
-            thread->task.callback = callback;
-            thread->totalTasks++;
-            pthread_mutex_unlock(&(thread->mutex));
-            pthread_mutex_unlock(&(threadPool->mutex));
-            pthread_cond_signal(&(thread->cond));
-
-            return true;
-        }
-    }
-    else
-    {
-        return false;
+        pthread_cond_signal(&(threadPool->spareCond));
+        pthread_mutex_unlock(&(threadPool->mutex));
     }
 }
 
+void poolEndBlocking()
+{
+    ThreadPool *threadPool = currentPool;
+    if (threadPool == NULL || threadPool->spareLimit == 0) return;
+    atomic_fetch_sub(&(threadPool->blockedThreads), 1);
+}
 
 
 
-/******************************************************************************* 
--------------------------- MULTI-THREADED TRAVERSALS ---------------------------
-*******************************************************************************/
-void preOrderMT(
-    Tree *root, TreeCallback callback, 
-    TraversalThread *thread, ThreadPool *threadPool
+void resetTraversal(ThreadPool *threadPool, TraversalFuncMT traversalFunc, 
+    StolenFuncMT stolenFunc, Tree *root, TreeCallback callback
 )
 {
-    callback(root);
-    thread->totalCallbacks++;
+    threadPool->task.traversalFunc  = traversalFunc;
+    threadPool->task.stolenFunc     = stolenFunc;
+    threadPool->task.root           = root;
+    threadPool->task.callback       = callback;
+    threadPool->task.compactNodes   = NULL;
+    threadPool->task.compactRoot    = COMPACT_NULL;
+    threadPool->task.compactCallback = NULL;
+    threadPool->task.batchCallback  = NULL;
+    threadPool->task.batchCtx       = NULL;
+    threadPool->task.reduce         = NULL;
+    threadPool->task.reduceAcc      = NULL;
+    threadPool->task.find           = NULL;
+    threadPool->task.jobCtx         = NULL;
+    // root task is pending until main thread finishes it
+    atomic_store(&(threadPool->pendingTasks), 1);
 
-    if (root->left != NULL)
+    int i;
+    TraversalThread *t;
+    for (i=0, t=threadPool->threads; i<poolThreadCount(threadPool); i++, t++)
     {
-        if (!submitTraversalTask(threadPool, root->left, preOrderMT, callback, thread->threadID))
-        {
-            preOrderMT(root->left, callback, thread, threadPool);
-        }
+        t->totalTasks       = 0;
+        t->totalSteals      = 0;
+        t->totalCallbacks   = 0;
     }
+}
 
-    if (root->right != NULL)
+void startThreadPool(ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+    int i;
+    TraversalThread *t;
+    for (i=0, t=threadPool->threads; i<threadPool->size; i++, t++)
     {
-        if (!submitTraversalTask(threadPool, root->right, preOrderMT, callback, thread->threadID))
+        t->started = true;
+        if (pthread_create(&(t->thread), NULL, &startThread, (void *) &(startArgs[i])) != 0)
         {
-            preOrderMT(root->right, callback, thread, threadPool);
+            t->started = false;
+            perror("Failed to create the thread");
         }
     }
-
-
-	// if (root->left != NULL)
-	// {
-    //     if (root->right != NULL)
-    //     {
-    //         if (!submitTraversalTask(threadPool, root->left, preOrderMT, callback, thread->threadID))
-    //         {
-    //             preOrderMT(root->left, callback, thread, threadPool);
-    //         }
-	// 	    preOrderMT(root->right, callback, thread, threadPool);
-    //     }
-    //     else
-    //     {
-    //         preOrderMT(root->left, callback, thread, threadPool);
-    //     }
-	// }
-    // else 
-    // {
-    //     if (root->right != NULL)
-    //     {
-    //         preOrderMT(root->right, callback, thread, threadPool);
-    //     }
-    // }
 }
-void preOrderMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs)
+
+void wakeThreadPool(ThreadPool *threadPool)
 {
-    startThreadPool(threadPool, startArgs);
-	preOrderMT(root, callback, &(threadPool->threads[threadPool->size]), threadPool);
-    joinThreadPool(threadPool);
+    pthread_mutex_lock(&(threadPool->mutex));
+    threadPool->parkedThreads = 0;
+    threadPool->epoch++;
+    pthread_cond_broadcast(&(threadPool->wakeCond));
+    pthread_mutex_unlock(&(threadPool->mutex));
 }
 
-
-
-void postOrderMT(
-    Tree *root, TreeCallback callback, 
-    TraversalThread *thread, ThreadPool *threadPool
-)
+void waitThreadPool(ThreadPool *threadPool)
 {
-    if (root->left != NULL)
+    // every worker must re-park before stats/task can be reset for next epoch
+    pthread_mutex_lock(&(threadPool->mutex));
+    while (threadPool->parkedThreads < threadPool->size)
     {
-        if (!submitTraversalTask(threadPool, root->left, postOrderMT, callback, thread->threadID))
-        {
-            postOrderMT(root->left, callback, thread, threadPool);
-        }
+        pthread_cond_wait(&(threadPool->parkedCond), &(threadPool->mutex));
     }
+    pthread_mutex_unlock(&(threadPool->mutex));
+}
+
+void runThreadPool(ThreadPool *threadPool)
+{
+    // main thread executes root task, then helps until all subtrees finish
+    TraversalThread *mainThread = &(threadPool->threads[threadPool->size]);
+    TraversalTask *task = &(threadPool->task);
+    RandStream *callerStream = swapThreadRandStream(&(mainThread->rng));
+    ThreadPool *callerPool = currentPool;
+    currentPool = threadPool;
+    mainThread->totalTasks++;
+    task->traversalFunc(task->root, task->callback, mainThread, threadPool);
+    atomic_fetch_sub(&(threadPool->pendingTasks), 1);
+    workSteal(mainThread, threadPool);
+    currentPool = callerPool;
+    swapThreadRandStream(callerStream);
+}
 
-    if (root->right != NULL)
+void joinThreadPool(ThreadPool *threadPool)
+{
+    int i;
+    TraversalThread *t;
+    for (i=0, t=threadPool->threads; i<threadPool->size; i++, t++)
     {
-        if (!submitTraversalTask(threadPool, root->right, postOrderMT, callback, thread->threadID))
+        if (t->started && pthread_join(t->thread, NULL) != 0)
         {
-            postOrderMT(root->right, callback, thread, threadPool);
+            perror("Failed to join the thread");
         }
+        t->started = false;
     }
 
-
-	// if (root->left != NULL)
-	// {
-    //     if (root->right != NULL)
-    //     {
-    //         if (!submitTraversalTask(threadPool, root->left, postOrderMT, callback, thread->threadID))
-    //         {
-    //             postOrderMT(root->left, callback, thread, threadPool);
-    //         }
-	// 	    postOrderMT(root->right, callback, thread, threadPool);
-    //     }
-    //     else
-    //     {
-    //         postOrderMT(root->left, callback, thread, threadPool);
-    //     }
-	// }
-    // else 
+    // // edit this if you remove main thread from threadPool
+    // for (i=0, t=threadPool->threads; i<threadPool->size+1; i++, t++)
     // {
-    //     if (root->right != NULL)
-    //     {
-    //         postOrderMT(root->right, callback, thread, threadPool);
-    //     }
+    //     printf(
+    //         "Thread: %d , Tasks: %d , Steals: %d , Callbacks: %d\n",
+    //         t->threadID, t->totalTasks, t->totalSteals, t->totalCallbacks
+    //     );
     // }
+}
 
 
-    callback(root);
-    thread->totalCallbacks++;
-}
-void postOrderMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs)
+
+
+void launchPersistentThreadPool(ThreadPool *threadPool, StartThreadArgs *startArgs)
 {
-    startThreadPool(threadPool, startArgs);
-    postOrderMT(root, callback, &(threadPool->threads[threadPool->size]), threadPool);
-    joinThreadPool(threadPool);
+    if (threadPool->persistent) return;
+
+    threadPool->persistent      = true;
+    threadPool->shutdown        = false;
+    threadPool->epoch           = 0;
+    threadPool->parkedThreads   = threadPool->size;
+
+    int i;
+    TraversalThread *t;
+    for (i=0, t=threadPool->threads; i<threadPool->size; i++, t++)
+    {
+        t->started = true;
+        if (pthread_create(&(t->thread), NULL, &startPersistentThread, (void *) &(startArgs[i])) != 0)
+        {
+            t->started = false;
+            perror("Failed to create the thread");
+            shutdownPersistentThreadPool(threadPool);
+            return;
+        }
+    }
+}
+
+void shutdownPersistentThreadPool(ThreadPool *threadPool)
+{
+    if (!threadPool->persistent) return;
+
+    pthread_mutex_lock(&(threadPool->mutex));
+    threadPool->shutdown = true;
+    pthread_cond_broadcast(&(threadPool->wakeCond));
+    pthread_mutex_unlock(&(threadPool->mutex));
+
+    joinThreadPool(threadPool);
+    threadPool->persistent = false;
+}
+
+
+
+void dispatchTraversal(ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+    if (threadPool->persistent)
+    {
+        wakeThreadPool(threadPool);
+        runThreadPool(threadPool);
+        waitThreadPool(threadPool);
+    }
+    else
+    {
+        startThreadPool(threadPool, startArgs);
+        runThreadPool(threadPool);
+        joinThreadPool(threadPool);
+    }
+}
+
+void runTraversalMT(ThreadPool *threadPool, StartThreadArgs *startArgs,
+    TraversalFuncMT traversalFunc, StolenFuncMT stolenFunc, Tree *root, 
+    TreeCallback callback
+)
+{
+    resetTraversal(threadPool, traversalFunc, stolenFunc, root, callback);
+    dispatchTraversal(threadPool, startArgs);
+}
+
+void runBatchTraversalMT(ThreadPool *threadPool, StartThreadArgs *startArgs,
+    TraversalFuncMT traversalFunc, StolenFuncMT stolenFunc, Tree *root, 
+    TreeBatchCallback callback, void *ctx
+)
+{
+    resetTraversal(threadPool, traversalFunc, stolenFunc, root, NULL);
+    threadPool->task.batchCallback  = callback;
+    threadPool->task.batchCtx       = ctx;
+    dispatchTraversal(threadPool, startArgs);
+}
+
+/* jobFunc runs on the main thread with a NULL root, whatever it pushes goes 
+    to stolenFunc, both find their state in task.jobCtx */
+void runJobMT(ThreadPool *threadPool, StartThreadArgs *startArgs,
+    TraversalFuncMT jobFunc, StolenFuncMT stolenFunc, void *ctx
+)
+{
+    resetTraversal(threadPool, jobFunc, stolenFunc, NULL, NULL);
+    threadPool->task.jobCtx = ctx;
+    dispatchTraversal(threadPool, startArgs);
+}
+
+void runCompactTraversalMT(ThreadPool *threadPool, StartThreadArgs *startArgs,
+    TraversalFuncMT traversalFunc, StolenFuncMT stolenFunc, CompactTree *nodes, 
+    uint32_t root, CompactCallback callback
+)
+{
+    resetTraversal(threadPool, traversalFunc, stolenFunc, NULL, NULL);
+    threadPool->task.compactNodes       = nodes;
+    threadPool->task.compactRoot        = root;
+    threadPool->task.compactCallback    = callback;
+    dispatchTraversal(threadPool, startArgs);
+}
+
+
+
+
+/******************************************************************************* 
+-------------------------- MULTI-THREADED TRAVERSALS ---------------------------
+*******************************************************************************/
+/* false once root is below the depth/size cutoff, the subtree then runs serially */
+bool aboveGrain(ThreadPool *threadPool, Tree *root, int depth)
+{
+    switch (threadPool->grainPolicy)
+    {
+        case GRAIN_DEPTH:   return depth < threadPool->grainCutoff;
+        case GRAIN_SIZE:    return root->subtreeSize > threadPool->grainCutoff;
+        default:            return true;
+    }
+}
+
+/* exposes work to thieves, lazy splitting skips it while enough are queued */
+bool spawnSubtree(TraversalThread *thread, ThreadPool *threadPool, void *work)
+{
+    if (threadPool->grainPolicy == GRAIN_LAZY 
+        && sizeDeque(&(thread->deque)) >= threadPool->grainCutoff)
+    {
+        return false;
+    }
+    return pushDeque(&(thread->deque), work);
+}
+
+
+
+void preOrderMTGrain(
+    Tree *root, TreeCallback callback, int depth,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    if (!aboveGrain(threadPool, root, depth))
+    {
+        preOrderCB(root, callback);
+        return;
+    }
+
+    callback(root);
+    thread->totalCallbacks++;
+
+    // expose right subtree to thieves while we descend left, take it back after
+    bool spawned = (root->left != NULL && root->right != NULL
+        && spawnSubtree(thread, threadPool, root->right));
+
+    if (root->left != NULL)
+    {
+        preOrderMTGrain(root->left, callback, depth+1, thread, threadPool);
+    }
+
+    if (root->right != NULL && (!spawned || popDeque(&(thread->deque)) != NULL))
+    {
+        preOrderMTGrain(root->right, callback, depth+1, thread, threadPool);
+    }
+}
+void preOrderMT(
+    Tree *root, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    preOrderMTGrain(root, callback, 0, thread, threadPool);
+}
+void preOrderMTStolen(
+    void *work, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    preOrderMTGrain((Tree *) work, callback, 0, thread, threadPool);
+}
+void preOrderMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+    runTraversalMT(threadPool, startArgs, preOrderMT, preOrderMTStolen, root, callback);
+}
+
+
+
+/* requests both children of root, reading root's pointers is cheap once root 
+    itself was prefetched a level up */
+void prefetchChildren(Tree *root)
+{
+    if (root != NULL)
+    {
+        __builtin_prefetch(root->left);
+        __builtin_prefetch(root->right);
+    }
+}
+
+/* preOrderMTGrain with the children and grandchildren prefetched before the 
+    callback (the grandchildren are the look-ahead, their parents were 
+    requested one level up), subtrees below the grain run preOrderLookaheadCB */
+void preOrderPrefetchMTGrain(
+    Tree *root, TreeCallback callback, int depth,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    if (!aboveGrain(threadPool, root, depth))
+    {
+        preOrderLookaheadCB(root, callback);
+        return;
+    }
+
+    prefetchChildren(root);
+    prefetchChildren(root->left);
+    prefetchChildren(root->right);
+    callback(root);
+    thread->totalCallbacks++;
+
+    bool spawned = (root->left != NULL && root->right != NULL
+        && spawnSubtree(thread, threadPool, root->right));
+
+    if (root->left != NULL)
+    {
+        preOrderPrefetchMTGrain(root->left, callback, depth+1, thread, threadPool);
+    }
+
+    if (root->right != NULL && (!spawned || popDeque(&(thread->deque)) != NULL))
+    {
+        preOrderPrefetchMTGrain(root->right, callback, depth+1, thread, threadPool);
+    }
+}
+void preOrderPrefetchMT(
+    Tree *root, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    preOrderPrefetchMTGrain(root, callback, 0, thread, threadPool);
+}
+void preOrderPrefetchMTStolen(
+    void *work, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    preOrderPrefetchMTGrain((Tree *) work, callback, 0, thread, threadPool);
+}
+void preOrderPrefetchMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+    runTraversalMT(threadPool, startArgs, preOrderPrefetchMT, preOrderPrefetchMTStolen, root, callback);
+}
+
+
+
+PostOrderFrame * allocFrame(TraversalThread *thread, void *node, PostOrderFrame *parent, int pending)
+{
+    PostOrderFrame *frame = thread->freeFrames;
+    if (frame != NULL)
+    {
+        thread->freeFrames = frame->parent;
+    }
+    else
+    {
+        frame = (PostOrderFrame *) malloc(sizeof(PostOrderFrame));
+    }
+    atomic_init(&(frame->pending), pending);
+    frame->node = node;
+    frame->parent = parent;
+    return frame;
+}
+
+void freeFrame(TraversalThread *thread, PostOrderFrame *frame)
+{
+    frame->parent = thread->freeFrames;
+    thread->freeFrames = frame;
+}
+
+/* called once a child of frame->node finished off the owner's stack, the 
+    thread that drops pending to zero runs the callback and climbs upwards */
+void completeFrame(PostOrderFrame *frame, TraversalThread *thread, ThreadPool *threadPool)
+{
+    TraversalTask *task = &(threadPool->task);
+    PostOrderFrame *parent;
+    while (frame != NULL 
+        && atomic_fetch_sub_explicit(&(frame->pending), 1, memory_order_acq_rel) == 1)
+    {
+        if (task->compactNodes != NULL) task->compactCallback((CompactTree *) frame->node);
+        else task->callback((Tree *) frame->node);
+        thread->totalCallbacks++;
+        parent = frame->parent;
+        freeFrame(thread, frame);
+        frame = parent;
+    }
+}
+
+/* returns true if root's subtree (root included) finished before returning, 
+    otherwise completing it was handed off and parent will be notified later, 
+    with prefetch set children and grandchildren are requested on the way down */
+bool postOrderMTGrain(
+    Tree *root, TreeCallback callback, int depth, PostOrderFrame *parent,
+    bool prefetch, TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    if (!aboveGrain(threadPool, root, depth))
+    {
+        if (prefetch) postOrderPrefetchCB(root, callback);
+        else postOrderCB(root, callback);
+        return true;
+    }
+
+    if (prefetch)
+    {
+        prefetchChildren(root);
+        prefetchChildren(root->left);
+        prefetchChildren(root->right);
+    }
+
+    int children = (root->left != NULL) + (root->right != NULL);
+    if (children == 0)
+    {
+        callback(root);
+        thread->totalCallbacks++;
+        return true;
+    }
+
+    PostOrderFrame *frame = allocFrame(thread, root, parent, children);
+
+    // right subtree is exposed through the frame so a thief knows where to report
+    bool spawned = (children == 2 && spawnSubtree(thread, threadPool, frame));
+
+    int finished = 0;
+    if (root->left != NULL)
+    {
+        finished += postOrderMTGrain(root->left, callback, depth+1, frame, prefetch, thread, threadPool);
+    }
+
+    if (root->right != NULL && (!spawned || popDeque(&(thread->deque)) != NULL))
+    {
+        finished += postOrderMTGrain(root->right, callback, depth+1, frame, prefetch, thread, threadPool);
+    }
+
+    // children that finished here were never counted down, settle them at once
+    if (finished == 0) return false;
+    if (finished < children 
+        && atomic_fetch_sub_explicit(&(frame->pending), finished, memory_order_acq_rel) != finished)
+    {
+        return false;
+    }
+
+    callback(root);
+    thread->totalCallbacks++;
+    freeFrame(thread, frame);
+    return true;
+}
+void postOrderMT(
+    Tree *root, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    postOrderMTGrain(root, callback, 0, NULL, false, thread, threadPool);
+}
+void postOrderMTStolen(
+    void *work, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    PostOrderFrame *frame = (PostOrderFrame *) work;
+    if (postOrderMTGrain(((Tree *) frame->node)->right, callback, 0, frame, false, thread, threadPool))
+    {
+        completeFrame(frame, thread, threadPool);
+    }
+}
+void postOrderMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+    runTraversalMT(threadPool, startArgs, postOrderMT, postOrderMTStolen, root, callback);
+}
+
+
+
+void postOrderPrefetchMT(
+    Tree *root, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    postOrderMTGrain(root, callback, 0, NULL, true, thread, threadPool);
+}
+void postOrderPrefetchMTStolen(
+    void *work, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    PostOrderFrame *frame = (PostOrderFrame *) work;
+    if (postOrderMTGrain(((Tree *) frame->node)->right, callback, 0, frame, true, thread, threadPool))
+    {
+        completeFrame(frame, thread, threadPool);
+    }
+}
+void postOrderPrefetchMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+    runTraversalMT(threadPool, startArgs, postOrderPrefetchMT, postOrderPrefetchMTStolen, root, callback);
+}
+
+
+
+/* grows both frontiers so a level of levelSize nodes and its children fit */
+void reserveLevel(LevelOrderState *level, long levelSize)
+{
+    if (2*levelSize <= level->capacity) return;
+
+    level->capacity = 2*levelSize;
+    level->frontier = (Tree **) realloc(level->frontier, level->capacity * sizeof(Tree *));
+    level->next = (Tree **) realloc(level->next, level->capacity * sizeof(Tree *));
+}
+
+/* writes the children of [node, end) to out and visits the nodes, batched 
+    callbacks are handed the frontier itself in CALLBACK_BATCH_SIZE slices */
+long expandLevel(Tree **node, Tree **end, Tree **out, TraversalTask *task)
+{
+    Tree **start = out, **slice, **sliceEnd;
+    TreeCallback callback = task->callback;
+
+    if (task->batchCallback == NULL)
+    {
+        for (; node<end; node++)
+        {
+            if ((*node)->left != NULL) *(out++) = (*node)->left;
+            if ((*node)->right != NULL) *(out++) = (*node)->right;
+            callback(*node);
+        }
+        return out - start;
+    }
+
+    for (slice=node; slice<end; slice=sliceEnd)
+    {
+        sliceEnd = (end - slice > CALLBACK_BATCH_SIZE) ? slice + CALLBACK_BATCH_SIZE : end;
+        for (node=slice; node<sliceEnd; node++)
+        {
+            if ((*node)->left != NULL) *(out++) = (*node)->left;
+            if ((*node)->right != NULL) *(out++) = (*node)->right;
+        }
+        task->batchCallback(slice, sliceEnd - slice, task->batchCtx);
+    }
+    return out - start;
+}
+
+void expandLevelChunk(LevelOrderState *level, LevelChunk *chunk, TraversalTask *task, TraversalThread *thread)
+{
+    chunk->count = expandLevel(
+        level->frontier + chunk->begin, level->frontier + chunk->end, chunk->children, task
+    );
+    thread->totalCallbacks += chunk->end - chunk->begin;
+}
+
+void runLevelChunk(LevelOrderState *level, LevelChunk *chunk, TraversalTask *task, TraversalThread *thread)
+{
+    if (level->copyPhase)
+    {
+        memcpy(level->next + chunk->offset, chunk->children, chunk->count * sizeof(Tree *));
+    }
+    else
+    {
+        expandLevelChunk(level, chunk, task, thread);
+    }
+    atomic_fetch_sub_explicit(&(level->pendingChunks), 1, memory_order_release);
+}
+
+/* hands chunks 1..n-1 to thieves, runs the rest itself, then waits for stragglers */
+void runLevelPhase(LevelOrderState *level, int numChunks, TraversalTask *task, TraversalThread *thread)
+{
+    LevelChunk *chunk;
+    int i;
+
+    atomic_store_explicit(&(level->pendingChunks), numChunks, memory_order_relaxed);
+    for (i=1; i<numChunks; i++)
+    {
+        if (!pushDeque(&(thread->deque), &(level->chunks[i])))
+        {
+            runLevelChunk(level, &(level->chunks[i]), task, thread);
+        }
+    }
+
+    runLevelChunk(level, &(level->chunks[0]), task, thread);
+    while ((chunk = (LevelChunk *) popDeque(&(thread->deque))) != NULL)
+    {
+        runLevelChunk(level, chunk, task, thread);
+    }
+
+    while (atomic_load_explicit(&(level->pendingChunks), memory_order_acquire) > 0)
+    {
+        sched_yield();
+    }
+}
+
+void levelOrderMT(
+    Tree *root, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    LevelOrderState *level = &(threadPool->level);
+    TraversalTask *task = &(threadPool->task);
+    LevelChunk *chunk;
+    Tree **swap;
+    long levelSize, nextSize, chunkSize;
+    int numChunks, c;
+
+    reserveLevel(level, 1);
+    level->frontier[0] = root;
+    levelSize = 1;
+
+    while (levelSize > 0)
+    {
+        reserveLevel(level, levelSize);
+
+        numChunks = levelSize / LEVEL_MIN_CHUNK;
+        if (numChunks > level->maxChunks) numChunks = level->maxChunks;
+
+        if (numChunks <= 1)
+        {
+            // narrow level, not worth waking anyone
+            nextSize = expandLevel(level->frontier, level->frontier + levelSize, level->next, task);
+            thread->totalCallbacks += levelSize;
+        }
+        else
+        {
+            chunkSize = (levelSize + numChunks - 1) / numChunks;
+            for (c=0, chunk=level->chunks; c<numChunks; c++, chunk++)
+            {
+                chunk->begin = c * chunkSize;
+                chunk->end = (chunk->begin + chunkSize < levelSize) ? chunk->begin + chunkSize : levelSize;
+                if (chunk->capacity < 2*chunkSize)
+                {
+                    chunk->capacity = 2*chunkSize;
+                    chunk->children = (Tree **) realloc(chunk->children, chunk->capacity * sizeof(Tree *));
+                }
+            }
+
+            level->copyPhase = false;
+            runLevelPhase(level, numChunks, task, thread);
+
+            // exclusive prefix sum over chunk counts keeps the level left to right
+            nextSize = 0;
+            for (c=0, chunk=level->chunks; c<numChunks; c++, chunk++)
+            {
+                chunk->offset = nextSize;
+                nextSize += chunk->count;
+            }
+
+            level->copyPhase = true;
+            runLevelPhase(level, numChunks, task, thread);
+        }
+
+        swap = level->frontier;
+        level->frontier = level->next;
+        level->next = swap;
+        levelSize = nextSize;
+    }
+}
+void levelOrderMTStolen(
+    void *work, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    runLevelChunk(&(threadPool->level), (LevelChunk *) work, &(threadPool->task), thread);
+}
+void levelOrderMTWrapper(Tree *root, TreeCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+    runTraversalMT(threadPool, startArgs, levelOrderMT, levelOrderMTStolen, root, callback);
+}
+void levelOrderBatchMTWrapper(Tree *root, TreeBatchCallback callback, void *ctx, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+    runBatchTraversalMT(threadPool, startArgs, levelOrderMT, levelOrderMTStolen, root, callback, ctx);
+}
+
+
+
+/* same as preOrderMTGrain but nodes go to the thread's batch, which is 
+    flushed before each task returns so nothing is left once pendingTasks 
+    drops to zero */
+void preOrderBatchMTGrain(
+    Tree *root, int depth, TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    TreeBatch *batch = &(thread->batch);
+    if (!aboveGrain(threadPool, root, depth))
+    {
+        preOrderBatchFill(root, batch);
+        return;
+    }
+
+    if (batch->n == CALLBACK_BATCH_SIZE) flushTreeBatch(batch);
+    batch->nodes[(batch->n)++] = root;
+    thread->totalCallbacks++;
+
+    bool spawned = (root->left != NULL && root->right != NULL
+        && spawnSubtree(thread, threadPool, root->right));
+
+    if (root->left != NULL)
+    {
+        preOrderBatchMTGrain(root->left, depth+1, thread, threadPool);
+    }
+
+    if (root->right != NULL && (!spawned || popDeque(&(thread->deque)) != NULL))
+    {
+        preOrderBatchMTGrain(root->right, depth+1, thread, threadPool);
+    }
+}
+void preOrderBatchMT(
+    Tree *root, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    initTreeBatch(&(thread->batch), threadPool->task.batchCallback, threadPool->task.batchCtx);
+    preOrderBatchMTGrain(root, 0, thread, threadPool);
+    flushTreeBatch(&(thread->batch));
+}
+void preOrderBatchMTStolen(
+    void *work, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    preOrderBatchMT((Tree *) work, callback, thread, threadPool);
+}
+void preOrderBatchMTWrapper(Tree *root, TreeBatchCallback callback, void *ctx, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+    runBatchTraversalMT(threadPool, startArgs, preOrderBatchMT, preOrderBatchMTStolen, root, callback, ctx);
+}
+
+
+
+/* same as preOrderMTGrain but every node is folded into the thread's own 
+    accumulator, below the grain the serial reduce keeps it in a register */
+void preOrderReduceMTGrain(
+    Tree *root, int depth, TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    ReduceOp *op = threadPool->task.reduce;
+    if (!aboveGrain(threadPool, root, depth))
+    {
+        thread->acc.value = preOrderReduce(root, op, thread->acc.value);
+        return;
+    }
+
+    thread->acc.value = op->combine(thread->acc.value, op->map(root, op->ctx));
+    thread->totalCallbacks++;
+
+    bool spawned = (root->left != NULL && root->right != NULL
+        && spawnSubtree(thread, threadPool, root->right));
+
+    if (root->left != NULL)
+    {
+        preOrderReduceMTGrain(root->left, depth+1, thread, threadPool);
+    }
+
+    if (root->right != NULL && (!spawned || popDeque(&(thread->deque)) != NULL))
+    {
+        preOrderReduceMTGrain(root->right, depth+1, thread, threadPool);
+    }
+}
+void preOrderReduceMT(
+    Tree *root, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    preOrderReduceMTGrain(root, 0, thread, threadPool);
+}
+void preOrderReduceMTStolen(
+    void *work, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    preOrderReduceMTGrain((Tree *) work, 0, thread, threadPool);
+}
+
+/* accumulators start at identity and are merged once the pool has joined 
+    (or parked), which also makes the workers' writes visible here */
+int64_t traverseReduce(
+    Tree *root, ReduceMap map, ReduceCombine combine, int64_t identity, void *ctx,
+    ThreadPool *threadPool, StartThreadArgs *startArgs
+)
+{
+    ReduceOp op = {map, combine, identity, ctx};
+    int64_t result = identity;
+    int i;
+    TraversalThread *t;
+
+    if (root == NULL) return identity;
+
+    for (i=0, t=threadPool->threads; i<poolThreadCount(threadPool); i++, t++)
+    {
+        t->acc.value = identity;
+    }
+
+    resetTraversal(threadPool, preOrderReduceMT, preOrderReduceMTStolen, root, NULL);
+    threadPool->task.reduce = &op;
+    dispatchTraversal(threadPool, startArgs);
+
+    for (i=0, t=threadPool->threads; i<poolThreadCount(threadPool); i++, t++)
+    {
+        result = combine(result, t->acc.value);
+    }
+    return result;
+}
+
+/* as preOrderReduceMTGrain with the thread's accumulator in op->accs */
+void preOrderReduceAccMTGrain(
+    Tree *root, int depth, void *acc, TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    ReduceAccOp *op = threadPool->task.reduceAcc;
+    if (!aboveGrain(threadPool, root, depth))
+    {
+        preOrderReduceAcc(root, op, acc);
+        return;
+    }
+
+    op->fold(acc, root, op->ctx);
+    thread->totalCallbacks++;
+
+    bool spawned = (root->left != NULL && root->right != NULL
+        && spawnSubtree(thread, threadPool, root->right));
+
+    if (root->left != NULL)
+    {
+        preOrderReduceAccMTGrain(root->left, depth+1, acc, thread, threadPool);
+    }
+
+    if (root->right != NULL && (!spawned || popDeque(&(thread->deque)) != NULL))
+    {
+        preOrderReduceAccMTGrain(root->right, depth+1, acc, thread, threadPool);
+    }
+}
+void * threadReduceAcc(TraversalThread *thread, ThreadPool *threadPool)
+{
+    ReduceAccOp *op = threadPool->task.reduceAcc;
+    return op->accs + (thread - threadPool->threads) * op->stride;
+}
+void preOrderReduceAccMT(
+    Tree *root, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    preOrderReduceAccMTGrain(root, 0, threadReduceAcc(thread, threadPool), thread, threadPool);
+}
+void preOrderReduceAccMTStolen(
+    void *work, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    preOrderReduceAccMTGrain((Tree *) work, 0, threadReduceAcc(thread, threadPool), thread, threadPool);
+}
+
+void traverseReduceAcc(
+    Tree *root, ReduceAccOp *op, void *result,
+    ThreadPool *threadPool, StartThreadArgs *startArgs
+)
+{
+    // one per pool thread, spares only change between traversals (see traverseReduce)
+    int i, count = poolThreadCount(threadPool);
+
+    op->init(result);
+    if (root == NULL) return;
+
+    // whole cache lines per thread so accumulators never share one
+    op->stride = (op->accSize + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    op->accs = (char *) aligned_alloc(CACHE_LINE_SIZE, count * op->stride);
+    for (i=0; i<count; i++) op->init(op->accs + i * op->stride);
+
+    resetTraversal(threadPool, preOrderReduceAccMT, preOrderReduceAccMTStolen, root, NULL);
+    threadPool->task.reduceAcc = op;
+    dispatchTraversal(threadPool, startArgs);
+
+    for (i=0; i<count; i++) op->merge(result, op->accs + i * op->stride);
+    free(op->accs);
+    op->accs = NULL;
+}
+
+
+
+bool findCancelled(FindState *find)
+{
+    return atomic_load_explicit(&(find->cancelled), memory_order_relaxed);
+}
+
+/* only the first match is kept, any match cancels the rest of the search */
+void claimMatch(FindState *find, Tree *node)
+{
+    Tree *expected = NULL;
+    atomic_compare_exchange_strong(&(find->match), &expected, node);
+    atomic_store_explicit(&(find->cancelled), true, memory_order_release);
+}
+
+/* serial search below the grain */
+void preOrderFindSubtree(Tree *root, FindState *find)
+{
+    if (root == NULL || findCancelled(find)) return;
+    if (find->predicate(root, find->ctx))
+    {
+        claimMatch(find, root);
+        return;
+    }
+    preOrderFindSubtree(root->left, find);
+    preOrderFindSubtree(root->right, find);
+}
+
+/* same as preOrderMTGrain but returns as soon as the search is cancelled. The 
+    right subtree is still popped back after a cancelled left one, so nothing 
+    is left in the deque, and stolen subtrees return on their first check */
+void preOrderFindMTGrain(
+    Tree *root, int depth, TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    FindState *find = threadPool->task.find;
+    if (findCancelled(find)) return;
+    if (!aboveGrain(threadPool, root, depth))
+    {
+        preOrderFindSubtree(root, find);
+        return;
+    }
+
+    thread->totalCallbacks++;
+    if (find->predicate(root, find->ctx))
+    {
+        claimMatch(find, root);
+        return;
+    }
+
+    bool spawned = (root->left != NULL && root->right != NULL
+        && spawnSubtree(thread, threadPool, root->right));
+
+    if (root->left != NULL)
+    {
+        preOrderFindMTGrain(root->left, depth+1, thread, threadPool);
+    }
+
+    if (root->right != NULL && (!spawned || popDeque(&(thread->deque)) != NULL))
+    {
+        preOrderFindMTGrain(root->right, depth+1, thread, threadPool);
+    }
+}
+void preOrderFindMT(
+    Tree *root, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    preOrderFindMTGrain(root, 0, thread, threadPool);
+}
+void preOrderFindMTStolen(
+    void *work, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    preOrderFindMTGrain((Tree *) work, 0, thread, threadPool);
+}
+
+/* returns a node satisfying predicate (whichever thread got there first, so 
+    not necessarily the first in pre-order) or NULL if there is none */
+Tree * findFirstMT(
+    Tree *root, TreePredicate predicate, void *ctx,
+    ThreadPool *threadPool, StartThreadArgs *startArgs
+)
+{
+    FindState find;
+    if (root == NULL) return NULL;
+
+    find.predicate  = predicate;
+    find.ctx        = ctx;
+    atomic_init(&(find.cancelled), false);
+    atomic_init(&(find.match), NULL);
+
+    resetTraversal(threadPool, preOrderFindMT, preOrderFindMTStolen, root, NULL);
+    threadPool->task.find = &find;
+    dispatchTraversal(threadPool, startArgs);
+
+    return atomic_load(&(find.match));
+}
+
+
+
+/* compact nodes carry no subtree sizes, so GRAIN_SIZE acts like GRAIN_NONE */
+bool aboveGrainCompact(ThreadPool *threadPool, int depth)
+{
+    return threadPool->grainPolicy != GRAIN_DEPTH || depth < threadPool->grainCutoff;
+}
+
+void preOrderCompactMTGrain(
+    CompactTree *nodes, uint32_t root, CompactCallback callback, int depth,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    if (!aboveGrainCompact(threadPool, depth))
+    {
+        preOrderCompactCB(nodes, root, callback);
+        return;
+    }
+
+    CompactTree *node = nodes + root;
+    callback(node);
+    thread->totalCallbacks++;
+
+    bool spawned = (node->left != COMPACT_NULL && node->right != COMPACT_NULL
+        && spawnSubtree(thread, threadPool, nodes + node->right));
+
+    if (node->left != COMPACT_NULL)
+    {
+        preOrderCompactMTGrain(nodes, node->left, callback, depth+1, thread, threadPool);
+    }
+
+    if (node->right != COMPACT_NULL && (!spawned || popDeque(&(thread->deque)) != NULL))
+    {
+        preOrderCompactMTGrain(nodes, node->right, callback, depth+1, thread, threadPool);
+    }
+}
+void preOrderCompactMT(
+    Tree *root, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    TraversalTask *task = &(threadPool->task);
+    preOrderCompactMTGrain(task->compactNodes, task->compactRoot, task->compactCallback, 0, thread, threadPool);
+}
+void preOrderCompactMTStolen(
+    void *work, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    TraversalTask *task = &(threadPool->task);
+    uint32_t root = (uint32_t) ((CompactTree *) work - task->compactNodes);
+    preOrderCompactMTGrain(task->compactNodes, root, task->compactCallback, 0, thread, threadPool);
+}
+void preOrderCompactMTWrapper(CompactTree *nodes, uint32_t root, CompactCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+    runCompactTraversalMT(threadPool, startArgs, preOrderCompactMT, preOrderCompactMTStolen, nodes, root, callback);
+}
+
+
+
+/* same contract as postOrderMTGrain */
+bool postOrderCompactMTGrain(
+    CompactTree *nodes, uint32_t root, CompactCallback callback, int depth, 
+    PostOrderFrame *parent, TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    if (!aboveGrainCompact(threadPool, depth))
+    {
+        postOrderCompactCB(nodes, root, callback);
+        return true;
+    }
+
+    CompactTree *node = nodes + root;
+    int children = (node->left != COMPACT_NULL) + (node->right != COMPACT_NULL);
+    if (children == 0)
+    {
+        callback(node);
+        thread->totalCallbacks++;
+        return true;
+    }
+
+    PostOrderFrame *frame = allocFrame(thread, node, parent, children);
+    bool spawned = (children == 2 && spawnSubtree(thread, threadPool, frame));
+
+    int finished = 0;
+    if (node->left != COMPACT_NULL)
+    {
+        finished += postOrderCompactMTGrain(nodes, node->left, callback, depth+1, frame, thread, threadPool);
+    }
+
+    if (node->right != COMPACT_NULL && (!spawned || popDeque(&(thread->deque)) != NULL))
+    {
+        finished += postOrderCompactMTGrain(nodes, node->right, callback, depth+1, frame, thread, threadPool);
+    }
+
+    if (finished == 0) return false;
+    if (finished < children 
+        && atomic_fetch_sub_explicit(&(frame->pending), finished, memory_order_acq_rel) != finished)
+    {
+        return false;
+    }
+
+    callback(node);
+    thread->totalCallbacks++;
+    freeFrame(thread, frame);
+    return true;
+}
+void postOrderCompactMT(
+    Tree *root, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    TraversalTask *task = &(threadPool->task);
+    postOrderCompactMTGrain(task->compactNodes, task->compactRoot, task->compactCallback, 0, NULL, thread, threadPool);
+}
+void postOrderCompactMTStolen(
+    void *work, TreeCallback callback,
+    TraversalThread *thread, ThreadPool *threadPool
+)
+{
+    TraversalTask *task = &(threadPool->task);
+    PostOrderFrame *frame = (PostOrderFrame *) work;
+    uint32_t right = ((CompactTree *) frame->node)->right;
+    if (postOrderCompactMTGrain(task->compactNodes, right, task->compactCallback, 0, frame, thread, threadPool))
+    {
+        completeFrame(frame, thread, threadPool);
+    }
+}
+void postOrderCompactMTWrapper(CompactTree *nodes, uint32_t root, CompactCallback callback, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+    runCompactTraversalMT(threadPool, startArgs, postOrderCompactMT, postOrderCompactMTStolen, nodes, root, callback);
 }
 
 
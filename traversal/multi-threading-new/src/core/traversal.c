@@ -18,14 +18,38 @@
 *******************************************************************************/
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "types.h"
 #include "queue.h"
 
+/* how many pending subtrees ahead preOrderLookaheadCB prefetches */
+static int prefetchDistance = PREFETCH_DISTANCE;
 
 /******************************************************************************* 
 ------------------------------- HELPER FUNCTIONS -------------------------------
 *******************************************************************************/
+void initTreeBatch(TreeBatch *batch, TreeBatchCallback callback, void *ctx)
+{
+	batch->n		= 0;
+	batch->callback	= callback;
+	batch->ctx		= ctx;
+}
+
+void flushTreeBatch(TreeBatch *batch)
+{
+	if (batch->n > 0)
+	{
+		batch->callback(batch->nodes, batch->n, batch->ctx);
+		batch->n = 0;
+	}
+}
+
+void pushTreeBatch(TreeBatch *batch, Tree *node)
+{
+	if (batch->n == CALLBACK_BATCH_SIZE) flushTreeBatch(batch);
+	batch->nodes[(batch->n)++] = node;
+}
 
 
 
@@ -146,6 +170,242 @@ void contiguousOrderCB(Tree *treeArray, int N, TreeCallback callback)
 }
 
 
+
+/******************************************************************************* 
+------------------------- BATCHED CALLBACK TRAVERSALS --------------------------
+*******************************************************************************/
+void preOrderBatchFill(Tree *root, TreeBatch *batch)
+{
+	if (root != NULL)
+	{	
+		pushTreeBatch(batch, root);
+		preOrderBatchFill(root->left, batch);
+		preOrderBatchFill(root->right, batch);
+	}
+}
+
+void postOrderBatchFill(Tree *root, TreeBatch *batch)
+{
+	if (root != NULL)
+	{	
+		postOrderBatchFill(root->left, batch);
+		postOrderBatchFill(root->right, batch);
+		pushTreeBatch(batch, root);
+	}
+}
+
+void preOrderBatchCB(Tree *root, TreeBatchCallback callback, void *ctx)
+{
+	TreeBatch batch;
+	initTreeBatch(&batch, callback, ctx);
+	preOrderBatchFill(root, &batch);
+	flushTreeBatch(&batch);
+}
+
+void postOrderBatchCB(Tree *root, TreeBatchCallback callback, void *ctx)
+{
+	TreeBatch batch;
+	initTreeBatch(&batch, callback, ctx);
+	postOrderBatchFill(root, &batch);
+	flushTreeBatch(&batch);
+}
+
+void levelOrderBatchCB(Tree *root, TreeQueue *treeQueue, TreeBatchCallback callback, void *ctx)
+{
+	TreeBatch batch;
+	initTreeBatch(&batch, callback, ctx);
+	enQueueTQ(treeQueue, root);
+	while (!isEmptyTQ(treeQueue))
+	{
+		root = deQueueTQ(treeQueue);
+		if (root->left != NULL) enQueueTQ(treeQueue, root->left);
+		if (root->right != NULL) enQueueTQ(treeQueue, root->right);
+		pushTreeBatch(&batch, root);
+	}
+	flushTreeBatch(&batch);
+}
+
+void contiguousOrderBatchCB(Tree *treeArray, int N, TreeBatchCallback callback, void *ctx)
+{
+	TreeBatch batch;
+	initTreeBatch(&batch, callback, ctx);
+	int i;
+	for (i=0; i<N; i++, treeArray++)
+	{
+		pushTreeBatch(&batch, treeArray);
+	}
+	flushTreeBatch(&batch);
+}
+
+
+
+/******************************************************************************* 
+------------------------------ REDUCE TRAVERSALS -------------------------------
+*******************************************************************************/
+/* folds every node of the subtree into acc */
+int64_t preOrderReduce(Tree *root, ReduceOp *op, int64_t acc)
+{
+	if (root != NULL)
+	{
+		acc = op->combine(acc, op->map(root, op->ctx));
+		acc = preOrderReduce(root->left, op, acc);
+		acc = preOrderReduce(root->right, op, acc);
+	}
+	return acc;
+}
+
+void preOrderReduceAcc(Tree *root, ReduceAccOp *op, void *acc)
+{
+	if (root != NULL)
+	{
+		op->fold(acc, root, op->ctx);
+		preOrderReduceAcc(root->left, op, acc);
+		preOrderReduceAcc(root->right, op, acc);
+	}
+}
+
+/* first node in pre-order satisfying predicate, NULL if none */
+Tree * preOrderFind(Tree *root, TreePredicate predicate, void *ctx)
+{
+	Tree *match = NULL;
+	if (root != NULL)
+	{
+		if (predicate(root, ctx)) return root;
+		match = preOrderFind(root->left, predicate, ctx);
+		if (match == NULL) match = preOrderFind(root->right, predicate, ctx);
+	}
+	return match;
+}
+
+int64_t traverseReduceSerial(Tree *root, ReduceMap map, ReduceCombine combine, int64_t identity, void *ctx)
+{
+	ReduceOp op = {map, combine, identity, ctx};
+	return preOrderReduce(root, &op, identity);
+}
+
+
+
+/******************************************************************************* 
+---------------------------- PREFETCHING TRAVERSALS ----------------------------
+*******************************************************************************/
+void setPrefetchDistance(int distance)
+{
+	prefetchDistance = (distance > 0) ? distance : 1;
+}
+
+int getPrefetchDistance()
+{
+	return prefetchDistance;
+}
+
+/* both children are requested before the callback runs, so the right child is 
+	resident once the left subtree is done (prefetching NULL is harmless) */
+void preOrderPrefetchCB(Tree *root, TreeCallback callback)
+{
+	if (root != NULL)
+	{	
+		__builtin_prefetch(root->left);
+		__builtin_prefetch(root->right);
+		callback(root);
+		preOrderPrefetchCB(root->left, callback);
+		preOrderPrefetchCB(root->right, callback);
+	}
+}
+
+void postOrderPrefetchCB(Tree *root, TreeCallback callback)
+{
+	if (root != NULL)
+	{	
+		__builtin_prefetch(root->left);
+		__builtin_prefetch(root->right);
+		postOrderPrefetchCB(root->left, callback);
+		postOrderPrefetchCB(root->right, callback);
+		callback(root);
+	}
+}
+
+/* pre-order over an explicit stack of pending subtrees. Besides the children 
+	of the visited node, the subtree prefetchDistance pops ahead and its 
+	children (grandchildren of an already visited node) are requested, that 
+	subtree was prefetched when it was pushed so reading its pointers is cheap */
+void preOrderLookaheadCB(Tree *root, TreeCallback callback)
+{
+	int capacity = PREFETCH_STACK_SIZE, top = 0, distance = prefetchDistance;
+	Tree **stack, *ahead;
+
+	if (root == NULL) return;
+	stack = (Tree **) malloc(capacity * sizeof(Tree *));
+	stack[top++] = root;
+
+	while (top > 0)
+	{
+		root = stack[--top];
+		__builtin_prefetch(root->left);
+		__builtin_prefetch(root->right);
+		if (top >= distance)
+		{
+			ahead = stack[top - distance];
+			__builtin_prefetch(ahead->left);
+			__builtin_prefetch(ahead->right);
+		}
+
+		callback(root);
+
+		if (top + 2 > capacity)
+		{
+			capacity *= 2;
+			stack = (Tree **) realloc(stack, capacity * sizeof(Tree *));
+		}
+		if (root->right != NULL) stack[top++] = root->right;
+		if (root->left != NULL) stack[top++] = root->left;
+	}
+
+	free(stack);
+}
+
+
+
+/******************************************************************************* 
+------------------------------ COMPACT TRAVERSALS ------------------------------
+*******************************************************************************/
+void preOrderCompactCB(CompactTree *nodes, uint32_t root, CompactCallback callback)
+{
+	if (root != COMPACT_NULL)
+	{
+		CompactTree *node = nodes + root;
+		callback(node);
+		preOrderCompactCB(nodes, node->left, callback);
+		preOrderCompactCB(nodes, node->right, callback);
+	}
+}
+
+void postOrderCompactCB(CompactTree *nodes, uint32_t root, CompactCallback callback)
+{
+	if (root != COMPACT_NULL)
+	{
+		CompactTree *node = nodes + root;
+		postOrderCompactCB(nodes, node->left, callback);
+		postOrderCompactCB(nodes, node->right, callback);
+		callback(node);
+	}
+}
+
+/* every node is enqueued once, so a flat array of N indices replaces the ring */
+void levelOrderCompactCB(CompactTree *nodes, uint32_t root, uint32_t *queue, CompactCallback callback)
+{
+	uint32_t head = 0, tail = 0;
+	CompactTree *node;
+	queue[tail++] = root;
+	while (head < tail)
+	{
+		node = nodes + queue[head++];
+		if (node->left != COMPACT_NULL) queue[tail++] = node->left;
+		if (node->right != COMPACT_NULL) queue[tail++] = node->right;
+		callback(node);
+	}
+}
+
+
 /******************************************************************************* 
 --------------------------------- END OF FILE ----------------------------------
 *******************************************************************************/
\ No newline at end of file
@@ -0,0 +1,317 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file treeGenMT.c
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Multi-threaded tree generation: a serial skeleton splits the tree 
+ *  into independent subtrees (Catalan-distributed sizes for random trees, 
+ *  halves for balanced ones) that the thread pool generates and builds.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "types.h"
+#include "binaryTreeGen.h"
+#include "randStream.h"
+#include "threadpool.h"
+#include "treeGenMT.h"
+#include "util.h"
+
+
+
+/******************************************************************************* 
+------------------------------- HELPER FUNCTIONS -------------------------------
+*******************************************************************************/
+/* each piece gets a private stream seed so pieces can be generated in any 
+	order by any thread */
+void addPiece(TreeGenJob *job, int begin, int size, int base, int depth, RandStream *rng)
+{
+	GenPiece *piece;
+	if (job->numPieces == job->pieceCapacity)
+	{
+		job->pieceCapacity *= 2;
+		job->pieces = (GenPiece *) realloc(job->pieces, job->pieceCapacity * sizeof(GenPiece));
+	}
+	piece = job->pieces + (job->numPieces)++;
+	piece->begin	= begin;
+	piece->size		= size;
+	piece->base		= base;
+	piece->depth	= depth;
+	piece->seed		= randStreamNext(rng);
+	piece->height	= 0;
+	piece->leaves	= 0;
+}
+
+/* splits [0, N) until every subtree fits in grain nodes (split sizes and 
+	piece seeds come from rng). Split nodes are written straight away (entry 
+	base, children at begin+1 and begin+1+L) and the rest becomes pieces, a 
+	worklist keeps the walk iterative */
+void buildSkeleton(TreeGenJob *job, int N, int grain, RandStream *rng)
+{
+	int *stack = (int *) malloc(4 * 64 * sizeof(int));
+	int top = 0, capacity = 64;
+	int begin, size, base, depth, left;
+	Tree *node;
+
+	stack[top++] = 0; stack[top++] = N; stack[top++] = 0; stack[top++] = 0;
+	while (top > 0)
+	{
+		depth = stack[--top]; base = stack[--top]; size = stack[--top]; begin = stack[--top];
+		if (size <= grain)
+		{
+			if (size > 0) addPiece(job, begin, size, base, depth, rng);
+			continue;
+		}
+
+		left = job->balanced ? (size-1) / 2 : sampleCatalanSplit(size, randStreamReal(rng));
+		node = job->btNodeArray + begin;
+		node->id		= begin;
+		node->subtreeSize	= size;
+		node->data		= NULL;
+		node->left		= (left > 0) ? node + 1 : NULL;
+		node->right		= (size-1-left > 0) ? node + 1 + left : NULL;
+		job->invTable[begin] = base;
+
+		if (top + 8 > 4 * capacity)
+		{
+			capacity *= 2;
+			stack = (int *) realloc(stack, 4 * capacity * sizeof(int));
+		}
+		// right pushed first so pieces come out in pre-order
+		stack[top++] = begin+1+left; stack[top++] = size-1-left; stack[top++] = base; stack[top++] = depth+1;
+		stack[top++] = begin+1; stack[top++] = left; stack[top++] = base+1; stack[top++] = depth+1;
+	}
+
+	free(stack);
+}
+
+/* consecutive pieces of roughly N/numChunks nodes each */
+void buildChunks(TreeGenJob *job, int N, int numChunks)
+{
+	long target = ((long) N + numChunks - 1) / numChunks, filled = 0;
+	int i;
+
+	job->chunks = (GenChunk *) malloc((job->numPieces + 1) * sizeof(GenChunk));
+	job->numChunks = 0;
+	job->chunks[0].first = 0;
+	for (i=0; i<job->numPieces; i++)
+	{
+		filled += job->pieces[i].size;
+		if (filled >= target || i == job->numPieces-1)
+		{
+			job->chunks[job->numChunks].last = i+1;
+			job->numChunks++;
+			job->chunks[job->numChunks].first = i+1;
+			filled = 0;
+		}
+	}
+}
+
+/* inversion table of the piece (the random case is genInversionTable on a 
+	private stream), then the subtree is built in place and a backward pass 
+	(children follow their parent) gets heights and leaves, using the 
+	piece's ITNodes as scratch */
+void genPiece(TreeGenJob *job, GenPiece *piece)
+{
+	int *invTable = job->invTable + piece->begin;
+	Tree *btNodeArray = job->btNodeArray + piece->begin, *node;
+	ITNode *itNodeArray = job->itNodeArray + piece->begin;
+	RandStream rng = {piece->seed};
+	int i, j, left, right;
+
+	if (job->balanced)
+	{
+		for (i=0; (2 << i) - 1 < piece->size; i++);
+		genBalancedIT(invTable, i);
+	}
+	else
+	{
+		invTable[0] = 0;
+		for (j=1; j<piece->size; j++)
+		{
+			invTable[j] = assignUniform(piece->size, invTable[j-1], j, randStreamReal(&rng));
+		}
+	}
+
+	invTab2ContBTOptimized(invTable, btNodeArray, itNodeArray, piece->size);
+
+	piece->leaves = 0;
+	for (i=piece->size-1, node=btNodeArray+i; i>=0; i--, node--)
+	{
+		left = (node->left != NULL) ? itNodeArray[node->left - btNodeArray].val : -1;
+		right = (node->right != NULL) ? itNodeArray[node->right - btNodeArray].val : -1;
+		itNodeArray[i].val = 1 + ((left > right) ? left : right);
+		piece->leaves += (node->left == NULL && node->right == NULL);
+
+		invTable[i] += piece->base;
+		node->id += piece->begin;
+	}
+	piece->height = itNodeArray[0].val;
+}
+
+void runGenChunk(TreeGenJob *job, GenChunk *chunk, TraversalThread *thread)
+{
+	int i;
+	for (i=chunk->first; i<chunk->last; i++)
+	{
+		genPiece(job, job->pieces + i);
+		thread->totalCallbacks += job->pieces[i].size;
+	}
+}
+
+/* hands chunks 1..n-1 to thieves and runs the rest itself (as runLevelPhase) */
+void genTreeMT(
+	Tree *root, TreeCallback callback,
+	TraversalThread *thread, ThreadPool *threadPool
+)
+{
+	TreeGenJob *job = (TreeGenJob *) threadPool->task.jobCtx;
+	GenChunk *chunk;
+	int i;
+
+	for (i=1; i<job->numChunks; i++)
+	{
+		if (!pushDeque(&(thread->deque), job->chunks + i))
+		{
+			runGenChunk(job, job->chunks + i, thread);
+		}
+	}
+
+	runGenChunk(job, job->chunks, thread);
+	while ((chunk = (GenChunk *) popDeque(&(thread->deque))) != NULL)
+	{
+		runGenChunk(job, chunk, thread);
+	}
+}
+void genTreeMTStolen(
+	void *work, TreeCallback callback,
+	TraversalThread *thread, ThreadPool *threadPool
+)
+{
+	runGenChunk((TreeGenJob *) threadPool->task.jobCtx, (GenChunk *) work, thread);
+}
+
+TreeInfo runTreeGenJob(
+	TreeGenJob *job, int N, bool isBST,
+	ThreadPool *threadPool, StartThreadArgs *startArgs
+)
+{
+	TreeInfo treeInfo = {0};
+	int numChunks = GEN_CHUNKS_PER_THREAD * (threadPool->size + 1);
+	int grain = N / GEN_SKELETON_SPLIT;
+	int i;
+	GenPiece *piece;
+
+	job->numPieces = 0;
+	job->pieceCapacity = 64;
+	job->pieces = (GenPiece *) malloc(job->pieceCapacity * sizeof(GenPiece));
+	// skeleton is drawn from the main thread's stream (stream 0 for any size)
+	buildSkeleton(job, N, (grain > 0) ? grain : 1, &(threadPool->threads[threadPool->size].rng));
+	buildChunks(job, N, numChunks);
+
+	runJobMT(threadPool, startArgs, genTreeMT, genTreeMTStolen, job);
+
+	// every split node has a child, so leaves all sit inside pieces
+	treeInfo.size = N;
+	for (i=0, piece=job->pieces; i<job->numPieces; i++, piece++)
+	{
+		treeInfo.leaves += piece->leaves;
+		if (piece->depth + piece->height > treeInfo.depth) 
+		{
+			treeInfo.depth = piece->depth + piece->height;
+		}
+	}
+	treeInfo.density = treeDensity(treeInfo.size, treeInfo.leaves);
+	treeInfo.root = job->btNodeArray;
+	if (isBST) convert2BST(treeInfo.root);
+
+	free(job->pieces);
+	free(job->chunks);
+	return treeInfo;
+}
+
+
+
+/******************************************************************************* 
+------------------------------- PRIMARY EXPORTS --------------------------------
+*******************************************************************************/
+/* P(L=k) = C(k)C(n-1-k)/C(n) is symmetric and piles up at both ends, so half 
+	of x picks the side and the smaller subtree is found walking up from 0 
+	(the expected walk is O(sqrt(n))) */
+int sampleCatalanSplit(int n, double x)
+{
+	int k, m, last = n - 1;
+	bool flip = (x >= 0.5);
+	double target = flip ? x - 0.5 : x;
+	double p = (double) (n + 1) / (2.0 * (2.0*n - 1)), mass = 0;
+
+	for (k=0; 2*k < last; k++)
+	{
+		mass += p;
+		if (mass > target) return flip ? last - k : k;
+
+		// C(k+1)/C(k) * C(m-1)/C(m) with m the current right size
+		m = last - k;
+		p *= (2.0 * (2*k + 1) / (k + 2)) * ((m + 1) / (2.0 * (2*m - 1)));
+	}
+	return last / 2;
+}
+
+/* -------------------------------------------------------------------------- */
+
+TreeInfo genContRandomTreeMT(
+	int *invTable, Tree *btNodeArray, ITNode *itNodeArray, int N, bool isBST,
+	ThreadPool *threadPool, StartThreadArgs *startArgs
+)
+{
+	TreeGenJob job = {0};
+	if (N < GEN_MIN_PARALLEL)
+	{
+		return genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, N, isBST);
+	}
+
+	job.balanced	= false;
+	job.invTable	= invTable;
+	job.btNodeArray	= btNodeArray;
+	job.itNodeArray	= itNodeArray;
+	return runTreeGenJob(&job, N, isBST, threadPool, startArgs);
+}
+
+TreeInfo genContBalancedTreeMT(
+	int *invTable, Tree *btNodeArray, ITNode *itNodeArray, int depth, bool isBST,
+	ThreadPool *threadPool, StartThreadArgs *startArgs
+)
+{
+	TreeGenJob job = {0};
+	int N = (1<<(depth+1)) - 1;
+	if (N < GEN_MIN_PARALLEL)
+	{
+		return genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, isBST);
+	}
+
+	job.balanced	= true;
+	job.invTable	= invTable;
+	job.btNodeArray	= btNodeArray;
+	job.itNodeArray	= itNodeArray;
+	return runTreeGenJob(&job, N, isBST, threadPool, startArgs);
+}
+
+/* -------------------------------------------------------------------------- */
+
+
+
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
@@ -0,0 +1,193 @@
+/******************************************************************************* 
+------------------------------------- INFO -------------------------------------
+*******************************************************************************/
+/**
+ * @file treeLayout.c
+ * @author Mitchell Young (mgyoung@ncsu.edu)
+ * @brief Rewrites contiguous binary trees into BFS, van Emde Boas and blocked 
+ *  node orders, fixing up child pointers.
+ * @version 0.1
+ * @date 2022-03-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+
+/******************************************************************************* 
+------------------------------- IMPORTS & PARAMS -------------------------------
+*******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "types.h"
+#include "treeLayout.h"
+
+
+
+/******************************************************************************* 
+------------------------------- HELPER FUNCTIONS -------------------------------
+*******************************************************************************/
+void bfsOrder(Tree *root, Tree **order)
+{
+	int head = 0, tail = 0;
+	order[tail++] = root;
+	while (head < tail)
+	{
+		root = order[head++];
+		if (root->left != NULL) order[tail++] = root->left;
+		if (root->right != NULL) order[tail++] = root->right;
+	}
+}
+
+void vebOrder(Tree *root, int height, Tree **order, int *pos);
+
+/* lays out every bottom tree hanging off the top tree, left to right */
+void vebBottoms(Tree *root, int depth, int top, int rest, Tree **order, int *pos)
+{
+	if (root == NULL) return;
+	if (depth == top)
+	{
+		vebOrder(root, rest, order, pos);
+		return;
+	}
+	vebBottoms(root->left, depth+1, top, rest, order, pos);
+	vebBottoms(root->right, depth+1, top, rest, order, pos);
+}
+
+/* emits the nodes less than height levels below root: top half recursively, 
+	then each bottom half recursively */
+void vebOrder(Tree *root, int height, Tree **order, int *pos)
+{
+	if (root == NULL) return;
+	if (height == 1)
+	{
+		order[(*pos)++] = root;
+		return;
+	}
+
+	int top = height / 2;
+	vebOrder(root, top, order, pos);
+	vebBottoms(root, 0, top, height - top, order, pos);
+}
+
+/* one block is the first blockHeight levels in BFS order, then blocks below 
+	it follow depth first so a root-to-leaf path touches few blocks. the roots 
+	of pending blocks are stacked in below from *top (each node is a block 
+	root at most once, so N entries are enough) */
+void blockedOrder(Tree *root, int blockHeight, Tree **queue, Tree **below, int *top, Tree **order, int *pos)
+{
+	int head = 0, tail = 0, levelEnd, depth = 0;
+	queue[tail++] = root;
+	while (head < tail && depth < blockHeight)
+	{
+		levelEnd = tail;
+		for (; head<levelEnd; head++)
+		{
+			root = queue[head];
+			order[(*pos)++] = root;
+			if (root->left != NULL) queue[tail++] = root->left;
+			if (root->right != NULL) queue[tail++] = root->right;
+		}
+		depth++;
+	}
+
+	// queue[head..tail) are the roots of the next blocks, copy them off before recursing
+	int n = tail - head, first = *top;
+	memcpy(below + first, queue + head, n * sizeof(Tree *));
+	*top += n;
+	int i;
+	for (i=0; i<n; i++)
+	{
+		blockedOrder(below[first + i], blockHeight, queue, below, top, order, pos);
+	}
+	*top = first;
+}
+
+
+
+/******************************************************************************* 
+------------------------------- PRIMARY EXPORTS --------------------------------
+*******************************************************************************/
+int treeHeight(Tree *root)
+{
+	if (root == NULL) return 0;
+	int left = treeHeight(root->left);
+	int right = treeHeight(root->right);
+	return 1 + (left > right ? left : right);
+}
+
+const char * layoutName(TreeLayout layout)
+{
+	switch (layout)
+	{
+		case LAYOUT_BFS:		return "contiguous-bfs";
+		case LAYOUT_VEB:		return "contiguous-veb";
+		case LAYOUT_BLOCKED:	return "contiguous-blocked";
+		default:				return "contiguous";
+	}
+}
+
+/* rewrites the N nodes of btNodeArray (any contiguous order) so they appear in 
+	the given layout, returns the new root (always btNodeArray[0]) */
+Tree * relayoutContTree(Tree *root, Tree *btNodeArray, int N, TreeLayout layout)
+{
+	if (layout == LAYOUT_PREORDER) return root;
+
+	Tree **order = (Tree **) malloc(N * sizeof(Tree *));
+	Tree **queue;
+	int pos = 0, top = 0;
+	int blockHeight = 0;
+
+	switch (layout)
+	{
+		case LAYOUT_BFS:
+			bfsOrder(root, order);
+			break;
+		case LAYOUT_VEB:
+			vebOrder(root, treeHeight(root), order, &pos);
+			break;
+		case LAYOUT_BLOCKED:
+			// largest complete subtree that fits in a block
+			while ((int) (((2 << blockHeight) - 1) * sizeof(Tree)) <= LAYOUT_BLOCK_BYTES) blockHeight++;
+			// one scratch buffer: the BFS queue, then the stack of block roots
+			queue = (Tree **) malloc(2 * N * sizeof(Tree *));
+			blockedOrder(root, blockHeight, queue, queue + N, &top, order, &pos);
+			free(queue);
+			break;
+		default:
+			break;
+	}
+
+	// newIndex[old position] = new position, used to fix up child pointers
+	int *newIndex = (int *) malloc(N * sizeof(int));
+	int i;
+	for (i=0; i<N; i++)
+	{
+		newIndex[order[i] - btNodeArray] = i;
+	}
+	free(order);
+
+	Tree *old = (Tree *) malloc(N * sizeof(Tree));
+	memcpy(old, btNodeArray, N * sizeof(Tree));
+
+	Tree *src, *dst;
+	for (i=0, src=old; i<N; i++, src++)
+	{
+		dst = btNodeArray + newIndex[i];
+		*dst = *src;
+		if (src->left != NULL) dst->left = btNodeArray + newIndex[src->left - btNodeArray];
+		if (src->right != NULL) dst->right = btNodeArray + newIndex[src->right - btNodeArray];
+	}
+
+	Tree *newRoot = btNodeArray + newIndex[root - btNodeArray];
+	free(old);
+	free(newIndex);
+	return newRoot;
+}
+
+
+
+/******************************************************************************* 
+--------------------------------- END OF FILE ----------------------------------
+*******************************************************************************/
\ No newline at end of file
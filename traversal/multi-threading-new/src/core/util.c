@@ -18,6 +18,9 @@
 ------------------------------- IMPORTS & PARAMS -------------------------------
 *******************************************************************************/
 #include <math.h>
+#include <stdlib.h>
+
+#include "util.h"
 
 
 
@@ -53,6 +56,35 @@ float treeDensity(int N, int l)
 	}
 }
 
+/* n keys with Zipf(s) popularity over universe ranks, ranks are scattered 
+	over [0, universe) so the hot keys aren't neighbours in the tree */
+void genZipfKeys(int *keys, int n, int universe, double s)
+{
+	double *cdf = (double *) malloc(universe * sizeof(double));
+	double sum = 0, u;
+	int i, lo, hi, mid;
+
+	for (i=0; i<universe; i++)
+	{
+		sum += 1.0 / pow(i + 1, s);
+		cdf[i] = sum;
+	}
+	for (i=0; i<n; i++)
+	{
+		u = genrand64_real2() * sum;
+		for (lo=0, hi=universe-1; lo<hi; )
+		{
+			mid = (lo + hi) / 2;
+			if (cdf[mid] < u) lo = mid + 1;
+			else hi = mid;
+		}
+		keys[i] = (int) ((lo * 2654435761ULL) % universe);
+	}
+	free(cdf);
+}
+
+
+
 /******************************************************************************* 
 --------------------------------- END OF FILE ----------------------------------
 *******************************************************************************/
\ No newline at end of file
@@ -17,13 +17,20 @@
 ------------------------------- IMPORTS & PARAMS -------------------------------
 *******************************************************************************/
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "binaryTree.h"
 #include "binaryTreeGen.h"
+#include "nodeAlloc.h"
 #include "types.h"
 #include "queue.h"
+#include "searchArray.h"
+#include "soaTree.h"
 #include "threadpool.h"
+#include "treeGenMT.h"
+#include "treeLayout.h"
+#include "util.h"
 
 #include "exp.h"
 #include "timer.h"
@@ -38,11 +45,19 @@
 void traversalBatchMT(
 	int depth, int samples, TreeCallback callback, 
 	ThreadPool *threadPool, StartThreadArgs *startArgs,
+	GrainPolicy grainPolicy, int grainCutoff,
 	const char callbackName[], bool printResults, bool verbose
 )
 {
 	int N = (1<<(depth+1)) - 1;
 
+	char preOrderName[64], postOrderName[64], prefetchName[64], postPrefetchName[64];
+	snprintf(preOrderName, 64, "pre-order-%s-%d", grainPolicyName(grainPolicy), grainCutoff);
+	snprintf(prefetchName, 64, "pre-order-prefetch%d-%s-%d", getPrefetchDistance(), grainPolicyName(grainPolicy), grainCutoff);
+	snprintf(postOrderName, 64, "post-order-%s-%d", grainPolicyName(grainPolicy), grainCutoff);
+	snprintf(postPrefetchName, 64, "post-order-prefetch-%s-%d", grainPolicyName(grainPolicy), grainCutoff);
+	setGrainPolicy(threadPool, grainPolicy, grainCutoff);
+
 	int *invTable;
 	Tree *btNodeArray;
 	ITNode *itNodeArray;
@@ -58,26 +73,38 @@ void traversalBatchMT(
 	
 	TraversalFuncMTWrapper preOrderTraversalMT = &preOrderMTWrapper;
 	TraversalFuncMTWrapper postOrderTraversalMT = &postOrderMTWrapper;
+	TraversalFuncMTWrapper prefetchTraversalMT = &preOrderPrefetchMTWrapper;
+	TraversalFuncMTWrapper postPrefetchTraversalMT = &postOrderPrefetchMTWrapper;
 
 
-	// /* ---------------------------------------------------------------------- */
-	// /* --------------------- Random Tree with Callback ---------------------- */
-	// /* ---------------------------------------------------------------------- */
+	/* ---------------------------------------------------------------------- */
+	/* --------------------- Random Tree with Callback ---------------------- */
+	/* ---------------------------------------------------------------------- */
 
-	// treeInfo = genRandomTreeOptimized(invTable, itNodeArray, N, false);
+	treeInfo = genRandomTreeOptimized(invTable, itNodeArray, N, false);
 
-	// timeTraversalMT(
-	// 	treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
-	// 	samples, printResults, verbose,
-	// 	"random", "fragmented", "pre-order", callbackName
-	// );
-	// timeTraversalMT(
-	// 	treeInfo, postOrderTraversalMT, callback, threadPool, startArgs,
-	// 	samples, printResults, verbose, 
-	// 	"random", "fragmented", "post-order", callbackName
-	// );
+	timeTraversalMT(
+		treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"random", "fragmented", preOrderName, callbackName
+	);
+	timeTraversalMT(
+		treeInfo, postOrderTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"random", "fragmented", postOrderName, callbackName
+	);
+	timeTraversalMT(
+		treeInfo, prefetchTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"random", "fragmented", prefetchName, callbackName
+	);
+	timeTraversalMT(
+		treeInfo, postPrefetchTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"random", "fragmented", postPrefetchName, callbackName
+	);
 
-	// make_empty(treeInfo.root);
+	make_empty(treeInfo.root);
 
 	/* ---------------------------------------------------------------------- */
 	/* ---------------- Contiguous Random Tree with Callback ---------------- */
@@ -85,35 +112,76 @@ void traversalBatchMT(
 
 	treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, N, false);
 
-	// timeTraversalMT(
-	// 	treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
-	// 	samples, printResults, verbose, 
-	// 	"random", "contiguous", "pre-order", callbackName
-	// );
+	timeTraversalMT(
+		treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"random", "contiguous", preOrderName, callbackName
+	);
 	timeTraversalMT(
 		treeInfo, postOrderTraversalMT, callback, threadPool, startArgs,
 		samples, printResults, verbose, 
-		"random", "contiguous", "post-order", callbackName
+		"random", "contiguous", postOrderName, callbackName
+	);
+	timeTraversalMT(
+		treeInfo, prefetchTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"random", "contiguous", prefetchName, callbackName
+	);
+	timeTraversalMT(
+		treeInfo, postPrefetchTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"random", "contiguous", postPrefetchName, callbackName
 	);
 
-	// /* ---------------------------------------------------------------------- */
-	// /* -------------------- Balanced Tree with Callback --------------------- */
-	// /* ---------------------------------------------------------------------- */
+	/* ---------------------------------------------------------------------- */
+	/* --------- Relayout Contiguous Random Tree (BFS, vEB, Blocked) -------- */
+	/* ---------------------------------------------------------------------- */
 
-	// treeInfo = genBalancedTreeOptimized(invTable, itNodeArray, depth, false);
+	TreeLayout layout;
+	for (layout=LAYOUT_BFS; layout<=LAYOUT_BLOCKED; layout++)
+	{
+		treeInfo.root = relayoutContTree(treeInfo.root, btNodeArray, N, layout);
 
-	// timeTraversalMT(
-	// 	treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
-	// 	samples, printResults, verbose, 
-	// 	"balanced", "fragmented", "pre-order", callbackName
-	// );
-	// timeTraversalMT(
-	// 	treeInfo, postOrderTraversalMT, callback, threadPool, startArgs,
-	// 	samples, printResults, verbose, 
-	// 	"balanced", "fragmented", "post-order", callbackName
-	// );
+		// timeTraversalMT(
+		// 	treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
+		// 	samples, printResults, verbose, 
+		// 	"random", layoutName(layout), preOrderName, callbackName
+		// );
+		timeTraversalMT(
+			treeInfo, postOrderTraversalMT, callback, threadPool, startArgs,
+			samples, printResults, verbose, 
+			"random", layoutName(layout), postOrderName, callbackName
+		);
+	}
+
+	/* ---------------------------------------------------------------------- */
+	/* -------------------- Balanced Tree with Callback --------------------- */
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genBalancedTreeOptimized(invTable, itNodeArray, depth, false);
+
+	timeTraversalMT(
+		treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"balanced", "fragmented", preOrderName, callbackName
+	);
+	timeTraversalMT(
+		treeInfo, postOrderTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"balanced", "fragmented", postOrderName, callbackName
+	);
+	timeTraversalMT(
+		treeInfo, prefetchTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"balanced", "fragmented", prefetchName, callbackName
+	);
+	timeTraversalMT(
+		treeInfo, postPrefetchTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"balanced", "fragmented", postPrefetchName, callbackName
+	);
 
-	// make_empty(treeInfo.root);
+	make_empty(treeInfo.root);
 
 	// /* ---------------------------------------------------------------------- */
 	// /* --------------- Contiguous Balanced Tree with Callback --------------- */
@@ -124,16 +192,1044 @@ void traversalBatchMT(
 	// timeTraversalMT(
 	// 	treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
 	// 	samples, printResults, verbose, 
-	// 	"balanced", "contiguous", "pre-order", callbackName
+	// 	"balanced", "contiguous", preOrderName, callbackName
 	// );
 	// timeTraversalMT(
 	// 	treeInfo, postOrderTraversalMT, callback, threadPool, startArgs,
 	// 	samples, printResults, verbose, 
-	// 	"balanced", "contiguous", "post-order", callbackName
+	// 	"balanced", "contiguous", postOrderName, callbackName
 	// );
 
 	// /* ---------------------------------------------------------------------- */
 
+	setGrainPolicy(threadPool, GRAIN_NONE, 0);
+
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void scalingBatchMT(
+	int depth, int samples, int maxThreads, TreeCallback callback, 
+	const char callbackName[], bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+
+	TraversalFuncMTWrapper preOrderTraversalMT = &preOrderMTWrapper;
+	TraversalFuncMTWrapper postOrderTraversalMT = &postOrderMTWrapper;
+
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genRandomTreeOptimized(invTable, itNodeArray, N, false);
+	timeTraversalScaling(
+		treeInfo, preOrderTraversalMT, callback, maxThreads, samples, printResults, 
+		verbose, "random", "fragmented", "pre-order", callbackName
+	);
+	timeTraversalScaling(
+		treeInfo, postOrderTraversalMT, callback, maxThreads, samples, printResults, 
+		verbose, "random", "fragmented", "post-order", callbackName
+	);
+	make_empty(treeInfo.root);
+
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, N, false);
+	timeTraversalScaling(
+		treeInfo, preOrderTraversalMT, callback, maxThreads, samples, printResults, 
+		verbose, "random", "contiguous", "pre-order", callbackName
+	);
+	timeTraversalScaling(
+		treeInfo, postOrderTraversalMT, callback, maxThreads, samples, printResults, 
+		verbose, "random", "contiguous", "post-order", callbackName
+	);
+
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genBalancedTreeOptimized(invTable, itNodeArray, depth, false);
+	timeTraversalScaling(
+		treeInfo, preOrderTraversalMT, callback, maxThreads, samples, printResults, 
+		verbose, "balanced", "fragmented", "pre-order", callbackName
+	);
+	timeTraversalScaling(
+		treeInfo, postOrderTraversalMT, callback, maxThreads, samples, printResults, 
+		verbose, "balanced", "fragmented", "post-order", callbackName
+	);
+	make_empty(treeInfo.root);
+
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, false);
+	timeTraversalScaling(
+		treeInfo, preOrderTraversalMT, callback, maxThreads, samples, printResults, 
+		verbose, "balanced", "contiguous", "pre-order", callbackName
+	);
+	timeTraversalScaling(
+		treeInfo, postOrderTraversalMT, callback, maxThreads, samples, printResults, 
+		verbose, "balanced", "contiguous", "post-order", callbackName
+	);
+
+	/* ---------------------------------------------------------------------- */
+
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void poolBreakEvenBatch(
+	int minDepth, int maxDepth, int samples, TreeCallback callback, 
+	ThreadPool *threadPool, StartThreadArgs *startArgs,
+	const char callbackName[], bool printResults, bool verbose
+)
+{
+	int N = (1<<(maxDepth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+
+	TraversalFuncCB preOrderTraversalCB = &preOrderCB;
+	TraversalFuncMTWrapper preOrderTraversalMT = &preOrderMTWrapper;
+
+	bool wasPersistent = threadPool->persistent;
+
+	int depth;
+	for (depth=minDepth; depth<=maxDepth; depth++)
+	{
+		treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, false);
+
+		timeTraversalCB(
+			treeInfo, preOrderTraversalCB, callback, samples, printResults, verbose,
+			"balanced", "contiguous", "pre-order", callbackName
+		);
+
+		// spawn + join workers on every traversal
+		shutdownPersistentThreadPool(threadPool);
+		timeTraversalMT(
+			treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
+			samples, printResults, verbose, 
+			"balanced", "contiguous", "pre-order-mt-spawn", callbackName
+		);
+
+		// workers parked between traversals
+		launchPersistentThreadPool(threadPool, startArgs);
+		timeTraversalMT(
+			treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
+			samples, printResults, verbose, 
+			"balanced", "contiguous", "pre-order-mt-persistent", callbackName
+		);
+	}
+
+	if (!wasPersistent) shutdownPersistentThreadPool(threadPool);
+
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void layoutSearchBatch(
+	int depth, int numKeys, bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+
+	// same keys for every layout so only the node order changes
+	int *keys = (int *) malloc(numKeys * sizeof(int));
+	int i;
+	for (i=0; i<numKeys; i++)
+	{
+		keys[i] = (int) (genrand64_real2() * N);
+	}
+
+	TreeLayout layout;
+
+	/* ---------------------------------------------------------------------- */
+
+	for (layout=LAYOUT_PREORDER; layout<=LAYOUT_BLOCKED; layout++)
+	{
+		treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, N, true);
+		treeInfo.root = relayoutContTree(treeInfo.root, btNodeArray, N, layout);
+		timeFind(treeInfo, keys, numKeys, printResults, verbose, "random", layoutName(layout));
+	}
+
+	/* ---------------------------------------------------------------------- */
+
+	for (layout=LAYOUT_PREORDER; layout<=LAYOUT_BLOCKED; layout++)
+	{
+		treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, true);
+		treeInfo.root = relayoutContTree(treeInfo.root, btNodeArray, N, layout);
+		timeFind(treeInfo, keys, numKeys, printResults, verbose, "balanced", layoutName(layout));
+	}
+
+	/* ---------------------------------------------------------------------- */
+
+	free(keys);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void findBatchSweep(
+	int minDepth, int maxDepth, int numKeys, bool printResults, bool verbose
+)
+{
+	int maxN = (1<<(maxDepth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(maxN * sizeof(int));
+	btNodeArray = (Tree *) malloc(maxN * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(maxN * sizeof(ITNode)); 
+
+	int *keys = (int *) malloc(numKeys * sizeof(int));
+	int depth, group, i, N;
+
+	/* ---------------------------------------------------------------------- */
+
+	for (depth=minDepth; depth<=maxDepth; depth++)
+	{
+		N = (1<<(depth+1)) - 1;
+		for (i=0; i<numKeys; i++)
+		{
+			keys[i] = (int) (genrand64_real2() * N);
+		}
+
+		// fragmented like the tree searchTreeBenchmark uses, then contiguous
+		treeInfo = genBalancedTreeOptimized(invTable, itNodeArray, depth, true);
+		for (group=0; group<=FIND_BATCH_MAX_GROUP; group=(group == 0) ? 1 : group*2)
+		{
+			timeFindBatch(treeInfo, keys, numKeys, group, printResults, verbose, "balanced", "fragmented");
+		}
+		make_empty(treeInfo.root);
+
+		treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, true);
+		for (group=0; group<=FIND_BATCH_MAX_GROUP; group=(group == 0) ? 1 : group*2)
+		{
+			timeFindBatch(treeInfo, keys, numKeys, group, printResults, verbose, "balanced", "contiguous");
+		}
+	}
+
+	/* ---------------------------------------------------------------------- */
+
+	free(keys);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void searchStructureSweep(
+	int minDepth, int maxDepth, int numKeys, bool printResults, bool verbose
+)
+{
+	int maxN = (1<<(maxDepth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(maxN * sizeof(int));
+	btNodeArray = (Tree *) malloc(maxN * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(maxN * sizeof(ITNode)); 
+
+	SearchStructure structures[3] = {SEARCH_BST, SEARCH_EYTZINGER, SEARCH_BTREE};
+	int *keys = (int *) malloc(numKeys * sizeof(int));
+	int depth, s, i, N;
+
+	/* ---------------------------------------------------------------------- */
+
+	for (depth=minDepth; depth<=maxDepth; depth++)
+	{
+		N = (1<<(depth+1)) - 1;
+		for (i=0; i<numKeys; i++)
+		{
+			keys[i] = (int) (genrand64_real2() * N);
+		}
+
+		// the arrays don't depend on where the BST's nodes are, only find() does
+		treeInfo = genBalancedTreeOptimized(invTable, itNodeArray, depth, true);
+		for (s=0; s<3; s++)
+		{
+			timeSearchStructure(treeInfo, structures[s], keys, numKeys, printResults, verbose, "balanced", "fragmented");
+		}
+		make_empty(treeInfo.root);
+
+		treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, true);
+		timeSearchStructure(treeInfo, SEARCH_BST, keys, numKeys, printResults, verbose, "balanced", "contiguous");
+	}
+
+	/* ---------------------------------------------------------------------- */
+
+	free(keys);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void bstOpsBatch(int numKeys, bool printResults, bool verbose)
+{
+	int *keys = (int *) malloc(numKeys * sizeof(int));
+	const char *streams[3] = {"sorted", "random", "zipf"};
+	int s, i;
+
+	/* ---------------------------------------------------------------------- */
+
+	for (s=0; s<3; s++)
+	{
+		if (s == 0) for (i=0; i<numKeys; i++) keys[i] = i;
+		else if (s == 1) for (i=0; i<numKeys; i++) keys[i] = (int) (genrand64_real2() * numKeys);
+		else genZipfKeys(keys, numKeys, numKeys, 0.99);
+
+		timeBSTOps(keys, numKeys, BALANCE_NONE, printResults, verbose, streams[s]);
+		timeBSTOps(keys, numKeys, BALANCE_WEIGHT, printResults, verbose, streams[s]);
+	}
+
+	/* ---------------------------------------------------------------------- */
+
+	free(keys);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void concurrentBSTBatch(
+	int maxThreads, int numOps, int keyRange, bool printResults, bool verbose
+)
+{
+	int writePercents[4] = {0, 10, 50, 100};
+	int t, w;
+
+	/* ---------------------------------------------------------------------- */
+
+	for (t=1; t<=maxThreads; t++)
+	{
+		for (w=0; w<4; w++)
+		{
+			timeMixedBST(t, numOps, writePercents[w], keyRange, false, printResults, verbose);
+			timeMixedBST(t, numOps, writePercents[w], keyRange, true, printResults, verbose);
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+void bulkBSTBatch(
+	int numKeys, int batchSize, ThreadPool *threadPool, StartThreadArgs *startArgs, 
+	bool printResults, bool verbose
+)
+{
+	int *keys = (int *) malloc(numKeys * sizeof(int));
+	int *shuffled = (int *) malloc(numKeys * sizeof(int));
+	int *batch = (int *) malloc(batchSize * sizeof(int));
+	int i, j, tmp;
+
+	/* ---------------------------------------------------------------------- */
+
+	// even keys for the tree, the batch is spread over the odd ones between
+	for (i=0; i<numKeys; i++) keys[i] = shuffled[i] = 2*i;
+	for (i=numKeys-1; i>0; i--)
+	{
+		j = (int) (genrand64_real2() * (i+1));
+		tmp = shuffled[i];
+		shuffled[i] = shuffled[j];
+		shuffled[j] = tmp;
+	}
+	for (i=0; i<batchSize; i++) batch[i] = 2 * (int) ((long) i * numKeys / batchSize) + 1;
+
+	timeBulkBST(keys, shuffled, numKeys, batch, batchSize, threadPool, startArgs, printResults, verbose);
+
+	/* ---------------------------------------------------------------------- */
+
+	free(keys);
+	free(shuffled);
+	free(batch);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void searchStructureMT(
+	int depth, int searchDepth, int samples, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+
+	SearchStructure structures[3] = {SEARCH_BST, SEARCH_EYTZINGER, SEARCH_BTREE};
+	SearchStructure oldStructure = getSearchStructure();
+	int oldDepth = getSearchTreeDepth();
+	int s;
+
+	/* ---------------------------------------------------------------------- */
+
+	// the search tree is rebuilt for every structure and restored at the end
+	freeSearchTree();
+	setSearchTreeDepth(searchDepth);
+	treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, false);
+	for (s=0; s<3; s++)
+	{
+		setSearchStructure(structures[s]);
+		initSearchTree();
+		timeTraversalCB(
+			treeInfo, &preOrderCB, &searchTreeBenchmark, samples, printResults, 
+			verbose, "balanced", searchStructureName(structures[s]), "pre-order", "tree-search"
+		);
+		timeTraversalMT(
+			treeInfo, &preOrderMTWrapper, &searchTreeBenchmark, threadPool, startArgs,
+			samples, printResults, verbose, 
+			"balanced", searchStructureName(structures[s]), "pre-order-mt", "tree-search"
+		);
+		freeSearchTree();
+	}
+	setSearchStructure(oldStructure);
+	setSearchTreeDepth(oldDepth);
+	initSearchTree();
+
+	/* ---------------------------------------------------------------------- */
+
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void levelOrderBatchMT(
+	int depth, int samples, TreeCallback callback, 
+	ThreadPool *threadPool, StartThreadArgs *startArgs,
+	const char callbackName[], bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+
+	TreeQueue tq = {0};
+	TreeQueue *treeQueue = &tq;
+	initTQ(treeQueue, N);
+
+	TraversalFuncLevelCB levelOrderTraversalCB = &levelOrderCB;
+	TraversalFuncMTWrapper preOrderTraversalMT = &preOrderMTWrapper;
+	TraversalFuncMTWrapper levelOrderTraversalMT = &levelOrderMTWrapper;
+
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genBalancedTreeOptimized(invTable, itNodeArray, depth, false);
+	timeTraversalLevelCB(
+		treeInfo, treeQueue, levelOrderTraversalCB, callback, samples, printResults, 
+		verbose, "balanced", "fragmented", "level-order", callbackName
+	);
+	timeTraversalMT(
+		treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"balanced", "fragmented", "pre-order-mt", callbackName
+	);
+	timeTraversalMT(
+		treeInfo, levelOrderTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"balanced", "fragmented", "level-order-mt", callbackName
+	);
+	make_empty(treeInfo.root);
+
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, false);
+	timeTraversalLevelCB(
+		treeInfo, treeQueue, levelOrderTraversalCB, callback, samples, printResults, 
+		verbose, "balanced", "contiguous", "level-order", callbackName
+	);
+	timeTraversalMT(
+		treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"balanced", "contiguous", "pre-order-mt", callbackName
+	);
+	timeTraversalMT(
+		treeInfo, levelOrderTraversalMT, callback, threadPool, startArgs,
+		samples, printResults, verbose, 
+		"balanced", "contiguous", "level-order-mt", callbackName
+	);
+
+	/* ---------------------------------------------------------------------- */
+
+	freeTQ(treeQueue);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void compactBatchMT(
+	int depth, int samples, TreeCallback callback, CompactCallback compactCallback,
+	ThreadPool *threadPool, StartThreadArgs *startArgs,
+	const char callbackName[], bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	CompactTree *ctNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+	uint32_t root;
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	ctNodeArray = (CompactTree *) malloc(N * sizeof(CompactTree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+	uint32_t *queue = (uint32_t *) malloc(N * sizeof(uint32_t));
+
+	TreeQueue tq = {0};
+	TreeQueue *treeQueue = &tq;
+	initTQ(treeQueue, N);
+
+	TraversalFuncCB preOrderTraversalCB = &preOrderCB;
+	TraversalFuncCB postOrderTraversalCB = &postOrderCB;
+	TraversalFuncLevelCB levelOrderTraversalCB = &levelOrderCB;
+	TraversalFuncMTWrapper preOrderTraversalMT = &preOrderMTWrapper;
+	TraversalFuncMTWrapper postOrderTraversalMT = &postOrderMTWrapper;
+	TraversalFuncCompactCB preOrderTraversalCompact = &preOrderCompactCB;
+	TraversalFuncCompactCB postOrderTraversalCompact = &postOrderCompactCB;
+	TraversalFuncCompactLevelCB levelOrderTraversalCompact = &levelOrderCompactCB;
+	TraversalFuncCompactMTWrapper preOrderTraversalCompactMT = &preOrderCompactMTWrapper;
+	TraversalFuncCompactMTWrapper postOrderTraversalCompactMT = &postOrderCompactMTWrapper;
+
+	const char *treeTypes[2] = {"random", "balanced"};
+	int t;
+
+	/* ---------------------------------------------------------------------- */
+
+	// same tree shape in both storages, only the node format changes
+	for (t=0; t<2; t++)
+	{
+		if (t == 0) treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, N, false);
+		else treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, false);
+		root = contTree2Compact(treeInfo.root, btNodeArray, ctNodeArray, N);
+
+		timeTraversalCB(
+			treeInfo, preOrderTraversalCB, callback, samples, printResults, 
+			verbose, treeTypes[t], "contiguous", "pre-order", callbackName
+		);
+		timeTraversalCompactCB(
+			treeInfo, ctNodeArray, root, preOrderTraversalCompact, compactCallback, 
+			samples, printResults, verbose, treeTypes[t], "compact", "pre-order", callbackName
+		);
+		timeTraversalCB(
+			treeInfo, postOrderTraversalCB, callback, samples, printResults, 
+			verbose, treeTypes[t], "contiguous", "post-order", callbackName
+		);
+		timeTraversalCompactCB(
+			treeInfo, ctNodeArray, root, postOrderTraversalCompact, compactCallback, 
+			samples, printResults, verbose, treeTypes[t], "compact", "post-order", callbackName
+		);
+		timeTraversalLevelCB(
+			treeInfo, treeQueue, levelOrderTraversalCB, callback, samples, printResults, 
+			verbose, treeTypes[t], "contiguous", "level-order", callbackName
+		);
+		timeTraversalCompactLevelCB(
+			treeInfo, ctNodeArray, root, queue, levelOrderTraversalCompact, compactCallback, 
+			samples, printResults, verbose, treeTypes[t], "compact", "level-order", callbackName
+		);
+		timeTraversalMT(
+			treeInfo, preOrderTraversalMT, callback, threadPool, startArgs,
+			samples, printResults, verbose, 
+			treeTypes[t], "contiguous", "pre-order-mt", callbackName
+		);
+		timeTraversalCompactMT(
+			treeInfo, ctNodeArray, root, preOrderTraversalCompactMT, compactCallback, 
+			threadPool, startArgs, samples, printResults, verbose, 
+			treeTypes[t], "compact", "pre-order-mt", callbackName
+		);
+		timeTraversalMT(
+			treeInfo, postOrderTraversalMT, callback, threadPool, startArgs,
+			samples, printResults, verbose, 
+			treeTypes[t], "contiguous", "post-order-mt", callbackName
+		);
+		timeTraversalCompactMT(
+			treeInfo, ctNodeArray, root, postOrderTraversalCompactMT, compactCallback, 
+			threadPool, startArgs, samples, printResults, verbose, 
+			treeTypes[t], "compact", "post-order-mt", callbackName
+		);
+	}
+
+	/* ---------------------------------------------------------------------- */
+
+	freeTQ(treeQueue);
+	free(queue);
+	free(invTable);
+	free(btNodeArray);
+	free(ctNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void soaBatch(
+	int depth, int samples, bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	SoATree soaTree;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+	initSoATree(&soaTree, N);
+
+	TraversalFuncCB preOrderTraversalCB = &preOrderCB;
+	TraversalFuncContCB contiguousOrderTraversalCB = &contiguousOrderCB;
+
+	// matching per-node callbacks and bulk kernels
+	TreeCallback callbacks[3] = {&incrementID, &searchKey, &randArray};
+	SoAKernel kernels[3] = {&soaIncrementID, &soaSearchKey, &soaRandArray};
+	const char *callbackNames[3] = {"increment-id", "search-id", "randArray"};
+	const char *treeTypes[2] = {"random", "balanced"};
+
+	char bulkName[32];
+	snprintf(bulkName, sizeof(bulkName), "bulk-%s", soaSimdName());
+
+	int t, c;
+
+	/* ---------------------------------------------------------------------- */
+
+	for (t=0; t<2; t++)
+	{
+		if (t == 0) treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, N, false);
+		else treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, false);
+
+		for (c=0; c<3; c++)
+		{
+			timeTraversalCB(
+				treeInfo, preOrderTraversalCB, callbacks[c], samples, printResults, 
+				verbose, treeTypes[t], "contiguous", "pre-order", callbackNames[c]
+			);
+			timeTraversalContCB(
+				treeInfo, btNodeArray, contiguousOrderTraversalCB, callbacks[c], samples, 
+				printResults, verbose, treeTypes[t], "contiguous", "contiguous-order", callbackNames[c]
+			);
+		}
+
+		if (t == 0) treeInfo = genSoARandomTree(invTable, &soaTree, itNodeArray, N, false);
+		else treeInfo = genSoABalancedTree(invTable, &soaTree, itNodeArray, depth, false);
+
+		for (c=0; c<3; c++)
+		{
+			timeSoAKernel(
+				treeInfo, &soaTree, kernels[c], samples, printResults, verbose, 
+				treeTypes[t], "soa", bulkName, callbackNames[c]
+			);
+		}
+		timeSoAKernel(
+			treeInfo, &soaTree, &soaIncrementIDScalar, samples, printResults, verbose, 
+			treeTypes[t], "soa", "bulk-scalar", "increment-id"
+		);
+	}
+
+	/* ---------------------------------------------------------------------- */
+
+	freeSoATree(&soaTree);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void callbackBatchMT(
+	int depth, int samples, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+
+	TreeQueue tq = {0};
+	TreeQueue *treeQueue = &tq;
+	initTQ(treeQueue, N);
+
+	TraversalFuncCB preOrderTraversalCB = &preOrderCB;
+	TraversalFuncCB postOrderTraversalCB = &postOrderCB;
+	TraversalFuncLevelCB levelOrderTraversalCB = &levelOrderCB;
+	TraversalFuncContCB contiguousOrderTraversalCB = &contiguousOrderCB;
+	TraversalFuncMTWrapper preOrderTraversalMT = &preOrderMTWrapper;
+	TraversalFuncMTWrapper levelOrderTraversalMT = &levelOrderMTWrapper;
+	TraversalFuncBatchCB preOrderTraversalBatch = &preOrderBatchCB;
+	TraversalFuncBatchCB postOrderTraversalBatch = &postOrderBatchCB;
+	TraversalFuncLevelBatchCB levelOrderTraversalBatch = &levelOrderBatchCB;
+	TraversalFuncContBatchCB contiguousOrderTraversalBatch = &contiguousOrderBatchCB;
+	TraversalFuncBatchMTWrapper preOrderTraversalBatchMT = &preOrderBatchMTWrapper;
+	TraversalFuncBatchMTWrapper levelOrderTraversalBatchMT = &levelOrderBatchMTWrapper;
+
+	// per-node callbacks and their batched versions (search-tree needs initSearchTree)
+	TreeCallback callbacks[4] = {&incrementID, &searchKey, &randArray, &searchTreeBenchmark};
+	TreeBatchCallback batchCallbacks[4] = {&incrementIDBatch, &searchKeyBatch, &randArrayBatch, &searchTreeBenchmarkBatch};
+	const char *callbackNames[4] = {"increment-id", "search-id", "randArray", "tree-search"};
+	const char *batchNames[4] = {"increment-id-batch", "search-id-batch", "randArray-batch", "tree-search-batch"};
+	const char *treeTypes[2] = {"random", "balanced"};
+
+	int t, c, key = N / 2;
+	int64_t result;
+
+	/* ---------------------------------------------------------------------- */
+
+	for (t=0; t<2; t++)
+	{
+		if (t == 0) treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, N, false);
+		else treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, false);
+
+		for (c=0; c<4; c++)
+		{
+			timeTraversalCB(
+				treeInfo, preOrderTraversalCB, callbacks[c], samples, printResults, 
+				verbose, treeTypes[t], "contiguous", "pre-order", callbackNames[c]
+			);
+			timeTraversalBatchCB(
+				treeInfo, preOrderTraversalBatch, batchCallbacks[c], NULL, samples, printResults, 
+				verbose, treeTypes[t], "contiguous", "pre-order", batchNames[c]
+			);
+			timeTraversalCB(
+				treeInfo, postOrderTraversalCB, callbacks[c], samples, printResults, 
+				verbose, treeTypes[t], "contiguous", "post-order", callbackNames[c]
+			);
+			timeTraversalBatchCB(
+				treeInfo, postOrderTraversalBatch, batchCallbacks[c], NULL, samples, printResults, 
+				verbose, treeTypes[t], "contiguous", "post-order", batchNames[c]
+			);
+			timeTraversalLevelCB(
+				treeInfo, treeQueue, levelOrderTraversalCB, callbacks[c], samples, printResults, 
+				verbose, treeTypes[t], "contiguous", "level-order", callbackNames[c]
+			);
+			timeTraversalLevelBatchCB(
+				treeInfo, treeQueue, levelOrderTraversalBatch, batchCallbacks[c], NULL, samples, 
+				printResults, verbose, treeTypes[t], "contiguous", "level-order", batchNames[c]
+			);
+			timeTraversalContCB(
+				treeInfo, btNodeArray, contiguousOrderTraversalCB, callbacks[c], samples, 
+				printResults, verbose, treeTypes[t], "contiguous", "contiguous-order", callbackNames[c]
+			);
+			timeTraversalContBatchCB(
+				treeInfo, btNodeArray, contiguousOrderTraversalBatch, batchCallbacks[c], NULL, samples, 
+				printResults, verbose, treeTypes[t], "contiguous", "contiguous-order", batchNames[c]
+			);
+			timeTraversalMT(
+				treeInfo, preOrderTraversalMT, callbacks[c], threadPool, startArgs,
+				samples, printResults, verbose, 
+				treeTypes[t], "contiguous", "pre-order-mt", callbackNames[c]
+			);
+			timeTraversalBatchMT(
+				treeInfo, preOrderTraversalBatchMT, batchCallbacks[c], NULL, threadPool, startArgs,
+				samples, printResults, verbose, 
+				treeTypes[t], "contiguous", "pre-order-mt", batchNames[c]
+			);
+			timeTraversalMT(
+				treeInfo, levelOrderTraversalMT, callbacks[c], threadPool, startArgs,
+				samples, printResults, verbose, 
+				treeTypes[t], "contiguous", "level-order-mt", callbackNames[c]
+			);
+			timeTraversalBatchMT(
+				treeInfo, levelOrderTraversalBatchMT, batchCallbacks[c], NULL, threadPool, startArgs,
+				samples, printResults, verbose, 
+				treeTypes[t], "contiguous", "level-order-mt", batchNames[c]
+			);
+		}
+
+		// race-free reduce versions of search-id and a node count
+		timeReduceMT(
+			treeInfo, &matchKeyMap, &addCombine, 0, &key, &result, threadPool, startArgs,
+			samples, printResults, verbose, 
+			treeTypes[t], "contiguous", "pre-order-reduce", "search-id"
+		);
+		timeReduceMT(
+			treeInfo, &countMap, &addCombine, 0, NULL, &result, threadPool, startArgs,
+			samples, printResults, verbose, 
+			treeTypes[t], "contiguous", "pre-order-reduce", "count"
+		);
+	}
+
+	/* ---------------------------------------------------------------------- */
+
+	freeTQ(treeQueue);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void allocatorBatch(
+	int depth, int samples, TreeCallback callback, 
+	const char callbackName[], bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+
+	int *invTable;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+	NodeAllocator allocator;
+
+	invTable = (int *) malloc(N * sizeof(int));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+
+	TraversalFuncCB preOrderTraversalCB = &preOrderCB;
+
+	// shuffled slabs hold the whole tree so placement can spread over all of it
+	NodeAllocMode modes[6] = {ALLOC_MALLOC, ALLOC_ARENA, ALLOC_POOL, ALLOC_SHUFFLED, ALLOC_SHUFFLED, ALLOC_SHUFFLED};
+	double degrees[6] = {0, 0, 0, 0.1, 0.5, 1.0};
+	const char *treeTypes[2] = {"random", "balanced"};
+
+	char storageName[64];
+	int t, m;
+
+	/* ---------------------------------------------------------------------- */
+
+	for (t=0; t<2; t++)
+	{
+		if (t == 0) treeInfo = genRandomTreeOptimized(invTable, itNodeArray, N, false);
+		else treeInfo = genBalancedTreeOptimized(invTable, itNodeArray, depth, false);
+		make_empty(treeInfo.root);
+
+		for (m=0; m<6; m++)
+		{
+			initNodeAllocator(&allocator, modes[m], (modes[m] == ALLOC_SHUFFLED) ? N : 0, degrees[m]);
+			setNodeAllocator(&allocator);
+			if (modes[m] == ALLOC_SHUFFLED) snprintf(storageName, 64, "shuffled-%.2f", degrees[m]);
+			else snprintf(storageName, 64, "%s", nodeAllocModeName(modes[m]));
+
+			timeTreeBuild(
+				treeInfo, invTable, itNodeArray, samples, 
+				printResults, verbose, treeTypes[t], storageName
+			);
+
+			treeInfo.root = invTab2BTOptimized(invTable, itNodeArray, N);
+			timeTraversalCB(
+				treeInfo, preOrderTraversalCB, callback, samples, printResults, 
+				verbose, treeTypes[t], storageName, "pre-order", callbackName
+			);
+			make_empty(treeInfo.root);
+
+			destroyNodeAllocator(&allocator);
+		}
+	}
+
+	/* ---------------------------------------------------------------------- */
+
+	setNodeAllocator(NULL);
+	free(invTable);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void findFirstBatchMT(
+	int depth, int numKeys, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+
+	int *keys = (int *) malloc(numKeys * sizeof(int));
+	const char *treeTypes[2] = {"random", "balanced"};
+	int i, t;
+	int64_t result;
+	for (i=0; i<numKeys; i++)
+	{
+		keys[i] = (int) (genrand64_real2() * N);
+	}
+
+	/* ---------------------------------------------------------------------- */
+
+	for (t=0; t<2; t++)
+	{
+		if (t == 0) treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, N, false);
+		else treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, false);
+
+		// a full traversal costs the same for every key
+		timeReduceMT(
+			treeInfo, &matchKeyMap, &addCombine, 0, keys, &result, threadPool, startArgs,
+			numKeys, printResults, verbose, 
+			treeTypes[t], "contiguous", "pre-order-reduce", "search-id"
+		);
+		timeFindFirst(
+			treeInfo, keys, numKeys, NULL, NULL, printResults, verbose, 
+			treeTypes[t], "contiguous", "find-first"
+		);
+		timeFindFirst(
+			treeInfo, keys, numKeys, threadPool, startArgs, printResults, verbose, 
+			treeTypes[t], "contiguous", "find-first-mt"
+		);
+	}
+
+	/* ---------------------------------------------------------------------- */
+
+	free(keys);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void blockingBatchMT(
+	int depth, int samples, int maxSpares, ThreadPool *threadPool, 
+	StartThreadArgs *startArgs, bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo; 
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+
+	char traversalName[32];
+	int spares;
+
+	/* ---------------------------------------------------------------------- */
+
+	treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, depth, false);
+	for (spares=0; spares<=maxSpares; spares=(spares == 0) ? 1 : spares*2)
+	{
+		setBlockingLimit(threadPool, spares);
+		snprintf(traversalName, sizeof(traversalName), "pre-order-spares-%d", spares);
+		timeTraversalMT(
+			treeInfo, &preOrderMTWrapper, &sleepNode, threadPool, startArgs,
+			samples, printResults, verbose, "balanced", "contiguous", 
+			traversalName, "sleep"
+		);
+	}
+	setBlockingLimit(threadPool, 0);
+
+	/* ---------------------------------------------------------------------- */
+
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void genBatchMT(
+	int depth, int samples, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	bool printResults, bool verbose
+)
+{
+	int N = (1<<(depth+1)) - 1;
+
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+
+	invTable = (int *) malloc(N * sizeof(int));
+	btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(N * sizeof(ITNode)); 
+
+	/* ---------------------------------------------------------------------- */
+
+	timeContTreeGen(
+		&genContRandomTreeOptimized, NULL, N, invTable, btNodeArray, itNodeArray, 
+		threadPool, startArgs, samples, printResults, verbose, "random", "gen-serial"
+	);
+	timeContTreeGen(
+		NULL, &genContRandomTreeMT, N, invTable, btNodeArray, itNodeArray, 
+		threadPool, startArgs, samples, printResults, verbose, "random", "gen-mt"
+	);
+	setRandomTreeGen(RANDOM_GEN_DYCK);
+	timeContTreeGen(
+		&genContRandomTreeOptimized, NULL, N, invTable, btNodeArray, itNodeArray, 
+		threadPool, startArgs, samples, printResults, verbose, "random", "gen-dyck"
+	);
+	setRandomTreeGen(RANDOM_GEN_INVTABLE);
+	timeContTreeGen(
+		&genContBalancedTreeOptimized, NULL, depth, invTable, btNodeArray, itNodeArray, 
+		threadPool, startArgs, samples, printResults, verbose, "balanced", "gen-serial"
+	);
+	timeContTreeGen(
+		NULL, &genContBalancedTreeMT, depth, invTable, btNodeArray, itNodeArray, 
+		threadPool, startArgs, samples, printResults, verbose, "balanced", "gen-mt"
+	);
+
+	/* ---------------------------------------------------------------------- */
+
 	free(invTable);
 	free(btNodeArray);
 	free(itNodeArray);
@@ -19,6 +19,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "binaryTree.h"
 #include "threadpool.h"
@@ -58,9 +59,21 @@ int main(int argc, char *argv[])
 	bool printResults = true;
 	bool verbose = false;
 
-	ThreadPool *threadPool = (ThreadPool *) malloc(sizeof(ThreadPool));
-	StartThreadArgs *startArgs = (StartThreadArgs *) malloc((NUM_THREADS-1) * sizeof(StartThreadArgs));
-	initThreadPool(threadPool, startArgs, NUM_THREADS-1);
+	// usage: exp [scale] [-t numThreads] (or set TREE_NUM_THREADS)
+	int numThreads = getNumThreads(argc, argv);
+	bool scaleMode = false;
+	int a;
+	for (a=1; a<argc; a++)
+	{
+		if (strcmp(argv[a], "scale") == 0) scaleMode = true;
+	}
+
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	initThreadPool(threadPool, startArgs, numThreads-1);
+
+	// keep workers alive between traversals so timings exclude thread startup
+	launchPersistentThreadPool(threadPool, startArgs);
 
 	/* ---------------------------------------------------------------------- */
 	int depth, i, runs;
@@ -79,36 +92,126 @@ int main(int argc, char *argv[])
 			// else 					{runs = 1;}
 			runs = 1;
 
+			if (scaleMode)
+			{
+				scalingBatchMT(
+					depth, runs, numThreads, incrementCallback,
+					"increment-id", printResults, verbose
+				);
+				scalingBatchMT(
+					depth, runs, numThreads, searchCallback,
+					"search-id", printResults, verbose
+				);
+				scalingBatchMT(
+					depth, runs, numThreads, randCallback,
+					"randArray", printResults, verbose
+				);
+				scalingBatchMT(
+					depth, runs, numThreads, searchTreeCallback,
+					"tree-search", printResults, verbose
+				);
+				// scalingBatchMT(
+				// 	depth, runs, numThreads, sleepCallback,
+				// 	"sleep", printResults, verbose
+				// );
+				continue;
+			}
+
 			// traversalBatch(depth, runs, printResults, verbose);
 
-			// traversalBatchMT(
+			// // random trees are thousands of levels deep, keep the key count modest
+			// layoutSearchBatch(depth, 100000, printResults, verbose);
+
+			// findBatchSweep(10, depth, 1000000, printResults, verbose);
+
+			// searchStructureSweep(10, depth, 1000000, printResults, verbose);
+			// searchStructureMT(depth, 20, runs, threadPool, startArgs, printResults, verbose);
+
+			// // sorted keys turn the unbalanced BST into a list, keep it small
+			// bstOpsBatch(20000, printResults, verbose);
+
+			// concurrentBSTBatch(numThreads, 1000000, 1<<depth, printResults, verbose);
+
+			// bulkBSTBatch(1<<depth, 1<<(depth-2), threadPool, startArgs, printResults, verbose);
+
+			// levelOrderBatchMT(
 			// 	depth, runs, incrementCallback, threadPool, startArgs,
 			// 	"increment-id", printResults, verbose
 			// );
 
+			// soaBatch(depth, runs, printResults, verbose);
+
+			// callbackBatchMT(depth, runs, threadPool, startArgs, printResults, verbose);
+
+			// allocatorBatch(depth, runs, incrementCallback, "increment-id", printResults, verbose);
+
+			// genBatchMT(depth, runs, threadPool, startArgs, printResults, verbose);
+
+			// findFirstBatchMT(depth, runs, threadPool, startArgs, printResults, verbose);
+
+			// // sleep callbacks are slow, keep the tree small
+			// blockingBatchMT(14, runs, POOL_MAX_SPARE_THREADS, threadPool, startArgs, printResults, verbose);
+
+			// compactBatchMT(
+			// 	depth, runs, incrementCallback, &incrementIDCompact, 
+			// 	threadPool, startArgs, "increment-id", printResults, verbose
+			// );
+
+			// poolBreakEvenBatch(
+			// 	4, 16, 1000, incrementCallback, threadPool, startArgs,
+			// 	"increment-id", printResults, verbose
+			// );
+
+			// traversalBatchMT(
+			// 	depth, runs, incrementCallback, threadPool, startArgs,
+			// 	GRAIN_NONE, 0, "increment-id", printResults, verbose
+			// );
+
+			// // grain-size sweep, cheap callbacks want a much larger cutoff than sleep
+			// int grain;
+			// for (grain=16; grain<=(1<<16); grain*=4)
+			// {
+			// 	traversalBatchMT(
+			// 		depth, runs, incrementCallback, threadPool, startArgs,
+			// 		GRAIN_SIZE, grain, "increment-id", printResults, verbose
+			// 	);
+			// }
+
 			traversalBatchMT(
 				depth, runs, searchCallback, threadPool, startArgs,
-				"search-id", printResults, verbose
+				GRAIN_NONE, 0, "search-id", printResults, verbose
 			);
 
+			// // prefetch-distance sweep, compare against the pre-order rows above
+			// int distance;
+			// for (distance=1; distance<=16; distance*=2)
+			// {
+			// 	setPrefetchDistance(distance);
+			// 	traversalBatchMT(
+			// 		depth, runs, searchCallback, threadPool, startArgs,
+			// 		GRAIN_NONE, 0, "search-id", printResults, verbose
+			// 	);
+			// }
+			// setPrefetchDistance(PREFETCH_DISTANCE);
+
 			// traversalBatchMT(
 			// 	depth, runs, printCallback, threadPool, startArgs,
-			// 	"print-id", printResults, verbose
+			// 	GRAIN_NONE, 0, "print-id", printResults, verbose
 			// );
 
 			// traversalBatchMT(
 			// 	depth, runs, randCallback, threadPool, startArgs,
-			// 	"randArray", printResults, verbose
+			// 	GRAIN_NONE, 0, "randArray", printResults, verbose
 			// );
 
 			// traversalBatchMT(
 			// 	depth, runs, sleepCallback, threadPool, startArgs,
-			// 	"sleep", printResults, verbose
+			// 	GRAIN_NONE, 0, "sleep", printResults, verbose
 			// );
 
 			// traversalBatchMT(
 			// 	depth, runs, searchTreeCallback, threadPool, startArgs,
-			// 	"tree-search", printResults, verbose
+			// 	GRAIN_NONE, 0, "tree-search", printResults, verbose
 			// );
 		}
 	}
@@ -18,12 +18,22 @@
 *******************************************************************************/
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <sys/time.h>
 
 #include "types.h"
+#include "binaryTree.h"
+#include "binaryTreeGen.h"
+#include "bulkBST.h"
+#include "concurrentTree.h"
+#include "nodeAlloc.h"
 #include "queue.h"
+#include "randStream.h"
+#include "searchArray.h"
 #include "threadpool.h"
+#include "treeLayout.h"
 
 #include "exp.h"
 
@@ -61,6 +71,83 @@ void printExpResults(
 	}
 }
 
+void printScaleResults(
+	TreeInfo treeInfo, TimeInfo timeInfo, int numThreads, double speedup, 
+	double efficiency, const char treeType[], const char storageType[], 
+	const char traversalType[], const char callbackName[], bool verbose
+)
+{
+	if (verbose)
+	{
+		fprintf(
+			stdout, "TreeType = %s , StorageType = %s , TraversalType = %s , Callback = %s , N = %d , Depth = %d , Threads = %d , Samples = %d , AvgWallSeconds = %f , Speedup = %.3f , Efficiency = %.3f\n",
+			treeType, storageType, traversalType, callbackName, treeInfo.size, treeInfo.depth, numThreads, timeInfo.samples, timeInfo.avgWallTime, speedup, efficiency
+		);
+	}
+	else
+	{
+		fprintf(
+			stdout, "%s,%s,%s,%s,%d,%f,%f,%f\n",
+			treeType, storageType, traversalType, callbackName, numThreads, timeInfo.avgWallTime, speedup, efficiency
+		);
+	}
+}
+
+void printLookupResults(
+	TreeInfo treeInfo, TimeInfo timeInfo, int group, const char treeType[], 
+	const char storageType[], const char callbackName[], bool verbose
+)
+{
+	double lookupsPerSec = (timeInfo.wallTime > 0) ? timeInfo.samples / timeInfo.wallTime : 0;
+	if (verbose)
+	{
+		fprintf(
+			stdout, "TreeType = %s , StorageType = %s , Callback = %s , N = %d , Depth = %d , Group = %d , Samples = %d , WallSeconds = %f , LookupsPerSec = %.0f\n",
+			treeType, storageType, callbackName, treeInfo.size, treeInfo.depth, group, timeInfo.samples, timeInfo.wallTime, lookupsPerSec
+		);
+	}
+	else
+	{
+		fprintf(
+			stdout, "%s,%s,%s,%d,%d,%f\n",
+			treeType, storageType, callbackName, treeInfo.depth, group, lookupsPerSec
+		);
+	}
+}
+
+/* writes are split evenly between inserts and deletes of uniform keys */
+void * runMixedOps(void *arg)
+{
+	MixedOpsArgs *args = (MixedOpsArgs *) arg;
+	RandStream rng;
+	int i, key;
+	uint64_t r;
+
+	initRandStream(&rng, RAND_STREAM_SEED, args->threadID);
+	pthread_barrier_wait(args->barrier);
+	for (i=0; i<args->numOps; i++)
+	{
+		r = randStreamBelow(&rng, 200);
+		key = (int) randStreamBelow(&rng, args->keyRange);
+		if (args->tree != NULL)
+		{
+			if (r >= 2 * args->writePercent) args->hits += concurrentFind(args->tree, key);
+			else if (r & 1) concurrentInsert(args->tree, key, NULL);
+			else concurrentDelete(args->tree, key);
+		}
+		else
+		{
+			pthread_mutex_lock(args->coarseLock);
+			if (r >= 2 * args->writePercent) args->hits += find(key, *(args->root)) != NULL;
+			else if (r & 1) *(args->root) = insert(key, NULL, *(args->root));
+			else *(args->root) = delete(key, *(args->root), NULL);
+			pthread_mutex_unlock(args->coarseLock);
+		}
+	}
+	pthread_barrier_wait(args->barrier);
+	return NULL;
+}
+
 double wallTimeDiff(struct timeval start, struct timeval end)
 {
     long seconds = (end.tv_sec - start.tv_sec);
@@ -76,6 +163,8 @@ double wallTimeDiff(struct timeval start, struct timeval end)
 
 /* -------------------------------------------------------------------------- */
 
+/* if threadPool is persistent (see launchPersistentThreadPool) workers are 
+	already running, so samples only measure the traversal itself */
 TimeInfo timeTraversalMT(
 	TreeInfo treeInfo, TraversalFuncMTWrapper traversalFunc, TreeCallback callback,
 	ThreadPool *threadPool, StartThreadArgs *startArgs,
@@ -119,6 +208,52 @@ TimeInfo timeTraversalMT(
 
 /* -------------------------------------------------------------------------- */
 
+TimeInfo timeTraversalScaling(
+	TreeInfo treeInfo, TraversalFuncMTWrapper traversalFunc, TreeCallback callback,
+	int maxThreads, int samples, bool printResults, bool verbose, const char treeType[], 
+	const char storageType[], const char traversalName[], const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+	double baseWallTime = 0;
+	double speedup, efficiency;
+
+	int numThreads;
+	for (numThreads=1; numThreads<=maxThreads; numThreads++)
+	{
+		// fresh persistent pool per thread count so startup isn't timed
+		ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+		StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+		initThreadPool(threadPool, startArgs, numThreads-1);
+		launchPersistentThreadPool(threadPool, startArgs);
+
+		timeInfo = timeTraversalMT(
+			treeInfo, traversalFunc, callback, threadPool, startArgs, samples, 
+			false, verbose, treeType, storageType, traversalName, callbackName
+		);
+		if (numThreads == 1) baseWallTime = timeInfo.avgWallTime;
+
+		speedup = (timeInfo.avgWallTime > 0) ? baseWallTime / timeInfo.avgWallTime : 0;
+		efficiency = speedup / numThreads;
+
+		if (printResults)
+		{
+			printScaleResults(
+				treeInfo, timeInfo, numThreads, speedup, efficiency, treeType, 
+				storageType, traversalName, callbackName, verbose
+			);
+		}
+
+		destroyThreadPool(threadPool, startArgs);
+		free(threadPool);
+		free(startArgs);
+	}
+
+	return timeInfo;
+}
+
+/* -------------------------------------------------------------------------- */
+
 
 
 /******************************************************************************* 
@@ -383,6 +518,883 @@ TimeInfo timeTraversalContCB(
 
 /* -------------------------------------------------------------------------- */
 
+/* same as the timers above for batched callbacks */
+TimeInfo timeTraversalBatchCB(
+	TreeInfo treeInfo, TraversalFuncBatchCB traversalFunc, TreeBatchCallback callback, void *ctx, 
+	int samples, bool printResults, bool verbose, const char treeType[], const char storageType[],
+	const char traversalName[], const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	int i;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<samples; i++)
+	{
+		traversalFunc(treeInfo.root, callback, ctx);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, storageType, traversalName, 
+			callbackName, verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+TimeInfo timeTraversalLevelBatchCB(
+	TreeInfo treeInfo, TreeQueue *treeQueue, TraversalFuncLevelBatchCB traversalFunc, 
+	TreeBatchCallback callback, void *ctx, int samples, bool printResults, bool verbose, 
+	const char treeType[], const char storageType[], const char traversalName[], const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	resetTQ(treeQueue);
+
+	int i;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<samples; i++)
+	{
+		traversalFunc(treeInfo.root, treeQueue, callback, ctx);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, storageType, traversalName, 
+			callbackName, verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+TimeInfo timeTraversalContBatchCB(
+	TreeInfo treeInfo, Tree *btNodeArray, TraversalFuncContBatchCB traversalFunc, 
+	TreeBatchCallback callback, void *ctx, int samples, bool printResults, bool verbose, 
+	const char treeType[], const char storageType[], const char traversalName[], const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	int i;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<samples; i++)
+	{
+		traversalFunc(btNodeArray, treeInfo.size, callback, ctx);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, storageType, traversalName, 
+			callbackName, verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+TimeInfo timeTraversalBatchMT(
+	TreeInfo treeInfo, TraversalFuncBatchMTWrapper traversalFunc, TreeBatchCallback callback, 
+	void *ctx, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	int samples, bool printResults, bool verbose, const char treeType[], 
+	const char storageType[], const char traversalName[], const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	int i;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<samples; i++)
+	{
+		traversalFunc(treeInfo.root, callback, ctx, threadPool, startArgs);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, storageType, traversalName, 
+			callbackName, verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+TimeInfo timeReduceMT(
+	TreeInfo treeInfo, ReduceMap map, ReduceCombine combine, int64_t identity, void *ctx, 
+	int64_t *result, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	int samples, bool printResults, bool verbose, const char treeType[], 
+	const char storageType[], const char traversalName[], const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	int i;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<samples; i++)
+	{
+		*result = traverseReduce(treeInfo.root, map, combine, identity, ctx, threadPool, startArgs);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, storageType, traversalName, 
+			callbackName, verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* compact trees carry their nodes and root index beside treeInfo */
+TimeInfo timeTraversalCompactCB(
+	TreeInfo treeInfo, CompactTree *ctNodeArray, uint32_t root, TraversalFuncCompactCB traversalFunc, 
+	CompactCallback callback, int samples, bool printResults, bool verbose, const char treeType[], 
+	const char storageType[], const char traversalName[], const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	int i;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<samples; i++)
+	{
+		traversalFunc(ctNodeArray, root, callback);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, storageType, traversalName, 
+			callbackName, verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+TimeInfo timeTraversalCompactLevelCB(
+	TreeInfo treeInfo, CompactTree *ctNodeArray, uint32_t root, uint32_t *queue, 
+	TraversalFuncCompactLevelCB traversalFunc, CompactCallback callback, int samples, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[], 
+	const char traversalName[], const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	int i;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<samples; i++)
+	{
+		traversalFunc(ctNodeArray, root, queue, callback);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, storageType, traversalName, 
+			callbackName, verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+TimeInfo timeTraversalCompactMT(
+	TreeInfo treeInfo, CompactTree *ctNodeArray, uint32_t root, 
+	TraversalFuncCompactMTWrapper traversalFunc, CompactCallback callback,
+	ThreadPool *threadPool, StartThreadArgs *startArgs,
+	int samples, bool printResults, bool verbose, const char treeType[], 
+	const char storageType[], const char traversalName[], const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	int i;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<samples; i++)
+	{
+		traversalFunc(ctNodeArray, root, callback, threadPool, startArgs);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, storageType, traversalName, 
+			callbackName, verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+/* -------------------------------------------------------------------------- */
+
+TimeInfo timeSoAKernel(
+	TreeInfo treeInfo, SoATree *soaTree, SoAKernel kernel, int samples, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[],
+	const char traversalName[], const char callbackName[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	int i;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<samples; i++)
+	{
+		kernel(soaTree);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, storageType, traversalName, 
+			callbackName, verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* times numKeys find() lookups, avg times are per lookup */
+TimeInfo timeFind(
+	TreeInfo treeInfo, int *keys, int numKeys, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	int i, found = 0;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<numKeys; i++)
+	{
+		found += find(keys[i], treeInfo.root) != NULL;
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= numKeys;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, storageType, "find", 
+			found == numKeys ? "all-found" : "missing-keys", verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+/* group 0 times the plain find() loop for reference */
+TimeInfo timeFindBatch(
+	TreeInfo treeInfo, int *keys, int numKeys, int group, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	Tree **results = (Tree **) malloc(numKeys * sizeof(Tree *));
+	int i, found = 0;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	if (group == 0)
+	{
+		for (i=0; i<numKeys; i++) results[i] = find(keys[i], treeInfo.root);
+	}
+	else
+	{
+		findBatchGroup(keys, numKeys, results, treeInfo.root, group);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	for (i=0; i<numKeys; i++) found += results[i] != NULL && results[i]->id == keys[i];
+	free(results);
+
+	timeInfo.samples 		= numKeys;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printLookupResults(
+			treeInfo, timeInfo, group, treeType, storageType, 
+			found == numKeys ? "all-found" : "missing-keys", verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+double timeBSTPhase(struct timeval *startTime)
+{
+	struct timeval endTime;
+	double wallTime;
+	gettimeofday(&endTime, NULL);
+	wallTime = wallTimeDiff(*startTime, endTime);
+	*startTime = endTime;
+	return wallTime;
+}
+
+/* inserts keys into an empty BST, finds them, then deletes them in the same 
+	order under the given balance mode, one result line per phase */
+TimeInfo timeBSTOps(
+	int *keys, int numKeys, BalanceMode mode, bool printResults, bool verbose, 
+	const char keyStream[]
+)
+{
+	TimeInfo timeInfo = {0}, phaseInfo = {0};
+	TreeInfo treeInfo = {0};
+
+	BalanceMode oldMode = getBalanceMode();
+	const char *phases[3] = {"insert", "find", "delete"};
+	double phaseTimes[3];
+	Tree *root = NULL;
+	int i, p, found = 0;
+	clock_t tic, toc;
+	struct timeval startTime;
+
+	setBalanceMode(mode);
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<numKeys; i++) root = insert(keys[i], NULL, root);
+	phaseTimes[0] = timeBSTPhase(&startTime);
+	treeInfo.depth = treeHeight(root) - 1;
+	treeInfo.size = computeSubtreeSizes(root);
+	gettimeofday(&startTime, NULL);
+	for (i=0; i<numKeys; i++) found += find(keys[i], root) != NULL;
+	phaseTimes[1] = timeBSTPhase(&startTime);
+	for (i=0; i<numKeys; i++) root = delete(keys[i], root, NULL);
+	phaseTimes[2] = timeBSTPhase(&startTime);
+	toc = clock();
+	setBalanceMode(oldMode);
+
+	timeInfo.samples 		= 3 * numKeys;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= phaseTimes[0] + phaseTimes[1] + phaseTimes[2];
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		for (p=0; p<3; p++)
+		{
+			phaseInfo.samples = numKeys;
+			phaseInfo.wallTime = phaseTimes[p];
+			printLookupResults(
+				treeInfo, phaseInfo, 0, balanceModeName(mode), keyStream, 
+				(found == numKeys && root == NULL) ? phases[p] : "missing-keys", verbose
+			);
+		}
+	}
+
+	return timeInfo;
+}
+
+/* numThreads threads each run numOps finds/inserts/deletes on a tree prefilled 
+	with half of [0, keyRange), timed between two barriers */
+TimeInfo timeMixedBST(
+	int numThreads, int numOps, int writePercent, int keyRange, bool concurrent, 
+	bool printResults, bool verbose
+)
+{
+	TimeInfo timeInfo = {0};
+	TreeInfo treeInfo = {0};
+
+	MixedOpsArgs *args = (MixedOpsArgs *) malloc(numThreads * sizeof(MixedOpsArgs));
+	pthread_t *threads = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
+	ConcurrentTree tree;
+	Tree *root = NULL;
+	pthread_mutex_t coarseLock;
+	pthread_barrier_t barrier;
+	RandStream rng;
+	char storageType[32];
+	int i, key;
+	struct timeval startTime, endTime;
+
+	initConcurrentTree(&tree);
+	pthread_mutex_init(&coarseLock, NULL);
+	pthread_barrier_init(&barrier, NULL, numThreads + 1);
+	initRandStream(&rng, RAND_STREAM_SEED, RAND_FALLBACK_STREAM);
+	for (i=0; i<keyRange/2; i++)
+	{
+		key = (int) randStreamBelow(&rng, keyRange);
+		if (concurrent) concurrentInsert(&tree, key, NULL);
+		else root = insert(key, NULL, root);
+	}
+
+	for (i=0; i<numThreads; i++)
+	{
+		args[i].tree = concurrent ? &tree : NULL;
+		args[i].root = &root;
+		args[i].coarseLock = &coarseLock;
+		args[i].barrier = &barrier;
+		args[i].threadID = i;
+		args[i].numOps = numOps;
+		args[i].writePercent = writePercent;
+		args[i].keyRange = keyRange;
+		args[i].hits = 0;
+		pthread_create(&threads[i], NULL, &runMixedOps, &args[i]);
+	}
+	pthread_barrier_wait(&barrier);
+	gettimeofday(&startTime, NULL);
+	pthread_barrier_wait(&barrier);
+	gettimeofday(&endTime, NULL);
+	for (i=0; i<numThreads; i++) pthread_join(threads[i], NULL);
+
+	treeInfo.size = concurrent ? concurrentTreeCount(&tree) : computeSubtreeSizes(root);
+	destroyConcurrentTree(&tree);
+	root = make_empty(root);
+	pthread_barrier_destroy(&barrier);
+	pthread_mutex_destroy(&coarseLock);
+	free(threads);
+	free(args);
+
+	timeInfo.samples 		= numThreads * numOps;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		snprintf(storageType, sizeof(storageType), "writes-%d%%", writePercent);
+		printLookupResults(
+			treeInfo, timeInfo, numThreads, concurrent ? "concurrent" : "coarse-lock", 
+			storageType, "mixed-ops", verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+/* the same keys loaded by per-key insert() (shuffled order), by the serial and 
+	parallel sorted builds (fragmented and contiguous), then a sorted batch 
+	merged into the fragmented trees. printed per phase */
+TimeInfo timeBulkBST(
+	int *keys, int *shuffled, int numKeys, int *batch, int batchSize, 
+	ThreadPool *threadPool, StartThreadArgs *startArgs, bool printResults, bool verbose
+)
+{
+	TimeInfo timeInfo = {0}, phaseInfo = {0};
+	TreeInfo treeInfo = {0};
+
+	const char *phases[7] = {
+		"insert-shuffled", "build-sorted", "build-sorted-mt", "build-sorted", 
+		"build-sorted-mt", "insert-sorted", "insert-sorted-mt"
+	};
+	Tree *btNodeArray = (Tree *) malloc(numKeys * sizeof(Tree));
+	Tree *root = NULL, *serial, *parallel;
+	double phaseTimes[7];
+	int i, p, numThreads = threadPool->size + 1;
+	struct timeval startTime;
+
+	// fault the array in first so the contiguous serial build doesn't pay for it
+	memset(btNodeArray, 0, numKeys * sizeof(Tree));
+	gettimeofday(&startTime, NULL);
+	for (i=0; i<numKeys; i++) root = insert(shuffled[i], NULL, root);
+	phaseTimes[0] = timeBSTPhase(&startTime);
+	root = make_empty(root);
+
+	gettimeofday(&startTime, NULL);
+	serial = buildBSTSorted(keys, numKeys, NULL).root;
+	phaseTimes[1] = timeBSTPhase(&startTime);
+	parallel = buildBSTSortedMT(keys, numKeys, NULL, threadPool, startArgs).root;
+	phaseTimes[2] = timeBSTPhase(&startTime);
+	buildBSTSorted(keys, numKeys, btNodeArray);
+	phaseTimes[3] = timeBSTPhase(&startTime);
+	treeInfo = buildBSTSortedMT(keys, numKeys, btNodeArray, threadPool, startArgs);
+	phaseTimes[4] = timeBSTPhase(&startTime);
+
+	serial = insertSorted(serial, batch, batchSize);
+	phaseTimes[5] = timeBSTPhase(&startTime);
+	parallel = insertSortedMT(parallel, batch, batchSize, threadPool, startArgs);
+	phaseTimes[6] = timeBSTPhase(&startTime);
+
+	serial = make_empty(serial);
+	parallel = make_empty(parallel);
+	free(btNodeArray);
+
+	for (p=0; p<7; p++)
+	{
+		phaseInfo.samples = (p < 5) ? numKeys : batchSize;
+		phaseInfo.wallTime = phaseTimes[p];
+		timeInfo.samples += phaseInfo.samples;
+		timeInfo.wallTime += phaseInfo.wallTime;
+		if (printResults)
+		{
+			printLookupResults(
+				treeInfo, phaseInfo, numThreads, "bst", 
+				(p == 3 || p == 4) ? "contiguous" : "fragmented", phases[p], verbose
+			);
+		}
+	}
+	timeInfo.avgWallTime = timeInfo.wallTime / timeInfo.samples;
+
+	return timeInfo;
+}
+
+/* the implicit arrays are built from treeInfo.root before the clock starts */
+TimeInfo timeSearchStructure(
+	TreeInfo treeInfo, SearchStructure structure, int *keys, int numKeys, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	SearchArray searchArray = {0};
+	Tree **results = (Tree **) malloc(numKeys * sizeof(Tree *));
+	int i, found = 0;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	if (structure == SEARCH_EYTZINGER) initEytzinger(&searchArray, treeInfo.root);
+	else if (structure == SEARCH_BTREE) initSearchBTree(&searchArray, treeInfo.root);
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	if (structure == SEARCH_EYTZINGER)
+	{
+		for (i=0; i<numKeys; i++) results[i] = findEytzinger(keys[i], &searchArray);
+	}
+	else if (structure == SEARCH_BTREE)
+	{
+		for (i=0; i<numKeys; i++) results[i] = findSearchBTree(keys[i], &searchArray);
+	}
+	else
+	{
+		for (i=0; i<numKeys; i++) results[i] = find(keys[i], treeInfo.root);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	for (i=0; i<numKeys; i++) found += results[i] != NULL && results[i]->id == keys[i];
+	free(results);
+	freeSearchArray(&searchArray);
+
+	timeInfo.samples 		= numKeys;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printLookupResults(
+			treeInfo, timeInfo, 0, treeType, storageType, 
+			found == numKeys ? searchStructureName(structure) : "missing-keys", verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+TimeInfo timeFindFirst(
+	TreeInfo treeInfo, int *keys, int numKeys, ThreadPool *threadPool, StartThreadArgs *startArgs,
+	bool printResults, bool verbose, const char treeType[], const char storageType[], 
+	const char traversalName[]
+)
+{
+	TimeInfo timeInfo = {0};
+
+	int i, found = 0;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<numKeys; i++)
+	{
+		if (threadPool == NULL) found += preOrderFind(treeInfo.root, &matchKeyPredicate, keys + i) != NULL;
+		else found += findKeyMT(keys[i], treeInfo.root, threadPool, startArgs) != NULL;
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= numKeys;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, storageType, traversalName, 
+			found == numKeys ? "all-found" : "missing-keys", verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* rebuilds the tree of invTable samples times through the current node 
+	allocator, build and teardown (make_empty plus allocator reset) are timed 
+	and printed separately, the build time is returned */
+TimeInfo timeTreeBuild(
+	TreeInfo treeInfo, int *invTable, ITNode *itNodeArray, int samples, 
+	bool printResults, bool verbose, const char treeType[], const char storageType[]
+)
+{
+	TimeInfo buildInfo = {0}, teardownInfo = {0};
+
+	int i;
+	Tree *root;
+	clock_t tic, buildCycles = 0, teardownCycles = 0;
+	struct timeval startTime, endTime;
+	double buildWall = 0, teardownWall = 0;
+
+	for (i=0; i<samples; i++)
+	{
+		gettimeofday(&startTime, NULL);
+		tic = clock();
+		root = invTab2BTOptimized(invTable, itNodeArray, treeInfo.size);
+		buildCycles += clock() - tic;
+		gettimeofday(&endTime, NULL);
+		buildWall += wallTimeDiff(startTime, endTime);
+
+		gettimeofday(&startTime, NULL);
+		tic = clock();
+		make_empty(root);
+		if (getNodeAllocator() != NULL) resetNodeAllocator(getNodeAllocator());
+		teardownCycles += clock() - tic;
+		gettimeofday(&endTime, NULL);
+		teardownWall += wallTimeDiff(startTime, endTime);
+	}
+
+	buildInfo.samples		= samples;
+	buildInfo.cycles		= buildCycles;
+	buildInfo.seconds		= (double) buildCycles / CLOCKS_PER_SEC;
+	buildInfo.wallTime		= buildWall;
+	buildInfo.avgCycles		= (double) buildInfo.cycles / samples;
+	buildInfo.avgSeconds	= buildInfo.seconds / samples;
+	buildInfo.avgWallTime	= buildInfo.wallTime / samples;
+
+	teardownInfo.samples	= samples;
+	teardownInfo.cycles		= teardownCycles;
+	teardownInfo.seconds	= (double) teardownCycles / CLOCKS_PER_SEC;
+	teardownInfo.wallTime	= teardownWall;
+	teardownInfo.avgCycles	= (double) teardownInfo.cycles / samples;
+	teardownInfo.avgSeconds	= teardownInfo.seconds / samples;
+	teardownInfo.avgWallTime	= teardownInfo.wallTime / samples;
+
+	if (printResults)
+	{
+		printExpResults(treeInfo, buildInfo, treeType, storageType, "build", "none", verbose);
+		printExpResults(treeInfo, teardownInfo, treeType, storageType, "teardown", "none", verbose);
+	}
+
+	return buildInfo;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* times genFunc, or genFuncMT on threadPool when genFunc is NULL */
+TimeInfo timeContTreeGen(
+	ContTreeGenFunc genFunc, ContTreeGenFuncMT genFuncMT, int size,
+	int *invTable, Tree *btNodeArray, ITNode *itNodeArray,
+	ThreadPool *threadPool, StartThreadArgs *startArgs, int samples, 
+	bool printResults, bool verbose, const char treeType[], const char genName[]
+)
+{
+	TimeInfo timeInfo = {0};
+	TreeInfo treeInfo = {0};
+
+	int i;
+	clock_t tic, toc;
+	struct timeval startTime, endTime;
+
+	gettimeofday(&startTime, NULL);
+	tic = clock();
+	for (i=0; i<samples; i++)
+	{
+		if (genFunc != NULL) treeInfo = genFunc(invTable, btNodeArray, itNodeArray, size, false);
+		else treeInfo = genFuncMT(invTable, btNodeArray, itNodeArray, size, false, threadPool, startArgs);
+	}
+	toc = clock();
+	gettimeofday(&endTime, NULL);
+
+	timeInfo.samples 		= samples;
+	timeInfo.cycles			= toc - tic;
+	timeInfo.seconds		= (double) (toc - tic) / CLOCKS_PER_SEC;
+	timeInfo.wallTime		= wallTimeDiff(startTime, endTime);
+	timeInfo.avgCycles		= (double) timeInfo.cycles / timeInfo.samples;
+	timeInfo.avgSeconds		= timeInfo.seconds / timeInfo.samples;
+	timeInfo.avgWallTime	= timeInfo.wallTime / timeInfo.samples;
+
+	if (printResults)
+	{
+		printExpResults(
+			treeInfo, timeInfo, treeType, "contiguous", genName, "none", verbose
+		);
+	}
+
+	return timeInfo;
+}
+
+/* -------------------------------------------------------------------------- */
+
 /******************************************************************************* 
 --------------------------------- END OF FILE ----------------------------------
 *******************************************************************************/
\ No newline at end of file
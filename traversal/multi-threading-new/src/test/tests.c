@@ -16,7 +16,11 @@
 /******************************************************************************* 
 ------------------------------- IMPORTS & PARAMS -------------------------------
 *******************************************************************************/
+#include <limits.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -25,8 +29,16 @@
 #include "types.h"
 #include "binaryTree.h"
 #include "binaryTreeGen.h"
+#include "bulkBST.h"
+#include "concurrentTree.h"
+#include "nodeAlloc.h"
 #include "queue.h"
+#include "randStream.h"
+#include "searchArray.h"
+#include "soaTree.h"
 #include "threadpool.h"
+#include "treeGenMT.h"
+#include "treeLayout.h"
 #include "util.h"
 
 
@@ -45,6 +57,86 @@
 
 #define	TEST_8_N		15
 #define TEST_8_DEPTH	3
+#define	TEST_8_CHECK_DEPTH	16
+#define	TEST_8_CHECK_N		((1<<(TEST_8_CHECK_DEPTH+1))-1)
+#define	TEST_8_CHECK_RUNS	10
+
+#define	TEST_9_N		1001
+
+#define	TEST_10_N		1001
+
+#define	TEST_11_N		1001
+
+#define	TEST_12_N		100001
+#define	TEST_12_SLAB	4096
+
+#define	TEST_13_N		200001
+#define	TEST_13_DEPTH	17
+#define	TEST_13_SAMPLES	20
+#define	TEST_13_SPLIT_N	12
+#define	TEST_13_SPLIT_SAMPLES	1000000
+
+#define	TEST_14_N		5
+#define	TEST_14_SAMPLES	1000000
+#define	TEST_14_TREE_N	1001
+#define	TEST_14_TREES	2000
+
+#define	TEST_15_N		100001
+#define	TEST_15_SAMPLES	1000000
+#define	TEST_15_BUCKETS	16
+
+#define	TEST_16_N		100001
+#define	TEST_16_RUNS	20
+
+#define	TEST_17_N		100001
+#define	TEST_17_KEYS	200
+
+#define	TEST_18_DEPTH	10
+#define	TEST_18_SPARES	4
+
+#define	TEST_19_N		100001
+#define	TEST_19_KEYS	20000
+#define	TEST_19_DEPTH	14
+
+#define	TEST_20_N		100001
+#define	TEST_20_DEPTH	12
+
+#define	TEST_21_N		20000
+
+#define	TEST_22_KEYS	4096
+#define	TEST_22_OPS		200000
+#define	TEST_22_SHORT_OPS	2000
+
+#define	TEST_23_N		200001
+
+#define	TEST_24_N		100001
+#define	TEST_24_DEPTH	14
+
+#define	TEST_25_N		100001
+#define	TEST_25_DEPTH	14
+
+/* thread of the concurrent BST test: inserts/deletes the keys it owns (key % 
+	numThreads == threadID) and mirrors them in expected, finds any key */
+typedef struct ConcurrentTestArgs
+{
+	ConcurrentTree *tree;
+	bool *expected;
+	atomic_int *violations;
+	int threadID;
+	int numThreads;
+	int ops;
+} ConcurrentTestArgs;
+
+/* visit counter for checking multi-threaded post-order, stored in node->data */
+atomic_long visitStamp;
+
+/* ids in visiting order, filled by recordNode/recordBatch */
+int *visitOrder;
+int visitCount;
+
+/* compact callbacks stamp compactStamps[node - compactNodes] */
+CompactTree *compactNodes;
+long *compactStamps;
 
 
 /******************************************************************************* 
@@ -124,6 +216,254 @@ void assignTab(int *invTabSet, int N, int *tabID, int depth, int prev)
 
 }
 
+void stampNode(Tree *t)
+{
+	t->data = (void *) (intptr_t) (atomic_fetch_add(&visitStamp, 1) + 1);
+}
+
+/* returns root's stamp, counts nodes visited before one of their children */
+long checkPostOrderStamps(Tree *root, int *violations)
+{
+	if (root == NULL) return 0;
+
+	long left = checkPostOrderStamps(root->left, violations);
+	long right = checkPostOrderStamps(root->right, violations);
+	long stamp = (long) (intptr_t) root->data;
+	if (stamp == 0 || stamp <= left || stamp <= right) (*violations)++;
+	return stamp;
+}
+
+void clearStamps(Tree *root)
+{
+	if (root == NULL) return;
+	root->data = NULL;
+	clearStamps(root->left);
+	clearStamps(root->right);
+}
+
+void recordNode(Tree *t)
+{
+	visitOrder[visitCount++] = t->id;
+}
+
+/* ctx counts the flushes */
+void recordBatch(Tree **nodes, int n, void *ctx)
+{
+	int i;
+	for (i=0; i<n; i++) visitOrder[visitCount++] = nodes[i]->id;
+	(*(int *) ctx)++;
+}
+
+/* compares the ids recorded since visitCount was reset with expected[0..n) */
+int countOrderMismatches(int *expected, int n)
+{
+	int i, mismatches = (visitCount != n);
+	for (i=0; i<n; i++) mismatches += expected[i] != visitOrder[i];
+	return mismatches;
+}
+
+/* bumps data of every node handed over, ctx is an atomic total */
+void countBatch(Tree **nodes, int n, void *ctx)
+{
+	int i;
+	for (i=0; i<n; i++) nodes[i]->data = (void *) ((intptr_t) nodes[i]->data + 1);
+	atomic_fetch_add((atomic_long *) ctx, n);
+}
+
+/* per-node version of countBatch, a node visited twice ends up above 1 */
+void countNode(Tree *t)
+{
+	t->data = (void *) ((intptr_t) t->data + 1);
+}
+
+int countSingleVisits(Tree *root)
+{
+	if (root == NULL) return 0;
+	return ((intptr_t) root->data == 1) 
+		+ countSingleVisits(root->left) + countSingleVisits(root->right);
+}
+
+/* children stored within a page of their parent, shows how scattered a tree is */
+/* id from the stream of whichever thread runs the callback */
+void drawNode(Tree *t)
+{
+	t->id = (int) (randStreamNext(threadRandStream()) >> 33);
+}
+
+bool leafPredicate(Tree *t, void *ctx)
+{
+	return t->left == NULL && t->right == NULL;
+}
+
+/* items a cancelled search left behind in any deque */
+long countLeftovers(ThreadPool *threadPool)
+{
+	long leftovers = 0;
+	int i;
+	for (i=0; i<poolThreadCount(threadPool); i++) leftovers += sizeDeque(&(threadPool->threads[i].deque));
+	return leftovers;
+}
+
+void sleepIncrementNode(Tree *t)
+{
+	sleepNode(t);
+	incrementID(t);
+}
+
+/* tasks run by spare workers in the last traversal */
+int countSpareTasks(ThreadPool *threadPool)
+{
+	int i, tasks = 0;
+	for (i=threadPool->size+1; i<poolThreadCount(threadPool); i++) tasks += threadPool->threads[i].totalTasks;
+	return tasks;
+}
+
+double elapsedSeconds(struct timespec *start)
+{
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int cmpInt(const void *a, const void *b)
+{
+	int x = *(const int *) a, y = *(const int *) b;
+	return (x > y) - (x < y);
+}
+
+/* replays every thread's stream from seed until it reaches the thread's 
+	current state, the drawn ids must be exactly those values */
+int checkStreamDraws(Tree *btNodeArray, int N, ThreadPool *threadPool, uint64_t seed)
+{
+	int *drawn = (int *) malloc(N * sizeof(int));
+	int *ids = (int *) malloc(N * sizeof(int));
+	int i, m = 0, mismatches = 0;
+	RandStream replay;
+	TraversalThread *t;
+
+	for (i=0, t=threadPool->threads; i<poolThreadCount(threadPool); i++, t++)
+	{
+		initRandStream(&replay, seed, (i == threadPool->size) ? 0 : i+1);
+		while (replay.state != t->rng.state && m < N)
+		{
+			drawn[m++] = (int) (randStreamNext(&replay) >> 33);
+		}
+	}
+	for (i=0; i<N; i++) ids[i] = btNodeArray[i].id;
+	qsort(drawn, m, sizeof(int), cmpInt);
+	qsort(ids, N, sizeof(int), cmpInt);
+	for (i=0; i<N; i++) mismatches += (i >= m || drawn[i] != ids[i]);
+
+	free(drawn);
+	free(ids);
+	return mismatches;
+}
+
+bool nearParent(Tree *parent, Tree *child)
+{
+	intptr_t gap = (intptr_t) child - (intptr_t) parent;
+	return child != NULL && gap > -4096 && gap < 4096;
+}
+
+int countNearChildren(Tree *root)
+{
+	if (root == NULL) return 0;
+	return nearParent(root, root->left) + nearParent(root, root->right)
+		+ countNearChildren(root->left) + countNearChildren(root->right);
+}
+
+int countLeaves(Tree *root)
+{
+	if (root == NULL) return 0;
+	if (root->left == NULL && root->right == NULL) return 1;
+	return countLeaves(root->left) + countLeaves(root->right);
+}
+
+/* nodes whose subtreeSize isn't exact, size returned through *size */
+int countBadSizes(Tree *root, int *size)
+{
+	int l = 0, r = 0, bad;
+	*size = 0;
+	if (root == NULL) return 0;
+	bad = countBadSizes(root->left, &l) + countBadSizes(root->right, &r);
+	*size = l + r + 1;
+	return bad + (root->subtreeSize != *size);
+}
+
+/* nodes whose id or children differ between two pre-order node arrays */
+int compareContTrees(Tree *a, Tree *b, int N)
+{
+	int i, mismatches = 0;
+	for (i=0; i<N; i++)
+	{
+		mismatches += a[i].id != b[i].id
+			|| (a[i].left == NULL) != (b[i].left == NULL)
+			|| (a[i].right == NULL) != (b[i].right == NULL)
+			|| (a[i].left != NULL && a[i].left - a != b[i].left - b)
+			|| (a[i].right != NULL && a[i].right - a != b[i].right - b);
+	}
+	return mismatches;
+}
+
+int validatePostOrderMT(Tree *root, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+	int violations = 0;
+	int i;
+	for (i=0; i<TEST_8_CHECK_RUNS; i++)
+	{
+		clearStamps(root);
+		atomic_store(&visitStamp, 0);
+		postOrderMTWrapper(root, stampNode, threadPool, startArgs);
+		checkPostOrderStamps(root, &violations);
+	}
+	return violations;
+}
+
+/* stamp range of each depth, unstamped nodes are counted in *violations */
+void levelStampRange(Tree *root, int depth, long *minStamp, long *maxStamp, int *violations)
+{
+	long stamp;
+	if (root == NULL) return;
+
+	stamp = (long) (intptr_t) root->data;
+	if (stamp == 0) (*violations)++;
+	if (stamp < minStamp[depth]) minStamp[depth] = stamp;
+	if (stamp > maxStamp[depth]) maxStamp[depth] = stamp;
+	levelStampRange(root->left, depth+1, minStamp, maxStamp, violations);
+	levelStampRange(root->right, depth+1, minStamp, maxStamp, violations);
+}
+
+/* every node stamped once (N stamps handed out, none left at 0) and each 
+	level visited entirely after the one above it */
+int validateLevelOrderMT(Tree *root, int N, ThreadPool *threadPool, StartThreadArgs *startArgs)
+{
+	int height = treeHeight(root);
+	long *minStamp = (long *) malloc(height * sizeof(long));
+	long *maxStamp = (long *) malloc(height * sizeof(long));
+	int violations = 0;
+	int i, d;
+
+	for (i=0; i<TEST_8_CHECK_RUNS; i++)
+	{
+		clearStamps(root);
+		atomic_store(&visitStamp, 0);
+		levelOrderMTWrapper(root, stampNode, threadPool, startArgs);
+
+		for (d=0; d<height; d++)
+		{
+			minStamp[d] = LONG_MAX;
+			maxStamp[d] = 0;
+		}
+		levelStampRange(root, 0, minStamp, maxStamp, &violations);
+		for (d=1; d<height; d++) violations += minStamp[d] <= maxStamp[d-1];
+		violations += atomic_load(&visitStamp) != N;
+	}
+
+	free(minStamp);
+	free(maxStamp);
+	return violations;
+}
+
 void genInvTabSet(int *invTabSet, int N)
 {
 	int tabID = 0;
@@ -540,7 +880,7 @@ void validateTraversal()
 	freeTQ(&treeQueue);
 }
 
-void validateMultiThread() 
+void validateMultiThread(int numThreads) 
 {
 	int *invTable;
 	Tree *binaryTree;
@@ -556,9 +896,9 @@ void validateMultiThread()
 	TreeCallback callback = &printNode;
 
 
-	ThreadPool *threadPool = (ThreadPool *) malloc(sizeof(ThreadPool));
-	StartThreadArgs *startArgs = (StartThreadArgs *) malloc((NUM_THREADS-1) * sizeof(StartThreadArgs));
-	initThreadPool(threadPool, startArgs, NUM_THREADS-1);
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	initThreadPool(threadPool, startArgs, numThreads-1);
 
 
 	printf("Generated Binary Tree: N = %d\n", TEST_8_N);
@@ -603,6 +943,39 @@ void validateMultiThread()
 	printf("\n\n");
 
 
+	free(invTable);
+	free(itNodeArray);
+	binaryTree = make_empty(binaryTree);
+	invTable = (int *) malloc(TEST_8_CHECK_N * sizeof(int));
+	itNodeArray = (ITNode *) malloc(TEST_8_CHECK_N * sizeof(ITNode));
+
+	printf("Multi-Thread Post-Order Children-Before-Parent Check: Runs = %d\n", TEST_8_CHECK_RUNS);
+	printf("***************************************************************\n");
+	treeInfo = genRandomTreeOptimized(invTable, itNodeArray, TEST_8_CHECK_N, false);
+	binaryTree = treeInfo.root;
+	printf("Random Tree: N = %d , Violations = %d\n", 
+		TEST_8_CHECK_N, validatePostOrderMT(binaryTree, threadPool, startArgs));
+	binaryTree = make_empty(binaryTree);
+
+	treeInfo = genBalancedTreeOptimized(invTable, itNodeArray, TEST_8_CHECK_DEPTH, false);
+	binaryTree = treeInfo.root;
+	printf("Balanced Tree: N = %d , Violations = %d\n", 
+		TEST_8_CHECK_N, validatePostOrderMT(binaryTree, threadPool, startArgs));
+	printf("\n");
+
+	printf("Multi-Thread Level-Order Exactly-Once and Level-by-Level Check: Runs = %d\n", TEST_8_CHECK_RUNS);
+	printf("***************************************************************\n");
+	printf("Balanced Tree: N = %d , Violations = %d\n", 
+		TEST_8_CHECK_N, validateLevelOrderMT(binaryTree, TEST_8_CHECK_N, threadPool, startArgs));
+	binaryTree = make_empty(binaryTree);
+
+	treeInfo = genRandomTreeOptimized(invTable, itNodeArray, TEST_8_CHECK_N, false);
+	binaryTree = treeInfo.root;
+	printf("Random Tree: N = %d , Violations = %d\n", 
+		TEST_8_CHECK_N, validateLevelOrderMT(binaryTree, TEST_8_CHECK_N, threadPool, startArgs));
+	printf("\n");
+
+
 	destroyThreadPool(threadPool, startArgs);
 	free(threadPool);
 	free(startArgs);
@@ -614,61 +987,1568 @@ void validateMultiThread()
 	
 }
 
-/******************************************************************************* 
-------------------------------------- MAIN -------------------------------------
-*******************************************************************************/
-int main(int argc, char *argv[])
+void validateSoA()
 {
-	/* ---------------------------------------------------------------------- */
+	int *invTable;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	SoATree soaTree;
+	RandStream stream, expected, *previous;
+	int i, k, mismatches = 0;
+	uint32_t left, right;
+
+	invTable = (int *) malloc(TEST_9_N * sizeof(int));
+	btNodeArray = (Tree *) malloc(TEST_9_N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(TEST_9_N * sizeof(ITNode));
+	initSoATree(&soaTree, TEST_9_N);
+
+	printf("SoA vs. Contiguous Translation: N = %d\n", TEST_9_N);
+	printf("*****************************************\n");
+	genInversionTable(invTable, TEST_9_N);
+	invTab2ContBTOptimized(invTable, btNodeArray, itNodeArray, TEST_9_N);
+	invTab2SoABT(invTable, &soaTree, itNodeArray, TEST_9_N);
+	for (i=0; i<TEST_9_N; i++)
+	{
+		left = (btNodeArray[i].left != NULL) ? (uint32_t) (btNodeArray[i].left - btNodeArray) : COMPACT_NULL;
+		right = (btNodeArray[i].right != NULL) ? (uint32_t) (btNodeArray[i].right - btNodeArray) : COMPACT_NULL;
+		mismatches += (soaTree.id[i] != btNodeArray[i].id) 
+			|| (soaTree.left[i] != left) || (soaTree.right[i] != right);
+	}
+	printf("Mismatched Nodes = %d\n\n", mismatches);
+
+	printf("Bulk Kernels vs. Scalar: SIMD = %s\n", soaSimdName());
+	printf("*****************************************\n");
+	mismatches = 0;
+	soaIncrementID(&soaTree);
+	for (i=0; i<TEST_9_N; i++) mismatches += soaTree.id[i] != btNodeArray[i].id + 1;
+	printf("Increment Mismatches = %d\n", mismatches);
+	soaTree.id[3] = soaTree.id[TEST_9_N-1] = -7;
+	printf("Key Count = %d , Expected = %d\n", 
+		soaCountKey(&soaTree, -7), soaCountKeyScalar(&soaTree, -7));
+
+	// randArray on every node in index order is the reference for both ids 
+	// and where the stream ends up
+	previous = swapThreadRandStream(&expected);
+	initRandStream(&expected, RAND_STREAM_SEED, 7);
+	for (i=0; i<TEST_9_N; i++) randArray(btNodeArray + i);
+	for (k=0; k<2; k++)
+	{
+		initRandStream(&stream, RAND_STREAM_SEED, 7);
+		swapThreadRandStream(&stream);
+		for (i=0; i<TEST_9_N; i++) soaTree.id[i] = -1;
+		if (k == 0) soaRandArray(&soaTree);
+		else soaRandArrayScalar(&soaTree);
+		for (i=0, mismatches=0; i<TEST_9_N; i++) mismatches += soaTree.id[i] != btNodeArray[i].id;
+		printf("randArray %-6s: Mismatches = %d , Stream Matches = %d\n", 
+			(k == 0) ? soaSimdName() : "scalar", mismatches, stream.state == expected.state);
+	}
+	swapThreadRandStream(previous);
 	printf("\n");
-	printf("###############################################################################\n");
-	printf("########################### Binary Tree Unit Tests ############################\n");
-	printf("###############################################################################\n");
+
+	freeSoATree(&soaTree);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+void validateBatchCallbacks(int numThreads)
+{
+	int *invTable, *order;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo;
+	TreeQueue treeQueue;
+	int k, batches, mismatches;
+	atomic_long visited;
+
+	invTable = (int *) malloc(TEST_8_CHECK_N * sizeof(int));
+	btNodeArray = (Tree *) malloc(TEST_8_CHECK_N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(TEST_8_CHECK_N * sizeof(ITNode));
+	visitOrder = (int *) malloc(TEST_10_N * sizeof(int));
+	order = (int *) malloc(TEST_10_N * sizeof(int));
+	initTQ(&treeQueue, TEST_10_N);
+
+	printf("Batched vs. Per-Node Visiting Order: N = %d , Batch = %d\n", TEST_10_N, CALLBACK_BATCH_SIZE);
+	printf("**********************************************************\n");
+	treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_10_N, false);
+	const char *names[4] = {"Pre-Order", "Post-Order", "Level-Order", "Contiguous Order"};
+	for (k=0; k<4; k++)
+	{
+		visitCount = 0;
+		if (k == 0) preOrderCB(treeInfo.root, recordNode);
+		if (k == 1) postOrderCB(treeInfo.root, recordNode);
+		if (k == 2) levelOrderCB(treeInfo.root, &treeQueue, recordNode);
+		if (k == 3) contiguousOrderCB(btNodeArray, TEST_10_N, recordNode);
+		memcpy(order, visitOrder, TEST_10_N * sizeof(int));
+
+		visitCount = 0;
+		batches = 0;
+		if (k == 0) preOrderBatchCB(treeInfo.root, recordBatch, &batches);
+		if (k == 1) postOrderBatchCB(treeInfo.root, recordBatch, &batches);
+		if (k == 2) levelOrderBatchCB(treeInfo.root, &treeQueue, recordBatch, &batches);
+		if (k == 3) contiguousOrderBatchCB(btNodeArray, TEST_10_N, recordBatch, &batches);
+
+		mismatches = countOrderMismatches(order, TEST_10_N);
+		printf("%s: Visited = %d , Batches = %d , Mismatches = %d\n", names[k], visitCount, batches, mismatches);
+	}
 	printf("\n");
 
-	int testNum = 1;
-	init_genrand64(time(0));
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	initThreadPool(threadPool, startArgs, numThreads-1);
 
+	printf("Multi-Thread Batched Traversals: N = %d , Threads = %d\n", TEST_8_CHECK_N, numThreads);
+	printf("**********************************************************\n");
+	for (k=0; k<2; k++)
+	{
+		treeInfo = (k == 0) 
+			? genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_8_CHECK_N, false)
+			: genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_8_CHECK_DEPTH, false);
+
+		atomic_store(&visited, 0);
+		clearStamps(treeInfo.root);
+		preOrderBatchMTWrapper(treeInfo.root, countBatch, &visited, threadPool, startArgs);
+		printf("%s Tree Pre-Order: Visited = %ld , Visited Once = %d\n", 
+			(k == 0) ? "Random" : "Balanced", atomic_load(&visited), countSingleVisits(treeInfo.root));
+
+		atomic_store(&visited, 0);
+		clearStamps(treeInfo.root);
+		levelOrderBatchMTWrapper(treeInfo.root, countBatch, &visited, threadPool, startArgs);
+		printf("%s Tree Level-Order: Visited = %ld , Visited Once = %d\n", 
+			(k == 0) ? "Random" : "Balanced", atomic_load(&visited), countSingleVisits(treeInfo.root));
+	}
+	printf("\n");
 
-	/* ---------------------------------------------------------------------- */
-	
-	printUnitTestMsg(&testNum, "Validate Binary Search Tree Structure");
-	validateBST();
+	destroyThreadPool(threadPool, startArgs);
+	free(threadPool);
+	free(startArgs);
 
-	/* ---------------------------------------------------------------------- */
-	
-	printUnitTestMsg(&testNum, "Validate Inversion Table Gen. Correctness");
-	validateInvTabGen();
+	freeTQ(&treeQueue);
+	free(order);
+	free(visitOrder);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
 
-	/* ---------------------------------------------------------------------- */
-	
-	printUnitTestMsg(&testNum, "Example Inversion Table Direct to Output");
-	exampleInvTab2Output();
+void validatePrefetchTraversals(int numThreads)
+{
+	int *invTable, *order;
+	Tree *btNodeArray;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo;
+	int k, distance, mismatches, size, violations;
+
+	invTable = (int *) malloc(TEST_8_CHECK_N * sizeof(int));
+	btNodeArray = (Tree *) malloc(TEST_8_CHECK_N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(TEST_8_CHECK_N * sizeof(ITNode));
+	visitOrder = (int *) malloc(TEST_11_N * sizeof(int));
+	order = (int *) malloc(TEST_11_N * sizeof(int));
+
+	printf("Prefetching vs. Plain Visiting Order: N = %d\n", TEST_11_N);
+	printf("**********************************************************\n");
+	treeInfo = genRandomTreeOptimized(invTable, itNodeArray, TEST_11_N, false);
+	for (k=0; k<2; k++)
+	{
+		visitCount = 0;
+		if (k == 0) preOrderCB(treeInfo.root, recordNode);
+		if (k == 1) postOrderCB(treeInfo.root, recordNode);
+		memcpy(order, visitOrder, TEST_11_N * sizeof(int));
 
-	/* ---------------------------------------------------------------------- */
-	
-	printUnitTestMsg(&testNum, "Validate Inversion Table Translation Correctness");
-	validateInvTabTranslation();
+		visitCount = 0;
+		if (k == 0) preOrderPrefetchCB(treeInfo.root, recordNode);
+		if (k == 1) postOrderPrefetchCB(treeInfo.root, recordNode);
 
-	/* ---------------------------------------------------------------------- */
-	
-	printUnitTestMsg(&testNum, "Example Random Binary Tree Generation");
-	exampleInvTabTreeGen();
+		mismatches = countOrderMismatches(order, TEST_11_N);
+		printf("%s: Visited = %d , Mismatches = %d\n", (k == 0) ? "Pre-Order" : "Post-Order", visitCount, mismatches);
+	}
 
-	/* ---------------------------------------------------------------------- */
-	
-	printUnitTestMsg(&testNum, "Example Balanced Binary Tree Generation");
-	validateBalancedTreeGen();
+	visitCount = 0;
+	preOrderCB(treeInfo.root, recordNode);
+	memcpy(order, visitOrder, TEST_11_N * sizeof(int));
+	for (distance=1; distance<=16; distance*=4)
+	{
+		setPrefetchDistance(distance);
+		visitCount = 0;
+		preOrderLookaheadCB(treeInfo.root, recordNode);
 
-	/* ---------------------------------------------------------------------- */
-	
-	printUnitTestMsg(&testNum, "Validate Tree Traversal Correctness");
-	validateTraversal();
+		mismatches = countOrderMismatches(order, TEST_11_N);
+		printf("Look-Ahead Pre-Order (Distance = %d): Visited = %d , Mismatches = %d\n", distance, visitCount, mismatches);
+	}
+	setPrefetchDistance(PREFETCH_DISTANCE);
+	make_empty(treeInfo.root);
+	printf("\n");
 
-	/* ---------------------------------------------------------------------- */
-	
-	printUnitTestMsg(&testNum, "Validate Mutli-Threaded Tree Traversal Correctness");
-	validateMultiThread();
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	initThreadPool(threadPool, startArgs, numThreads-1);
+
+	printf("Multi-Thread Prefetching Traversals: N = %d , Threads = %d\n", TEST_8_CHECK_N, numThreads);
+	printf("**********************************************************\n");
+	for (k=0; k<2; k++)
+	{
+		treeInfo = (k == 0) 
+			? genRandomTreeOptimized(invTable, itNodeArray, TEST_8_CHECK_N, false)
+			: genBalancedTreeOptimized(invTable, itNodeArray, TEST_8_CHECK_DEPTH, false);
+
+		clearStamps(treeInfo.root);
+		preOrderPrefetchMTWrapper(treeInfo.root, countNode, threadPool, startArgs);
+		printf("%s Tree, No Grain: Visited Once = %d\n", 
+			(k == 0) ? "Random" : "Balanced", countSingleVisits(treeInfo.root));
+
+		violations = 0;
+		clearStamps(treeInfo.root);
+		atomic_store(&visitStamp, 0);
+		postOrderPrefetchMTWrapper(treeInfo.root, stampNode, threadPool, startArgs);
+		checkPostOrderStamps(treeInfo.root, &violations);
+		printf("%s Tree, No Grain Post-Order: Violations = %d\n", 
+			(k == 0) ? "Random" : "Balanced", violations);
+
+		/* below the cutoff subtrees go through preOrderLookaheadCB */
+		setGrainPolicy(threadPool, GRAIN_SIZE, 1024);
+		clearStamps(treeInfo.root);
+		preOrderPrefetchMTWrapper(treeInfo.root, countNode, threadPool, startArgs);
+		printf("%s Tree, Size Grain: Visited Once = %d , Bad Sizes = %d\n", 
+			(k == 0) ? "Random" : "Balanced", countSingleVisits(treeInfo.root), 
+			countBadSizes(treeInfo.root, &size));
+
+		/* below the cutoff subtrees go through postOrderPrefetchCB */
+		violations = 0;
+		clearStamps(treeInfo.root);
+		atomic_store(&visitStamp, 0);
+		postOrderPrefetchMTWrapper(treeInfo.root, stampNode, threadPool, startArgs);
+		checkPostOrderStamps(treeInfo.root, &violations);
+		printf("%s Tree, Size Grain Post-Order: Violations = %d\n", 
+			(k == 0) ? "Random" : "Balanced", violations);
+		setGrainPolicy(threadPool, GRAIN_NONE, 0);
+
+		make_empty(treeInfo.root);
+	}
+	printf("\n");
+
+	destroyThreadPool(threadPool, startArgs);
+	free(threadPool);
+	free(startArgs);
+
+	free(order);
+	free(visitOrder);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+void validateNodeAllocators()
+{
+	int *invTable, *order;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo;
+	NodeAllocator allocator;
+	Tree *root;
+	int m, mismatches;
+	long bytes;
+
+	NodeAllocMode modes[5] = {ALLOC_MALLOC, ALLOC_ARENA, ALLOC_POOL, ALLOC_SHUFFLED, ALLOC_SHUFFLED};
+	double degrees[5] = {0, 0, 0, 0, 1.0};
+
+	invTable = (int *) malloc(TEST_12_N * sizeof(int));
+	itNodeArray = (ITNode *) malloc(TEST_12_N * sizeof(ITNode));
+	visitOrder = (int *) malloc(TEST_12_N * sizeof(int));
+	order = (int *) malloc(TEST_12_N * sizeof(int));
+
+	treeInfo = genRandomTreeOptimized(invTable, itNodeArray, TEST_12_N, false);
+	visitCount = 0;
+	preOrderCB(treeInfo.root, recordNode);
+	memcpy(order, visitOrder, TEST_12_N * sizeof(int));
+	make_empty(treeInfo.root);
+
+	printf("Node Allocators: N = %d , Slab = %d\n", TEST_12_N, TEST_12_SLAB);
+	printf("**********************************************************\n");
+	for (m=0; m<5; m++)
+	{
+		initNodeAllocator(&allocator, modes[m], TEST_12_SLAB, degrees[m]);
+		setNodeAllocator(&allocator);
+
+		root = invTab2BTOptimized(invTable, itNodeArray, TEST_12_N);
+		visitCount = 0;
+		preOrderCB(root, recordNode);
+		mismatches = countOrderMismatches(order, TEST_12_N);
+
+		printf("%s (Degree = %.1f): Mismatches = %d , Children Within 4 KB = %.1f%%", 
+			nodeAllocModeName(modes[m]), degrees[m], mismatches, 
+			100.0 * countNearChildren(root) / (TEST_12_N - 1));
+
+		/* a second tree must fit in the pool's recycled nodes, reset rewinds 
+			the arena to a single slab */
+		bytes = nodeAllocatorBytes(&allocator);
+		make_empty(root);
+		if (modes[m] == ALLOC_POOL)
+		{
+			root = invTab2BTOptimized(invTable, itNodeArray, TEST_12_N);
+			printf(" , Reused = %s", (nodeAllocatorBytes(&allocator) == bytes) ? "yes" : "no");
+			make_empty(root);
+		}
+		resetNodeAllocator(&allocator);
+		if (modes[m] != ALLOC_MALLOC)
+		{
+			printf(" , Slab Bytes = %ld -> %ld", bytes, nodeAllocatorBytes(&allocator));
+		}
+		printf("\n");
+
+		destroyNodeAllocator(&allocator);
+	}
+	printf("Current Allocator After Destroy = %s\n", (getNodeAllocator() == NULL) ? "malloc" : "stale");
+	printf("\n");
+
+	free(order);
+	free(visitOrder);
+	free(invTable);
+	free(itNodeArray);
+}
+
+void validateParallelGen(int numThreads)
+{
+	int *invTable, *invTable2;
+	Tree *btNodeArray, *btNodeArray2;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo;
+	unsigned long long seed;
+	double catalans[TEST_13_SPLIT_N+1], expected, leaves = 0;
+	int i, k, n, mismatches, counts[TEST_13_SPLIT_N] = {0};
+
+	invTable = (int *) malloc(TEST_13_N * sizeof(int));
+	invTable2 = (int *) malloc(TEST_13_N * sizeof(int));
+	btNodeArray = (Tree *) malloc(TEST_13_N * sizeof(Tree));
+	btNodeArray2 = (Tree *) malloc(TEST_13_N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(TEST_13_N * sizeof(ITNode));
+
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	ThreadPool *singlePool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	initThreadPool(threadPool, startArgs, numThreads-1);
+	initThreadPool(singlePool, NULL, 0);
+
+	printf("Catalan Split Distribution: n = %d , Samples = %d\n", TEST_13_SPLIT_N, TEST_13_SPLIT_SAMPLES);
+	printf("**********************************************************\n");
+	n = TEST_13_SPLIT_N;
+	catalans[0] = 1;
+	for (k=0; k<n; k++) catalans[k+1] = catalans[k] * 2 * (2*k + 1) / (k + 2);
+	for (i=0; i<TEST_13_SPLIT_SAMPLES; i++) counts[sampleCatalanSplit(n, genrand64_real2())]++;
+	for (k=0; k<n; k++)
+	{
+		expected = catalans[k] * catalans[n-1-k] / catalans[n];
+		printf("L = %2d: Expected = %.4f , Observed = %.4f\n", k, expected, (double) counts[k] / TEST_13_SPLIT_SAMPLES);
+	}
+	printf("\n");
+
+	printf("Multi-Thread Random Generation: N = %d , Threads = %d\n", TEST_13_N, numThreads);
+	printf("**********************************************************\n");
+	seed = genrand64_int64();
+	seedThreadPool(threadPool, seed);
+	treeInfo = genContRandomTreeMT(invTable, btNodeArray, itNodeArray, TEST_13_N, false, threadPool, startArgs);
+	printf("TreeInfo: Depth = %d , Leaves = %d | Measured: Depth = %d , Leaves = %d , Bad Sizes = %d\n", 
+		treeInfo.depth, treeInfo.leaves, treeHeight(treeInfo.root) - 1, countLeaves(treeInfo.root), 
+		countBadSizes(treeInfo.root, &k));
+
+	memcpy(invTable2, invTable, TEST_13_N * sizeof(int));
+	invTab2ContBTOptimized(invTable2, btNodeArray2, itNodeArray, TEST_13_N);
+	printf("Serial Rebuild From Table: Mismatches = %d\n", compareContTrees(btNodeArray, btNodeArray2, TEST_13_N));
+
+	seedThreadPool(singlePool, seed);
+	genContRandomTreeMT(invTable2, btNodeArray2, itNodeArray, TEST_13_N, false, singlePool, NULL);
+	for (i=0, mismatches=0; i<TEST_13_N; i++) mismatches += invTable[i] != invTable2[i];
+	printf("Same Seed With 1 Thread: Mismatches = %d\n", mismatches);
+
+	for (i=0; i<TEST_13_SAMPLES; i++)
+	{
+		leaves += genContRandomTreeMT(invTable, btNodeArray, itNodeArray, TEST_13_N, false, threadPool, startArgs).leaves;
+	}
+	expected = (double) TEST_13_N * (TEST_13_N + 1) / (2.0 * (2.0 * TEST_13_N - 1));
+	printf("Mean Leaves (%d Trees): Expected = %.1f , Observed = %.1f\n", TEST_13_SAMPLES, expected, leaves / TEST_13_SAMPLES);
+	printf("\n");
+
+	printf("Multi-Thread Balanced Generation: Depth = %d , Threads = %d\n", TEST_13_DEPTH, numThreads);
+	printf("**********************************************************\n");
+	n = (1<<(TEST_13_DEPTH+1)) - 1;
+	invTable = (int *) realloc(invTable, n * sizeof(int));
+	invTable2 = (int *) realloc(invTable2, n * sizeof(int));
+	btNodeArray = (Tree *) realloc(btNodeArray, n * sizeof(Tree));
+	btNodeArray2 = (Tree *) realloc(btNodeArray2, n * sizeof(Tree));
+	itNodeArray = (ITNode *) realloc(itNodeArray, n * sizeof(ITNode));
+	treeInfo = genContBalancedTreeMT(invTable, btNodeArray, itNodeArray, TEST_13_DEPTH, false, threadPool, startArgs);
+	genContBalancedTreeOptimized(invTable2, btNodeArray2, itNodeArray, TEST_13_DEPTH, false);
+	for (i=0, mismatches=0; i<n; i++) mismatches += invTable[i] != invTable2[i];
+	printf("TreeInfo: Depth = %d , Leaves = %d , Table Mismatches = %d , Node Mismatches = %d , Bad Sizes = %d\n", 
+		treeInfo.depth, treeInfo.leaves, mismatches, compareContTrees(btNodeArray, btNodeArray2, n), 
+		countBadSizes(treeInfo.root, &k));
+	printf("\n");
+
+	destroyThreadPool(threadPool, startArgs);
+	destroyThreadPool(singlePool, NULL);
+	free(threadPool);
+	free(singlePool);
+	free(startArgs);
+
+	free(invTable);
+	free(invTable2);
+	free(btNodeArray);
+	free(btNodeArray2);
+	free(itNodeArray);
+}
+
+/* compares both random generators: shape frequencies over all C(N) trees for 
+	small N (chi-square against uniform and against each other), then leaves 
+	and depth over larger trees, where TreeInfo must match the built tree */
+void validateDyckGen()
+{
+	RandomTreeGen gens[2] = {RANDOM_GEN_INVTABLE, RANDOM_GEN_DYCK};
+	int C = catalan(TEST_14_N);
+	int *invTable = (int *) malloc(TEST_14_TREE_N * sizeof(int));
+	int *invTabSet = (int *) malloc(C * TEST_14_N * sizeof(int));
+	int *tabSums[2];
+	Tree *btNodeArray = (Tree *) malloc(TEST_14_TREE_N * sizeof(Tree));
+	ITNode *itNodeArray = (ITNode *) malloc(TEST_14_TREE_N * sizeof(ITNode));
+	TreeInfo treeInfo;
+	double expected, chiSquare, meanLeaves, meanDepth, diff;
+	int g, i, mismatches;
+
+	genInvTabSet(invTabSet, TEST_14_N);
+	printf("Shape Distribution: N = %d , C = %d , Samples = %d\n", TEST_14_N, C, TEST_14_SAMPLES);
+	printf("**********************************************************\n");
+	expected = (double) TEST_14_SAMPLES / C;
+	for (g=0; g<2; g++)
+	{
+		setRandomTreeGen(gens[g]);
+		tabSums[g] = (int *) calloc(C, sizeof(int));
+		for (i=0; i<TEST_14_SAMPLES; i++)
+		{
+			genRandomInvTable(invTable, TEST_14_N, &treeInfo);
+			updateSums(invTable, invTabSet, tabSums[g], TEST_14_N, C);
+		}
+		for (i=0, chiSquare=0; i<C; i++)
+		{
+			diff = tabSums[g][i] - expected;
+			chiSquare += diff * diff / expected;
+		}
+		printf("%-8s: Chi-Square vs Uniform = %6.2f (%d dof)\n", randomTreeGenName(gens[g]), chiSquare, C-1);
+	}
+	for (i=0, chiSquare=0; i<C; i++)
+	{
+		diff = tabSums[0][i] - tabSums[1][i];
+		chiSquare += diff * diff / (tabSums[0][i] + tabSums[1][i]);
+	}
+	printf("invtable vs dyck: Chi-Square = %6.2f (%d dof)\n", chiSquare, C-1);
+	printf("\n");
+
+	printf("Tree Statistics: N = %d , Trees = %d\n", TEST_14_TREE_N, TEST_14_TREES);
+	printf("**********************************************************\n");
+	expected = (double) TEST_14_TREE_N * (TEST_14_TREE_N + 1) / (2.0 * (2.0 * TEST_14_TREE_N - 1));
+	printf("Expected Mean Leaves = %.1f\n", expected);
+	for (g=0; g<2; g++)
+	{
+		setRandomTreeGen(gens[g]);
+		meanLeaves = 0;
+		meanDepth = 0;
+		mismatches = 0;
+		for (i=0; i<TEST_14_TREES; i++)
+		{
+			/* alternate the fragmented and contiguous entry points */
+			if (i % 2) treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_14_TREE_N, false);
+			else treeInfo = genRandomTreeOptimized(invTable, itNodeArray, TEST_14_TREE_N, false);
+			mismatches += treeInfo.depth != treeHeight(treeInfo.root) - 1;
+			mismatches += treeInfo.leaves != countLeaves(treeInfo.root);
+			meanLeaves += treeInfo.leaves;
+			meanDepth += treeInfo.depth;
+			if (!(i % 2)) make_empty(treeInfo.root);
+		}
+		printf("%-8s: Mean Leaves = %.1f , Mean Depth = %.1f , TreeInfo Mismatches = %d\n", 
+			randomTreeGenName(gens[g]), meanLeaves / TEST_14_TREES, meanDepth / TEST_14_TREES, mismatches);
+	}
+	printf("\n");
+	setRandomTreeGen(RANDOM_GEN_INVTABLE);
+
+	free(invTable);
+	free(invTabSet);
+	free(tabSums[0]);
+	free(tabSums[1]);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+void validateRandStreams(int numThreads)
+{
+	RandStream a, b;
+	Tree *btNodeArray;
+	int *invTable;
+	ITNode *itNodeArray;
+	TreeInfo treeInfo;
+	uint64_t seed = genrand64_int64();
+	long counts[TEST_15_BUCKETS] = {0};
+	double mean = 0, expected, diff, chiSquare = 0;
+	int i, same, overlaps;
+	long checksum, checksum2;
+
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	ThreadPool *singlePool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	initThreadPool(threadPool, startArgs, numThreads-1);
+	initThreadPool(singlePool, NULL, 0);
+
+	printf("Stream Properties: Samples = %d\n", TEST_15_SAMPLES);
+	printf("**********************************************************\n");
+	initRandStream(&a, seed, 3);
+	initRandStream(&b, seed, 3);
+	for (i=0, same=0; i<TEST_15_SAMPLES; i++) same += randStreamNext(&a) == randStreamNext(&b);
+	initRandStream(&a, seed, 3);
+	initRandStream(&b, seed, 4);
+	for (i=0, overlaps=0; i<TEST_15_SAMPLES; i++) overlaps += randStreamNext(&a) == randStreamNext(&b);
+	printf("Same Seed And Stream: Equal Draws = %d / %d\n", same, TEST_15_SAMPLES);
+	printf("Neighbouring Streams: Equal Draws = %d\n", overlaps);
+
+	initRandStream(&a, seed, 0);
+	for (i=0; i<TEST_15_SAMPLES; i++)
+	{
+		mean += randStreamReal(&a);
+		counts[randStreamBelow(&a, TEST_15_BUCKETS)]++;
+	}
+	expected = (double) TEST_15_SAMPLES / TEST_15_BUCKETS;
+	for (i=0; i<TEST_15_BUCKETS; i++)
+	{
+		diff = counts[i] - expected;
+		chiSquare += diff * diff / expected;
+	}
+	printf("Mean Real = %.4f , Chi-Square (%d Buckets) = %.2f (%d dof)\n", 
+		mean / TEST_15_SAMPLES, TEST_15_BUCKETS, chiSquare, TEST_15_BUCKETS-1);
+	printf("\n");
+
+	invTable = (int *) malloc(TEST_15_N * sizeof(int));
+	btNodeArray = (Tree *) malloc(TEST_15_N * sizeof(Tree));
+	itNodeArray = (ITNode *) malloc(TEST_15_N * sizeof(ITNode));
+	treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_15_N, false);
+
+	printf("Per-Thread Streams In Callbacks: N = %d , Threads = %d\n", TEST_15_N, numThreads);
+	printf("**********************************************************\n");
+	seedThreadPool(threadPool, seed);
+	preOrderMTWrapper(treeInfo.root, drawNode, threadPool, startArgs);
+	printf("Ids Not From Own Thread Stream: %d\n", checkStreamDraws(btNodeArray, TEST_15_N, threadPool, seed));
+
+	seedThreadPool(singlePool, seed);
+	preOrderMTWrapper(treeInfo.root, drawNode, singlePool, NULL);
+	for (i=0, checksum=0; i<TEST_15_N; i++) checksum += btNodeArray[i].id;
+	seedThreadPool(singlePool, seed);
+	preOrderMTWrapper(treeInfo.root, drawNode, singlePool, NULL);
+	for (i=0, checksum2=0; i<TEST_15_N; i++) checksum2 += btNodeArray[i].id;
+	printf("Same Seed With 1 Thread: Checksums %s\n", (checksum == checksum2) ? "Match" : "Differ");
+	printf("\n");
+
+	destroyThreadPool(threadPool, startArgs);
+	destroyThreadPool(singlePool, NULL);
+	free(threadPool);
+	free(singlePool);
+	free(startArgs);
+
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+/* every reduce is checked against its serial version and the known answer 
+	(contiguous trees have ids 0..N-1) under each grain policy */
+void validateReduce(int numThreads)
+{
+	int *invTable = (int *) malloc(TEST_16_N * sizeof(int));
+	Tree *btNodeArray = (Tree *) malloc(TEST_16_N * sizeof(Tree));
+	ITNode *itNodeArray = (ITNode *) malloc(TEST_16_N * sizeof(ITNode));
+	GrainPolicy policies[3] = {GRAIN_NONE, GRAIN_DEPTH, GRAIN_LAZY};
+	int cutoffs[3] = {0, 8, 2};
+	TreeInfo treeInfo;
+	TreeStats stats;
+	ReduceAccOp statsOp = {&treeStatsInit, &treeStatsFold, &treeStatsMerge, sizeof(TreeStats), NULL};
+	int64_t count, matches, sum = (int64_t) TEST_16_N * (TEST_16_N - 1) / 2;
+	int i, p, key, wrong;
+
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	initThreadPool(threadPool, startArgs, numThreads-1);
+
+	printf("Accumulator Layout: sizeof(TraversalThread) = %zu , offsetof(acc) = %zu , Line = %d\n", 
+		sizeof(TraversalThread), offsetof(TraversalThread, acc), CACHE_LINE_SIZE);
+	printf("\n");
+
+	treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_16_N, false);
+	printf("Reduce Results: N = %d , Threads = %d , Runs = %d\n", TEST_16_N, numThreads, TEST_16_RUNS);
+	printf("**********************************************************\n");
+	printf("Serial: Count = %ld , Leaves = %ld , Sum = %ld (Expected %ld)\n", 
+		(long) traverseReduceSerial(treeInfo.root, &countMap, &addCombine, 0, NULL),
+		(long) traverseReduceSerial(treeInfo.root, &leafMap, &addCombine, 0, NULL),
+		(long) traverseReduceSerial(treeInfo.root, &idMap, &addCombine, 0, NULL), (long) sum);
+	treeStatsInit(&stats);
+	preOrderReduceAcc(treeInfo.root, &statsOp, &stats);
+	printf("Serial Stats: Count = %ld , Leaves = %ld , Sum = %ld , Min = %ld , Max = %ld\n", 
+		(long) stats.nodes, (long) stats.leaves, (long) stats.sumID, (long) stats.minID, (long) stats.maxID);
+
+	for (p=0; p<3; p++)
+	{
+		setGrainPolicy(threadPool, policies[p], cutoffs[p]);
+		for (i=0, wrong=0; i<TEST_16_RUNS; i++)
+		{
+			stats = treeStatsMT(treeInfo.root, threadPool, startArgs);
+			wrong += stats.nodes != TEST_16_N || stats.leaves != treeInfo.leaves || stats.sumID != sum;
+			wrong += stats.minID != 0 || stats.maxID != TEST_16_N - 1;
+
+			key = (i * 7919) % TEST_16_N;
+			matches = traverseReduce(treeInfo.root, &matchKeyMap, &addCombine, 0, &key, threadPool, startArgs);
+			wrong += matches != 1;
+		}
+		printf("%-6s: Wrong Runs = %d / %d\n", grainPolicyName(policies[p]), wrong, TEST_16_RUNS);
+	}
+	setGrainPolicy(threadPool, GRAIN_NONE, 0);
+
+	count = traverseReduce(NULL, &countMap, &addCombine, 0, NULL, threadPool, startArgs);
+	stats = treeStatsMT(NULL, threadPool, startArgs);
+	printf("Empty Tree: Count = %ld , Stats Count = %ld\n", (long) count, (long) stats.nodes);
+	printf("searchKeyMT: Matches = %ld\n", (long) searchKeyMT(treeInfo.root, threadPool, startArgs));
+	printf("\n");
+
+	destroyThreadPool(threadPool, startArgs);
+	free(threadPool);
+	free(startArgs);
+
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+void validateFindFirst(int numThreads)
+{
+	int *invTable = (int *) malloc(TEST_17_N * sizeof(int));
+	Tree *btNodeArray = (Tree *) malloc(TEST_17_N * sizeof(Tree));
+	ITNode *itNodeArray = (ITNode *) malloc(TEST_17_N * sizeof(ITNode));
+	GrainPolicy policies[3] = {GRAIN_NONE, GRAIN_DEPTH, GRAIN_LAZY};
+	int cutoffs[3] = {0, 8, 2};
+	TreeInfo treeInfo;
+	Tree *match;
+	int i, p, key, wrong;
+	long leftovers;
+
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	initThreadPool(threadPool, startArgs, numThreads-1);
+
+	treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_17_N, false);
+	printf("Find-First Lookups: N = %d , Threads = %d , Keys = %d\n", TEST_17_N, numThreads, TEST_17_KEYS);
+	printf("**********************************************************\n");
+	for (p=0; p<3; p++)
+	{
+		setGrainPolicy(threadPool, policies[p], cutoffs[p]);
+		for (i=0, wrong=0, leftovers=0; i<TEST_17_KEYS; i++)
+		{
+			key = (int) (genrand64_real2() * TEST_17_N);
+			match = findKeyMT(key, treeInfo.root, threadPool, startArgs);
+			wrong += match == NULL || match->id != key;
+			leftovers += countLeftovers(threadPool);
+		}
+		wrong += findKeyMT(-1, treeInfo.root, threadPool, startArgs) != NULL;
+		leftovers += countLeftovers(threadPool);
+		printf("%-6s: Wrong = %d , Deque Leftovers = %ld\n", grainPolicyName(policies[p]), wrong, leftovers);
+	}
+	setGrainPolicy(threadPool, GRAIN_NONE, 0);
+
+	match = findFirstMT(treeInfo.root, &leafPredicate, NULL, threadPool, startArgs);
+	printf("Many Matches: Leaf Returned = %s , Serial First Leaf Id = %d\n", 
+		(match != NULL && leafPredicate(match, NULL)) ? "Yes" : "No",
+		preOrderFind(treeInfo.root, &leafPredicate, NULL)->id);
+	printf("Empty Tree: %s\n", findFirstMT(NULL, &leafPredicate, NULL, threadPool, startArgs) == NULL ? "NULL" : "Not NULL");
+	printf("Count After Searches = %ld\n", 
+		(long) traverseReduce(treeInfo.root, &countMap, &addCombine, 0, NULL, threadPool, startArgs));
+	printf("\n");
+
+	destroyThreadPool(threadPool, startArgs);
+	free(threadPool);
+	free(startArgs);
+
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+void validateBlockingPool(int numThreads)
+{
+	int N = (1<<(TEST_18_DEPTH+1)) - 1;
+	int *invTable = (int *) malloc(N * sizeof(int));
+	Tree *btNodeArray = (Tree *) malloc(N * sizeof(Tree));
+	ITNode *itNodeArray = (ITNode *) malloc(N * sizeof(ITNode));
+	int *ids = (int *) malloc(N * sizeof(int));
+	const char *poolTypes[2] = {"Fresh", "Persistent"};
+	TreeInfo treeInfo;
+	struct timespec start;
+	double seconds;
+	int i, p, spares, wrong, runs = 0;
+
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	initThreadPool(threadPool, startArgs, numThreads-1);
+
+	treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_18_DEPTH, false);
+	for (i=0; i<N; i++) ids[i] = btNodeArray[i].id;
+
+	printf("Blocking Callbacks: N = %d , Threads = %d , Max Spares = %d\n", N, numThreads, TEST_18_SPARES);
+	printf("**********************************************************\n");
+	for (p=0; p<2; p++)
+	{
+		if (p == 1) launchPersistentThreadPool(threadPool, startArgs);
+		for (spares=0; spares<=TEST_18_SPARES; spares+=TEST_18_SPARES)
+		{
+			setBlockingLimit(threadPool, spares);
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			preOrderMTWrapper(treeInfo.root, &sleepIncrementNode, threadPool, startArgs);
+			seconds = elapsedSeconds(&start);
+			runs++;
+			for (i=0, wrong=0; i<N; i++) wrong += btNodeArray[i].id != ids[i] + runs;
+			printf("%-10s, Spares = %d: Wrong = %d , Spare Tasks = %d , Blocked After = %d , Wall Time = %.4f s\n",
+				poolTypes[p], spares, wrong, countSpareTasks(threadPool), 
+				atomic_load(&(threadPool->blockedThreads)), seconds);
+		}
+
+		// cpu-bound callbacks never block, so the spares must stay parked
+		preOrderMTWrapper(treeInfo.root, &incrementID, threadPool, startArgs);
+		runs++;
+		for (i=0, wrong=0; i<N; i++) wrong += btNodeArray[i].id != ids[i] + runs;
+		printf("%-10s, CPU-Bound: Wrong = %d , Spare Tasks = %d\n", poolTypes[p], wrong, countSpareTasks(threadPool));
+	}
+	sleepNode(btNodeArray);
+	printf("Outside Pool: Blocked = %d\n", atomic_load(&(threadPool->blockedThreads)));
+	printf("\n");
+
+	destroyThreadPool(threadPool, startArgs);
+	free(threadPool);
+	free(startArgs);
+
+	free(ids);
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+void validateFindBatch(int numThreads)
+{
+	int N = (1<<(TEST_19_DEPTH+1)) - 1;
+	int *invTable = (int *) malloc(TEST_19_N * sizeof(int));
+	Tree *btNodeArray = (Tree *) malloc(TEST_19_N * sizeof(Tree));
+	Tree *btNodeArray2 = (Tree *) malloc(N * sizeof(Tree));
+	ITNode *itNodeArray = (ITNode *) malloc(TEST_19_N * sizeof(ITNode));
+	int *keys = (int *) malloc(TEST_19_KEYS * sizeof(int));
+	Tree **results = (Tree **) malloc(TEST_19_KEYS * sizeof(Tree *));
+	int groups[5] = {1, 3, FIND_BATCH_GROUP, FIND_BATCH_MAX_GROUP, 1000};
+	const char *treeTypes[2] = {"Random", "Balanced"};
+	TreeInfo treeInfo, treeInfo2;
+	int i, g, t, wrong;
+
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	initThreadPool(threadPool, startArgs, numThreads-1);
+
+	// a few keys past either end must come back NULL
+	for (i=0; i<TEST_19_KEYS; i++)
+	{
+		keys[i] = (int) (genrand64_real2() * (TEST_19_N + 20)) - 10;
+	}
+
+	printf("Batched Lookups: N = %d , Keys = %d\n", TEST_19_N, TEST_19_KEYS);
+	printf("**********************************************************\n");
+	for (t=0; t<2; t++)
+	{
+		if (t == 0) treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_19_N, true);
+		else treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, 15, true);
+		printf("%-8s:", treeTypes[t]);
+		for (g=0; g<5; g++)
+		{
+			findBatchGroup(keys, TEST_19_KEYS, results, treeInfo.root, groups[g]);
+			for (i=0, wrong=0; i<TEST_19_KEYS; i++) wrong += results[i] != find(keys[i], treeInfo.root);
+			printf(" Group %d Wrong = %d ,", groups[g], wrong);
+		}
+		findBatch(keys, 5, results, treeInfo.root);
+		for (i=0, wrong=0; i<5; i++) wrong += results[i] != find(keys[i], treeInfo.root);
+		findBatch(keys, 0, results, NULL);
+		printf(" Short Batch Wrong = %d\n", wrong);
+	}
+
+	// same balanced shape twice: per-node find vs. multi-threaded batched lookups
+	initSearchTree();
+	treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_19_DEPTH, false);
+	treeInfo2 = genContBalancedTreeOptimized(invTable, btNodeArray2, itNodeArray, TEST_19_DEPTH, false);
+	preOrderCB(treeInfo.root, &searchTreeBenchmark);
+	preOrderBatchMTWrapper(treeInfo2.root, &searchTreeBenchmarkBatch, NULL, threadPool, startArgs);
+	for (i=0, wrong=0; i<N; i++)
+	{
+		wrong += btNodeArray[i].id != btNodeArray2[i].id || btNodeArray[i].data != btNodeArray2[i].data;
+	}
+	printf("Search Tree Benchmark: Threads = %d , Batched Mismatches = %d\n", numThreads, wrong);
+	printf("\n");
+	freeSearchTree();
+
+	destroyThreadPool(threadPool, startArgs);
+	free(threadPool);
+	free(startArgs);
+
+	free(keys);
+	free(results);
+	free(invTable);
+	free(btNodeArray);
+	free(btNodeArray2);
+	free(itNodeArray);
+}
+
+void validateSearchArrays()
+{
+	int N = (1<<(TEST_20_DEPTH+1)) - 1;
+	int *invTable = (int *) malloc(TEST_20_N * sizeof(int));
+	Tree *btNodeArray = (Tree *) malloc(TEST_20_N * sizeof(Tree));
+	ITNode *itNodeArray = (ITNode *) malloc(TEST_20_N * sizeof(ITNode));
+	int *ids = (int *) malloc(N * sizeof(int));
+	int *foundIDs = (int *) malloc(N * sizeof(int));
+	// around the B-tree's node size and a few levels of it
+	int sizes[8] = {1, 2, 15, 16, 17, 273, 4000, TEST_20_N};
+	SearchStructure structures[3] = {SEARCH_BST, SEARCH_EYTZINGER, SEARCH_BTREE};
+	SearchArray eytzinger, btree;
+	TreeInfo treeInfo;
+	Tree *expect, *found;
+	int i, n, s, wrongE, wrongB, wrongS, wrong, hits;
+
+	printf("Search Arrays: SIMD = %s\n", soaSimdName());
+	printf("**********************************************************\n");
+	for (n=0; n<8; n++)
+	{
+		// random shapes, every key in range plus a few past either end
+		treeInfo = genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, sizes[n], true);
+		initEytzinger(&eytzinger, treeInfo.root);
+		initSearchBTree(&btree, treeInfo.root);
+		for (i=-10, wrongE=0, wrongB=0, wrongS=0; i<sizes[n]+10; i++)
+		{
+			expect = find(i, treeInfo.root);
+			wrongE += findEytzinger(i, &eytzinger) != expect;
+			wrongB += findSearchBTree(i, &btree) != expect;
+			wrongS += findSearchBTreeScalar(i, &btree) != expect;
+		}
+		printf(
+			"N = %-6d: Eytzinger Wrong = %d , B-Tree Wrong = %d , B-Tree Scalar Wrong = %d\n", 
+			sizes[n], wrongE, wrongB, wrongS
+		);
+		freeSearchArray(&eytzinger);
+		freeSearchArray(&btree);
+	}
+
+	// searchTreeBenchmark must find the same keys whatever it searches
+	treeInfo = genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_20_DEPTH, false);
+	for (i=0; i<N; i++) ids[i] = btNodeArray[i].id;
+	for (s=0; s<3; s++)
+	{
+		setSearchStructure(structures[s]);
+		initSearchTree();
+		for (i=0; i<N; i++)
+		{
+			btNodeArray[i].id = ids[i];
+			btNodeArray[i].data = NULL;
+		}
+		preOrderCB(treeInfo.root, &searchTreeBenchmark);
+		for (i=0, wrong=0, hits=0; i<N; i++)
+		{
+			found = (Tree *) btNodeArray[i].data;
+			if (found != NULL) hits++;
+			if (found != NULL && found->id != btNodeArray[i].id) wrong++;
+			if (s == 0) foundIDs[i] = (found != NULL) ? found->id : -1;
+			else wrong += foundIDs[i] != ((found != NULL) ? found->id : -1);
+		}
+		printf(
+			"Search Tree Benchmark: Structure = %-9s , Hits = %d , Wrong = %d\n", 
+			searchStructureName(structures[s]), hits, wrong
+		);
+		freeSearchTree();
+	}
+	setSearchStructure(SEARCH_BST);
+	printf("\n");
+
+	free(invTable);
+	free(btNodeArray);
+	free(itNodeArray);
+	free(ids);
+	free(foundIDs);
+}
+
+/* returns the subtree's size, bad counts nodes out of order, with a stale 
+	subtreeSize, or heavier than 3x their sibling */
+int checkWeightBalanced(Tree *t, int64_t lo, int64_t hi, int *bad)
+{
+	int l, r;
+	if (t == NULL) return 0;
+	l = checkWeightBalanced(t->left, lo, t->id, bad);
+	r = checkWeightBalanced(t->right, t->id, hi, bad);
+	*bad += t->id <= lo || t->id >= hi;
+	*bad += t->subtreeSize != l + r + 1;
+	*bad += l + 1 > 3 * (r + 1) || r + 1 > 3 * (l + 1);
+	return l + r + 1;
+}
+
+void validateBalancedBST()
+{
+	int *keys = (int *) malloc(TEST_21_N * sizeof(int));
+	const char *streams[3] = {"Sorted", "Random", "Zipf"};
+	Tree *balanced, *unbalanced;
+	int i, s, bad, size, wrong;
+
+	printf("Weight-Balanced BST: Keys = %d\n", TEST_21_N);
+	printf("**********************************************************\n");
+	for (s=0; s<3; s++)
+	{
+		if (s == 0) for (i=0; i<TEST_21_N; i++) keys[i] = i;
+		else if (s == 1) for (i=0; i<TEST_21_N; i++) keys[i] = (int) (genrand64_real2() * TEST_21_N);
+		else genZipfKeys(keys, TEST_21_N, TEST_21_N, 0.99);
+
+		balanced = unbalanced = NULL;
+		setBalanceMode(BALANCE_NONE);
+		for (i=0; i<TEST_21_N; i++) unbalanced = insert(keys[i], NULL, unbalanced);
+		setBalanceMode(BALANCE_WEIGHT);
+		for (i=0; i<TEST_21_N; i++) balanced = insert(keys[i], NULL, balanced);
+
+		bad = 0;
+		size = checkWeightBalanced(balanced, INT64_MIN, INT64_MAX, &bad);
+		for (i=0, wrong=0; i<TEST_21_N; i++) wrong += (find(i, balanced) == NULL) != (find(i, unbalanced) == NULL);
+		printf(
+			"%-6s: Size = %d , Height = %d (Unbalanced %d) , Bad Nodes = %d , Wrong = %d", 
+			streams[s], size, treeHeight(balanced), treeHeight(unbalanced), bad, wrong
+		);
+
+		// delete the first half of the stream (duplicates are already gone)
+		setBalanceMode(BALANCE_NONE);
+		for (i=0; i<TEST_21_N/2; i++) unbalanced = delete(keys[i], unbalanced, NULL);
+		setBalanceMode(BALANCE_WEIGHT);
+		for (i=0; i<TEST_21_N/2; i++) balanced = delete(keys[i], balanced, NULL);
+
+		bad = 0;
+		size = checkWeightBalanced(balanced, INT64_MIN, INT64_MAX, &bad);
+		for (i=0, wrong=0; i<TEST_21_N; i++) wrong += (find(i, balanced) == NULL) != (find(i, unbalanced) == NULL);
+		printf(" | After Deletes: Size = %d , Bad Nodes = %d , Wrong = %d\n", size, bad, wrong);
+
+		balanced = make_empty(balanced);
+		unbalanced = make_empty(unbalanced);
+	}
+	setBalanceMode(BALANCE_NONE);
+	printf("\n");
+
+	free(keys);
+}
+
+/* nobody else touches an owned key, so every result can be checked on the spot */
+void * concurrentTestThread(void *arg)
+{
+	ConcurrentTestArgs *args = (ConcurrentTestArgs *) arg;
+	RandStream rng;
+	int i, key, owned, violations = 0;
+	uint64_t r;
+
+	initRandStream(&rng, RAND_STREAM_SEED, args->threadID);
+	owned = (TEST_22_KEYS - args->threadID + args->numThreads - 1) / args->numThreads;
+	for (i=0; i<args->ops; i++)
+	{
+		r = randStreamBelow(&rng, 4);
+		key = args->threadID + args->numThreads * (int) randStreamBelow(&rng, owned);
+		if (r == 0)
+		{
+			violations += concurrentInsert(args->tree, key, NULL) == args->expected[key];
+			args->expected[key] = true;
+		}
+		else if (r == 1)
+		{
+			violations += concurrentDelete(args->tree, key) != args->expected[key];
+			args->expected[key] = false;
+		}
+		else if (r == 2)
+		{
+			violations += concurrentFind(args->tree, key) != args->expected[key];
+		}
+		else
+		{
+			concurrentFind(args->tree, (int) randStreamBelow(&rng, TEST_22_KEYS));
+		}
+	}
+	atomic_fetch_add(args->violations, violations);
+	return NULL;
+}
+
+/* deleted nodes with at most one child that are still linked once every 
+	thread is done (each of them should have been unlinked) */
+int countDeadNodes(ConcurrentNode *node)
+{
+	ConcurrentNode *left, *right;
+	if (node == NULL) return 0;
+	left = atomic_load(&(node->left));
+	right = atomic_load(&(node->right));
+	return (atomic_load(&(node->deleted)) && (left == NULL || right == NULL))
+		+ countDeadNodes(left) + countDeadNodes(right);
+}
+
+/* rounds of numThreads threads with the same key split, so expected carries 
+	over from round to round */
+void runConcurrentRound(
+	ConcurrentTestArgs *args, pthread_t *threads, int numThreads, int ops
+)
+{
+	int i;
+	for (i=0; i<numThreads; i++)
+	{
+		args[i].threadID = i;
+		args[i].numThreads = numThreads;
+		args[i].ops = ops;
+		pthread_create(&threads[i], NULL, &concurrentTestThread, &args[i]);
+	}
+	for (i=0; i<numThreads; i++) pthread_join(threads[i], NULL);
+}
+
+void validateConcurrentBST(int numThreads)
+{
+	ConcurrentTestArgs *args = (ConcurrentTestArgs *) malloc(numThreads * sizeof(ConcurrentTestArgs));
+	pthread_t *threads = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
+	bool *expected = (bool *) calloc(TEST_22_KEYS, sizeof(bool));
+	ConcurrentTree tree;
+	atomic_int violations;
+	int i, k, rounds, wrong, count;
+	long pending;
+
+	atomic_init(&violations, 0);
+	initConcurrentTree(&tree);
+	for (i=0; i<numThreads; i++)
+	{
+		args[i].tree = &tree;
+		args[i].expected = expected;
+		args[i].violations = &violations;
+	}
+
+	printf(
+		"Concurrent BST: Threads = %d , Keys = %d , Ops/Thread = %d\n", 
+		numThreads, TEST_22_KEYS, TEST_22_OPS
+	);
+	printf("**********************************************************\n");
+	// then enough short-lived threads to go through every epoch slot twice
+	rounds = 2 * EBR_MAX_THREADS / numThreads + 1;
+	for (k=0; k<2; k++)
+	{
+		if (k == 0) runConcurrentRound(args, threads, numThreads, TEST_22_OPS);
+		else for (i=0; i<rounds; i++) runConcurrentRound(args, threads, numThreads, TEST_22_SHORT_OPS);
+
+		for (i=0, wrong=0, count=0; i<TEST_22_KEYS; i++)
+		{
+			wrong += concurrentFind(&tree, i) != expected[i];
+			count += expected[i];
+		}
+		pending = epochPendingNodes();
+
+		if (k == 1) printf("Short-Lived Threads = %d (Slots = %d)\n", rounds * numThreads, EBR_MAX_THREADS);
+		printf("Violations = %d , Wrong After = %d , Size = %d (Expected %d) , Dead Nodes = %d\n", 
+			atomic_load(&violations), wrong, concurrentTreeCount(&tree), count, 
+			countDeadNodes(atomic_load(&(tree.root->left))));
+		printf("Nodes Waiting For Reclamation = %ld\n", pending);
+	}
+	printf("\n");
+
+	destroyConcurrentTree(&tree);
+	free(args);
+	free(threads);
+	free(expected);
+}
+
+/* in-order walk against keys[0, n) plus exact subtreeSize, returns the size */
+int checkBulkBST(Tree *t, int *keys, int n, int *next, int *bad)
+{
+	int l, r;
+	if (t == NULL) return 0;
+	l = checkBulkBST(t->left, keys, n, next, bad);
+	*bad += *next >= n || t->id != keys[*next];
+	(*next)++;
+	r = checkBulkBST(t->right, keys, n, next, bad);
+	*bad += t->subtreeSize != l + r + 1;
+	return l + r + 1;
+}
+
+/* a contiguous build must sit in base in pre-order */
+int checkPreOrderLayout(Tree *t, Tree *base, int *next)
+{
+	if (t == NULL) return 0;
+	return (t != base + (*next)++)
+		+ checkPreOrderLayout(t->left, base, next)
+		+ checkPreOrderLayout(t->right, base, next);
+}
+
+void validateBulkBST(int numThreads)
+{
+	int sizes[5] = {1, 2, 3, 100, TEST_23_N};
+	const char *variants[4] = {"Serial", "MT", "Serial Cont", "MT Cont"};
+	int *keys = (int *) malloc(3 * TEST_23_N * sizeof(int));
+	int *batch = (int *) malloc(TEST_23_N * sizeof(int));
+	int *merged = (int *) malloc(3 * TEST_23_N * sizeof(int));
+	Tree *btNodeArray = (Tree *) malloc(TEST_23_N * sizeof(Tree));
+	Tree *serial, *parallel;
+	TreeInfo treeInfo;
+	int i, s, v, n, m, next, bad, size, minHeight, layout;
+
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	initThreadPool(threadPool, startArgs, numThreads-1);
+
+	printf("Bulk BST Build From Sorted Keys: Threads = %d\n", numThreads);
+	printf("**********************************************************\n");
+	for (i=0; i<TEST_23_N; i++) keys[i] = 2*i;
+	for (s=0; s<5; s++)
+	{
+		n = sizes[s];
+		for (minHeight=0; (1L << minHeight) - 1 < n; minHeight++);
+		for (v=0; v<4; v++)
+		{
+			if (v == 0) treeInfo = buildBSTSorted(keys, n, NULL);
+			else if (v == 1) treeInfo = buildBSTSortedMT(keys, n, NULL, threadPool, startArgs);
+			else if (v == 2) treeInfo = buildBSTSorted(keys, n, btNodeArray);
+			else treeInfo = buildBSTSortedMT(keys, n, btNodeArray, threadPool, startArgs);
+
+			next = bad = layout = 0;
+			size = checkBulkBST(treeInfo.root, keys, n, &next, &bad);
+			if (v >= 2)
+			{
+				next = 0;
+				layout = checkPreOrderLayout(treeInfo.root, btNodeArray, &next);
+			}
+			printf(
+				"N = %6d %-11s: Size = %d , Height = %d (Min %d, TreeInfo %d) , Leaves = %d (TreeInfo %d) , Bad Nodes = %d , Layout Errors = %d\n", 
+				n, variants[v], size, treeHeight(treeInfo.root), minHeight, treeInfo.depth + 1, 
+				countLeaves(treeInfo.root), treeInfo.leaves, bad, layout
+			);
+			if (v < 2) make_empty(treeInfo.root);
+		}
+	}
+	printf("\n");
+
+	// even keys below 2N, batch of multiples of 3 below 3N (overlaps and runs off the right)
+	for (i=0, m=0; i<TEST_23_N; i++) batch[i] = 3*i;
+	for (i=0; i<3*TEST_23_N; i++) if ((i % 2 == 0 && i < 2*TEST_23_N) || i % 3 == 0) merged[m++] = i;
+
+	printf("Bulk Insert Of A Sorted Batch: Tree = %d , Batch = %d , Threads = %d\n", TEST_23_N, TEST_23_N, numThreads);
+	printf("**********************************************************\n");
+	serial = buildBSTSorted(keys, TEST_23_N, NULL).root;
+	parallel = buildBSTSorted(keys, TEST_23_N, NULL).root;
+	serial = insertSorted(serial, batch, TEST_23_N);
+	parallel = insertSortedMT(parallel, batch, TEST_23_N, threadPool, startArgs);
+
+	next = bad = 0;
+	size = checkBulkBST(serial, merged, m, &next, &bad);
+	printf("Serial: Size = %d (Expected %d) , Bad Nodes = %d\n", size, m, bad);
+	next = bad = 0;
+	size = checkBulkBST(parallel, merged, m, &next, &bad);
+	printf("MT    : Size = %d (Expected %d) , Bad Nodes = %d\n", size, m, bad);
+
+	// merging into an empty tree is a plain build
+	make_empty(parallel);
+	parallel = insertSortedMT(NULL, batch, TEST_23_N, threadPool, startArgs);
+	next = bad = 0;
+	size = checkBulkBST(parallel, batch, TEST_23_N, &next, &bad);
+	printf("MT Into Empty Tree: Size = %d , Height = %d , Bad Nodes = %d\n", size, treeHeight(parallel), bad);
+	printf("\n");
+
+	make_empty(serial);
+	make_empty(parallel);
+	destroyThreadPool(threadPool, startArgs);
+	free(threadPool);
+	free(startArgs);
+
+	free(keys);
+	free(batch);
+	free(merged);
+	free(btNodeArray);
+}
+
+/* ids in-order, with the pre-order ids they pin down a tree with distinct ids */
+void recordInOrder(Tree *root)
+{
+	if (root == NULL) return;
+	recordInOrder(root->left);
+	visitOrder[visitCount++] = root->id;
+	recordInOrder(root->right);
+}
+
+/* nodes not at btNodeArray[i] for the i-th node of a BFS */
+int checkBFSLayout(Tree *root, Tree *btNodeArray, int N)
+{
+	Tree **queue = (Tree **) malloc(N * sizeof(Tree *));
+	int head = 0, tail = 0, misplaced = 0;
+
+	queue[tail++] = root;
+	while (head < tail)
+	{
+		root = queue[head];
+		misplaced += root != btNodeArray + head++;
+		if (root->left != NULL) queue[tail++] = root->left;
+		if (root->right != NULL) queue[tail++] = root->right;
+	}
+	free(queue);
+	return misplaced;
+}
+
+int checkVebLayout(Tree *root, int height, Tree *start, int *misplaced);
+
+int checkVebBottoms(Tree *root, int depth, int top, int rest, Tree *start, int *misplaced)
+{
+	int n;
+	if (root == NULL) return 0;
+	if (depth == top) return checkVebLayout(root, rest, start, misplaced);
+	n = checkVebBottoms(root->left, depth+1, top, rest, start, misplaced);
+	return n + checkVebBottoms(root->right, depth+1, top, rest, start + n, misplaced);
+}
+
+/* the nodes less than height levels below root must fill the array from start 
+	as the top half followed by each bottom tree left to right, recursively. 
+	returns how many there are */
+int checkVebLayout(Tree *root, int height, Tree *start, int *misplaced)
+{
+	int n;
+	if (root == NULL) return 0;
+	if (height == 1)
+	{
+		*misplaced += root != start;
+		return 1;
+	}
+	n = checkVebLayout(root, height/2, start, misplaced);
+	return n + checkVebBottoms(root, 0, height/2, height - height/2, start + n, misplaced);
+}
+
+/* blockHeight levels below root in BFS order from start, then the blocks 
+	hanging off it one after the other. returns the nodes checked */
+int checkBlockedLayout(Tree *root, int blockHeight, Tree *start, int *misplaced)
+{
+	Tree **queue = (Tree **) malloc((2 << blockHeight) * sizeof(Tree *));
+	int head = 0, tail = 0, levelEnd, depth, n = 0;
+
+	queue[tail++] = root;
+	for (depth=0; depth<blockHeight && head<tail; depth++)
+	{
+		for (levelEnd=tail; head<levelEnd; head++)
+		{
+			root = queue[head];
+			*misplaced += root != start + n++;
+			if (root->left != NULL) queue[tail++] = root->left;
+			if (root->right != NULL) queue[tail++] = root->right;
+		}
+	}
+	for (; head<tail; head++) n += checkBlockedLayout(queue[head], blockHeight, start + n, misplaced);
+
+	free(queue);
+	return n;
+}
+
+void validateRelayouts()
+{
+	TreeLayout layouts[3] = {LAYOUT_BFS, LAYOUT_VEB, LAYOUT_BLOCKED};
+	int *invTable = (int *) malloc(TEST_24_N * sizeof(int));
+	int *preOrder = (int *) malloc(TEST_24_N * sizeof(int));
+	int *inOrder = (int *) malloc(TEST_24_N * sizeof(int));
+	Tree *btNodeArray = (Tree *) malloc(TEST_24_N * sizeof(Tree));
+	ITNode *itNodeArray = (ITNode *) malloc(TEST_24_N * sizeof(ITNode));
+	Tree *root;
+	TreeInfo treeInfo;
+	int k, l, n, blockHeight = 0, preMismatches, inMismatches, misplaced;
+
+	while ((int) (((2 << blockHeight) - 1) * sizeof(Tree)) <= LAYOUT_BLOCK_BYTES) blockHeight++;
+	visitOrder = (int *) malloc(TEST_24_N * sizeof(int));
+
+	printf("Contiguous Relayouts: N = %d (Random) , Depth = %d (Balanced) , Block Height = %d\n", 
+		TEST_24_N, TEST_24_DEPTH, blockHeight);
+	printf("**********************************************************\n");
+	for (k=0; k<2; k++)
+	{
+		treeInfo = (k == 0) 
+			? genContRandomTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_24_N, false)
+			: genContBalancedTreeOptimized(invTable, btNodeArray, itNodeArray, TEST_24_DEPTH, false);
+		n = treeInfo.size;
+
+		visitCount = 0;
+		preOrderCB(treeInfo.root, recordNode);
+		memcpy(preOrder, visitOrder, n * sizeof(int));
+		visitCount = 0;
+		recordInOrder(treeInfo.root);
+		memcpy(inOrder, visitOrder, n * sizeof(int));
+
+		for (l=0; l<3; l++)
+		{
+			// the table rebuilds the pre-order tree for every layout
+			root = relayoutContTree(invTab2ContBTOptimized(invTable, btNodeArray, itNodeArray, n), btNodeArray, n, layouts[l]);
+
+			visitCount = 0;
+			preOrderCB(root, recordNode);
+			preMismatches = countOrderMismatches(preOrder, n);
+			visitCount = 0;
+			recordInOrder(root);
+			inMismatches = countOrderMismatches(inOrder, n);
+
+			misplaced = (root != btNodeArray);
+			if (layouts[l] == LAYOUT_BFS) misplaced += checkBFSLayout(root, btNodeArray, n);
+			else if (layouts[l] == LAYOUT_VEB) checkVebLayout(root, treeHeight(root), btNodeArray, &misplaced);
+			else checkBlockedLayout(root, blockHeight, btNodeArray, &misplaced);
+
+			printf(
+				"%-8s %-18s: Pre-Order Mismatches = %d , In-Order Mismatches = %d , Misplaced = %d\n", 
+				(k == 0) ? "Random" : "Balanced", layoutName(layouts[l]), preMismatches, inMismatches, misplaced
+			);
+		}
+	}
+	printf("\n");
+
+	free(visitOrder);
+	free(invTable);
+	free(preOrder);
+	free(inOrder);
+	free(btNodeArray);
+	free(itNodeArray);
+}
+
+void recordCompactNode(CompactTree *t)
+{
+	visitOrder[visitCount++] = t->id;
+}
+
+void stampCompactNode(CompactTree *t)
+{
+	compactStamps[t - compactNodes] = atomic_fetch_add(&visitStamp, 1) + 1;
+}
+
+/* unstamped nodes plus nodes stamped before their parent (pre-order) or after 
+	it (post-order) */
+int checkCompactStamps(uint32_t root, long parentStamp, bool postOrder)
+{
+	long stamp;
+	if (root == COMPACT_NULL) return 0;
+	stamp = compactStamps[root];
+	return (stamp == 0 || (parentStamp != 0 && (postOrder ? stamp >= parentStamp : stamp <= parentStamp)))
+		+ checkCompactStamps(compactNodes[root].left, stamp, postOrder)
+		+ checkCompactStamps(compactNodes[root].right, stamp, postOrder);
+}
+
+/* compact trees come from the compact generators, the Tree version is built 
+	from the same inversion table so both have the same shape and ids */
+void validateCompactTraversals(int numThreads)
+{
+	const char *names[3] = {"Pre-Order", "Post-Order", "Level-Order"};
+	int *invTable = (int *) malloc(TEST_25_N * sizeof(int));
+	int *order = (int *) malloc(TEST_25_N * sizeof(int));
+	Tree *btNodeArray = (Tree *) malloc(TEST_25_N * sizeof(Tree));
+	ITNode *itNodeArray = (ITNode *) malloc(TEST_25_N * sizeof(ITNode));
+	uint32_t *queue = (uint32_t *) malloc(TEST_25_N * sizeof(uint32_t));
+	TreeQueue treeQueue;
+	TreeInfo treeInfo;
+	Tree *root;
+	int k, t, n, mismatches, violations;
+
+	compactNodes = (CompactTree *) malloc(TEST_25_N * sizeof(CompactTree));
+	compactStamps = (long *) malloc(TEST_25_N * sizeof(long));
+	visitOrder = (int *) malloc(TEST_25_N * sizeof(int));
+	initTQ(&treeQueue, TEST_25_N);
+
+	ThreadPool *threadPool = (ThreadPool *) aligned_alloc(CACHE_LINE_SIZE, sizeof(ThreadPool));
+	StartThreadArgs *startArgs = (StartThreadArgs *) malloc(numThreads * sizeof(StartThreadArgs));
+	initThreadPool(threadPool, startArgs, numThreads-1);
+
+	printf("Compact vs. Tree Traversals: N = %d (Random) , Depth = %d (Balanced) , Threads = %d\n", 
+		TEST_25_N, TEST_25_DEPTH, numThreads);
+	printf("**********************************************************\n");
+	for (t=0; t<2; t++)
+	{
+		treeInfo = (t == 0) 
+			? genCompactRandomTree(invTable, compactNodes, itNodeArray, TEST_25_N, false)
+			: genCompactBalancedTree(invTable, compactNodes, itNodeArray, TEST_25_DEPTH, false);
+		n = treeInfo.size;
+		root = invTab2ContBTOptimized(invTable, btNodeArray, itNodeArray, n);
+
+		for (k=0; k<3; k++)
+		{
+			visitCount = 0;
+			if (k == 0) preOrderCB(root, recordNode);
+			if (k == 1) postOrderCB(root, recordNode);
+			if (k == 2) levelOrderCB(root, &treeQueue, recordNode);
+			memcpy(order, visitOrder, n * sizeof(int));
+
+			visitCount = 0;
+			if (k == 0) preOrderCompactCB(compactNodes, 0, recordCompactNode);
+			if (k == 1) postOrderCompactCB(compactNodes, 0, recordCompactNode);
+			if (k == 2) levelOrderCompactCB(compactNodes, 0, queue, recordCompactNode);
+
+			mismatches = countOrderMismatches(order, n);
+			printf("%-8s %-11s: Visited = %d , Mismatches = %d\n", 
+				(t == 0) ? "Random" : "Balanced", names[k], visitCount, mismatches);
+		}
+
+		// every node once, parents before (pre) or after (post) their children
+		for (k=0; k<2; k++)
+		{
+			memset(compactStamps, 0, n * sizeof(long));
+			atomic_store(&visitStamp, 0);
+			if (k == 0) preOrderCompactMTWrapper(compactNodes, 0, stampCompactNode, threadPool, startArgs);
+			else postOrderCompactMTWrapper(compactNodes, 0, stampCompactNode, threadPool, startArgs);
+			violations = checkCompactStamps(0, 0, k == 1);
+			printf("%-8s %-11s MT: Visited = %ld , Violations = %d\n", 
+				(t == 0) ? "Random" : "Balanced", names[k], atomic_load(&visitStamp), violations);
+		}
+	}
+	printf("\n");
+
+	destroyThreadPool(threadPool, startArgs);
+	free(threadPool);
+	free(startArgs);
+
+	freeTQ(&treeQueue);
+	free(compactNodes);
+	free(compactStamps);
+	free(visitOrder);
+	free(invTable);
+	free(order);
+	free(btNodeArray);
+	free(itNodeArray);
+	free(queue);
+}
+
+/******************************************************************************* 
+------------------------------------- MAIN -------------------------------------
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+	/* ---------------------------------------------------------------------- */
+	printf("\n");
+	printf("###############################################################################\n");
+	printf("########################### Binary Tree Unit Tests ############################\n");
+	printf("###############################################################################\n");
+	printf("\n");
+
+	int testNum = 1;
+	init_genrand64(time(0));
+
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Validate Binary Search Tree Structure");
+	validateBST();
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Validate Inversion Table Gen. Correctness");
+	validateInvTabGen();
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Example Inversion Table Direct to Output");
+	exampleInvTab2Output();
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Validate Inversion Table Translation Correctness");
+	validateInvTabTranslation();
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Example Random Binary Tree Generation");
+	exampleInvTabTreeGen();
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Example Balanced Binary Tree Generation");
+	validateBalancedTreeGen();
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Validate Tree Traversal Correctness");
+	validateTraversal();
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Validate Mutli-Threaded Tree Traversal Correctness");
+	validateMultiThread(getNumThreads(argc, argv));
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Validate Structure-of-Arrays Tree and Bulk Kernels");
+	validateSoA();
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Validate Batched Callback Traversals");
+	validateBatchCallbacks(getNumThreads(argc, argv));
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Validate Prefetching Traversals");
+	validatePrefetchTraversals(getNumThreads(argc, argv));
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Validate Node Allocators");
+	validateNodeAllocators();
+
+	/* ---------------------------------------------------------------------- */
+	
+	printUnitTestMsg(&testNum, "Validate Parallel Tree Generation");
+	validateParallelGen(getNumThreads(argc, argv));
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Integer-Only Random Tree Generator");
+	validateDyckGen();
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Per-Thread Random Streams");
+	validateRandStreams(getNumThreads(argc, argv));
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Reduce Traversals");
+	validateReduce(getNumThreads(argc, argv));
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Parallel Find-First");
+	validateFindFirst(getNumThreads(argc, argv));
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Blocking-Aware Thread Pool");
+	validateBlockingPool(getNumThreads(argc, argv));
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Batched Interleaved Lookups");
+	validateFindBatch(getNumThreads(argc, argv));
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Eytzinger and B-Tree Search Arrays");
+	validateSearchArrays();
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Weight-Balanced Insert/Delete");
+	validateBalancedBST();
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Concurrent BST");
+	validateConcurrentBST(getNumThreads(argc, argv));
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Bulk BST Build and Sorted Insert");
+	validateBulkBST(getNumThreads(argc, argv));
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Contiguous Tree Relayouts");
+	validateRelayouts();
+
+	/* ---------------------------------------------------------------------- */
+
+	printUnitTestMsg(&testNum, "Validate Compact Tree Traversals");
+	validateCompactTraversals(getNumThreads(argc, argv));
 
 	/* ---------------------------------------------------------------------- */
 
@@ -22,7 +22,8 @@
 *******************************************************************************/
 #include "types.h"
 
-#define NUM_THREADS 2
+/* env var read by getNumThreads when no -t/--threads flag is passed */
+#define NUM_THREADS_ENV "TREE_NUM_THREADS"
 
 
 
@@ -30,7 +31,10 @@
 ---------------------------- FUNCTION DECLARATIONS -----------------------------
 *******************************************************************************/
 
-extern int threadLoads[];
+extern int numThreads;
+extern int *threadLoads;
+extern int getNumThreads(int argc, char *argv[]);
+extern void setNumThreads(int n);
 extern void resetThreadLoads();
 
 
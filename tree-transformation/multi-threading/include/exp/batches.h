@@ -43,6 +43,13 @@ extern void traversalBatch3(
 	bool printResults, bool verbose
 );
 
+/* sweeps 1..maxThreads worker threads over the td-2-bu transforms */
+extern void scalingBatch(
+	const char tree_input_file[], const char treeType[], 
+	int buTreeSize, int maxThreads,
+	bool verbose
+);
+
 
 
 #endif
@@ -48,6 +48,13 @@ extern TimeInfo timeTransformNoMalloc2(
 	const char treeType[], const char direction[]
 );
 
+/* prints avg wall time with speedup/efficiency relative to baseWallTime */
+extern void printScaleResults(
+	TimeInfo timeInfo, double baseWallTime, int threads,
+	const char treeType[], const char experType[], const char direction[],
+	bool verbose
+);
+
 
 #endif
 /******************************************************************************* 
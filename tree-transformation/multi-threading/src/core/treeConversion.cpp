@@ -18,6 +18,8 @@
 ------------------------------- IMPORTS & PARAMS -------------------------------
 *******************************************************************************/
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <iostream>
 #include <unordered_map>
 
@@ -28,7 +30,10 @@
 #include "util.h"
 
 
-int threadLoads[NUM_THREADS+1] = {0};
+/* worker threads used by transforms (main thread only merges), its node 
+    count is kept in threadLoads[numThreads] */
+int numThreads = 0;
+int *threadLoads = NULL;
 
 
 
@@ -51,10 +56,50 @@ int getTreeSize(node *root)
     }
 }
 
+/* worker threads from -t N / --threads N / --threads=N, then NUM_THREADS_ENV,
+    then the number of online cores (copy of the one in 
+    traversal/multi-threading-new/src/core/threadpool.c, keep them identical) */
+int getNumThreads(int argc, char *argv[])
+{
+    const char *value = NULL;
+    int i;
+    for (i=1; i<argc; i++)
+    {
+        if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) && i+1 < argc)
+        {
+            value = argv[i+1];
+        }
+        else if (strncmp(argv[i], "--threads=", 10) == 0)
+        {
+            value = argv[i] + 10;
+        }
+    }
+    if (value == NULL) value = getenv(NUM_THREADS_ENV);
+
+    int count = (value != NULL) ? atoi(value) : 0;
+    if (count <= 0) count = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (count <= 0) count = 1;
+    return count;
+}
+
+void setNumThreads(int n)
+{
+    numThreads = n;
+    free(threadLoads);
+    threadLoads = (int *) malloc((numThreads+1) * sizeof(int));
+    resetThreadLoads();
+}
+
 void resetThreadLoads()
 {
+    if (threadLoads == NULL)
+    {
+        setNumThreads(getNumThreads(0, NULL));
+        return;
+    }
+
     int i;
-    for (i=0; i<NUM_THREADS+1; i++)
+    for (i=0; i<numThreads+1; i++)
     {
         threadLoads[i] = 0;
     }
@@ -102,7 +147,7 @@ void td2buRecursiveMT(node *tdRoot, node *buRoot, int tid)
     {
         td2buRecursiveMT(tdRoot->children, buRoot, tid);
     }
-    else if ((tdRoot->key % (NUM_THREADS)) == tid)
+    else if ((tdRoot->key % (numThreads)) == tid)
     {
         insertPath(tdRoot, buRoot);
     }
@@ -132,7 +177,9 @@ void * td2buTransformMT(void *args)
 
 node * td2buTransformMain(node *tdRoot)
 {
-    if (NUM_THREADS <= 0)
+    if (threadLoads == NULL) resetThreadLoads();
+
+    if (numThreads <= 0)
     {
         node *mainRoot = newNode(0);
         td2buRecursive(tdRoot, mainRoot);
@@ -140,16 +187,16 @@ node * td2buTransformMain(node *tdRoot)
     }
     else
     {
-        pthread_t threads[NUM_THREADS];
-        struct td2buTransfArgs threadArgs[NUM_THREADS];
+        pthread_t *threads = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
+        struct td2buTransfArgs *threadArgs = (struct td2buTransfArgs *) malloc(numThreads * sizeof(struct td2buTransfArgs));
         int tid;
 
-        node *mainRoot, *threadRoots[NUM_THREADS], *threadRoot;
+        node *mainRoot, **threadRoots = (node **) malloc(numThreads * sizeof(node *)), *threadRoot;
         mainRoot = newNode(0);
 
         // printf("Creating Threads\n");
 
-        for (tid=0; tid<NUM_THREADS; tid++)
+        for (tid=0; tid<numThreads; tid++)
         {
             threadRoots[tid] = NULL;
 
@@ -163,7 +210,7 @@ node * td2buTransformMain(node *tdRoot)
 
         // printf("Joining Threads\n");
         
-        for (tid=0; tid<NUM_THREADS; tid++)
+        for (tid=0; tid<numThreads; tid++)
         {
             if (pthread_join(threads[tid], (void **) &(threadRoots[tid])) != 0)
             {
@@ -173,7 +220,7 @@ node * td2buTransformMain(node *tdRoot)
 
         // printf("Merging Trees\n");
 
-        for (tid=0; tid<NUM_THREADS; tid++)
+        for (tid=0; tid<numThreads; tid++)
         {
             threadRoot = threadRoots[tid];
 
@@ -197,6 +244,10 @@ node * td2buTransformMain(node *tdRoot)
             }
         }
 
+        free(threads);
+        free(threadArgs);
+        free(threadRoots);
+
         // printf("Returning Root\n");
 
         return mainRoot;
@@ -256,7 +307,7 @@ void td2buRecursiveContMT(node *tdRoot, node *buRoot, node **nodeArray, pthread_
     {
         td2buRecursiveContMT(tdRoot->children, buRoot, nodeArray, arrayMutex, tid);
     }
-    else if ((tdRoot->key % (NUM_THREADS)) == tid)
+    else if ((tdRoot->key % (numThreads)) == tid)
     {
         insertPathContMT(tdRoot, buRoot, nodeArray, arrayMutex, tid);
     }
@@ -304,7 +355,9 @@ void * td2buTransformContMT(void *args)
 
 node * td2buTransformContMain(node *tdRoot, node *nodeArray)
 {
-    if (NUM_THREADS <= 0)
+    if (threadLoads == NULL) resetThreadLoads();
+
+    if (numThreads <= 0)
     {
         node *mainRoot = nodeArray++;
         mainRoot->key = 0;
@@ -313,21 +366,21 @@ node * td2buTransformContMain(node *tdRoot, node *nodeArray)
     }
     else
     {
-        pthread_t threads[NUM_THREADS];
+        pthread_t *threads = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
         pthread_mutex_t arrayMutex;
-        struct td2buTransfContArgs threadArgs[NUM_THREADS];
+        struct td2buTransfContArgs *threadArgs = (struct td2buTransfContArgs *) malloc(numThreads * sizeof(struct td2buTransfContArgs));
         int tid;
 
         pthread_mutex_init(&arrayMutex, NULL);
 
-        node *mainRoot, *threadRoots[NUM_THREADS], *threadRoot;
+        node *mainRoot, **threadRoots = (node **) malloc(numThreads * sizeof(node *)), *threadRoot;
         mainRoot = nodeArray++;
-        threadLoads[NUM_THREADS]++;
+        threadLoads[numThreads]++;
         mainRoot->key = 0;
 
         // printf("Creating Threads\n");
 
-        for (tid=0; tid<NUM_THREADS; tid++)
+        for (tid=0; tid<numThreads; tid++)
         {
             threadRoots[tid] = NULL;
 
@@ -343,7 +396,7 @@ node * td2buTransformContMain(node *tdRoot, node *nodeArray)
 
         // printf("Joining Threads\n");
         
-        for (tid=0; tid<NUM_THREADS; tid++)
+        for (tid=0; tid<numThreads; tid++)
         {
             if (pthread_join(threads[tid], (void **) &(threadRoots[tid])) != 0)
             {
@@ -353,7 +406,7 @@ node * td2buTransformContMain(node *tdRoot, node *nodeArray)
 
         // printf("Merging Trees\n");
 
-        for (tid=0; tid<NUM_THREADS; tid++)
+        for (tid=0; tid<numThreads; tid++)
         {
             threadRoot = threadRoots[tid];
 
@@ -379,6 +432,10 @@ node * td2buTransformContMain(node *tdRoot, node *nodeArray)
 
         pthread_mutex_destroy(&arrayMutex);
 
+        free(threads);
+        free(threadArgs);
+        free(threadRoots);
+
         // printf("Returning Root\n");
 
         return mainRoot;
@@ -400,7 +457,7 @@ void td2buRecursiveContMT2(node *tdRoot, node *buRoot, node **nodeArray, int tid
     {
         td2buRecursiveContMT2(tdRoot->children, buRoot, nodeArray, tid);
     }
-    else if ((tdRoot->key % (NUM_THREADS)) == tid)
+    else if ((tdRoot->key % (numThreads)) == tid)
     {
         insertPathCont(tdRoot, buRoot, nodeArray);
     }
@@ -434,7 +491,9 @@ void * td2buTransformContMT2(void *args)
 
 node * td2buTransformContMain2(node *tdRoot, node **nodeArrays)
 {
-    if (NUM_THREADS <= 0)
+    if (threadLoads == NULL) resetThreadLoads();
+
+    if (numThreads <= 0)
     {
         node *mainRoot = (nodeArrays[0])++;
         mainRoot->key = 0;
@@ -443,17 +502,17 @@ node * td2buTransformContMain2(node *tdRoot, node **nodeArrays)
     }
     else
     {
-        pthread_t threads[NUM_THREADS];
-        struct td2buTransfContArgs2 threadArgs[NUM_THREADS];
+        pthread_t *threads = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
+        struct td2buTransfContArgs2 *threadArgs = (struct td2buTransfContArgs2 *) malloc(numThreads * sizeof(struct td2buTransfContArgs2));
         int tid;
 
-        node *mainRoot, *threadRoots[NUM_THREADS], *threadRoot;
+        node *mainRoot, **threadRoots = (node **) malloc(numThreads * sizeof(node *)), *threadRoot;
         mainRoot = (nodeArrays[0])++;
         mainRoot->key = 0;
 
         // printf("Creating Threads\n");
 
-        for (tid=0; tid<NUM_THREADS; tid++)
+        for (tid=0; tid<numThreads; tid++)
         {
             threadRoots[tid] = NULL;
 
@@ -468,7 +527,7 @@ node * td2buTransformContMain2(node *tdRoot, node **nodeArrays)
 
         // printf("Joining Threads\n");
         
-        for (tid=0; tid<NUM_THREADS; tid++)
+        for (tid=0; tid<numThreads; tid++)
         {
             if (pthread_join(threads[tid], (void **) &(threadRoots[tid])) != 0)
             {
@@ -478,7 +537,7 @@ node * td2buTransformContMain2(node *tdRoot, node **nodeArrays)
 
         // printf("Merging Trees\n");
 
-        for (tid=0; tid<NUM_THREADS; tid++)
+        for (tid=0; tid<numThreads; tid++)
         {
             threadRoot = threadRoots[tid];
 
@@ -502,6 +561,10 @@ node * td2buTransformContMain2(node *tdRoot, node **nodeArrays)
             }
         }
 
+        free(threads);
+        free(threadArgs);
+        free(threadRoots);
+
         // printf("Returning Root\n");
 
         return mainRoot;
@@ -550,7 +613,7 @@ node * td2buTransformContMain2(node *tdRoot, node **nodeArrays)
 //     {
 //         td2buRecursiveContMT2(tdRoot->children, buRoot, nodeArray, tid);
 //     }
-//     else if ((tdRoot->key % (NUM_THREADS)) == tid)
+//     else if ((tdRoot->key % (numThreads)) == tid)
 //     {
 //         insertPathCont(tdRoot, buRoot, nodeArray);
 //     }
@@ -614,11 +677,11 @@ node * td2buTransformContMain2(node *tdRoot, node **nodeArrays)
 //         int threadLoads[NUM_THREADS] = {0};
 //         getThreadLoads(tdRoot, &(threadLoads[0]));
 //         for (tid=1; tid<NUM_THREADS; tid++) { threadLoads[tid] += threadLoads[tid-1]; }
-//         for (tid=0; tid<NUM_THREADS; tid++) { threadLoads[tid] -= threadLoads[0]; printf("%d\n", threadLoads[tid]); }
+//         for (tid=0; tid<numThreads; tid++) { threadLoads[tid] -= threadLoads[0]; printf("%d\n", threadLoads[tid]); }
 
 //         // printf("Creating Threads\n");
 
-//         for (tid=0; tid<NUM_THREADS; tid++)
+//         for (tid=0; tid<numThreads; tid++)
 //         {
 //             threadArgs[tid].tid = tid;
 //             threadArgs[tid].tdRoot = tdRoot;
@@ -631,7 +694,7 @@ node * td2buTransformContMain2(node *tdRoot, node **nodeArrays)
 
 //         // printf("Joining Threads\n");
         
-//         for (tid=0; tid<NUM_THREADS; tid++)
+//         for (tid=0; tid<numThreads; tid++)
 //         {
 //             if (pthread_join(threads[tid], (void **) &(threadRoots[tid])) != 0)
 //             {
@@ -641,7 +704,7 @@ node * td2buTransformContMain2(node *tdRoot, node **nodeArrays)
 
 //         // printf("Merging Trees\n");
 
-//         for (tid=0; tid<NUM_THREADS; tid++)
+//         for (tid=0; tid<numThreads; tid++)
 //         {
 //             threadRoot = threadRoots[tid];
 
@@ -746,8 +809,8 @@ void treeConvUnitTest(const char compressed_tree_input_file[])
 
     int i;
     node *tmp;
-    node *buTreeArray = (node *) malloc((buTreeSize+NUM_THREADS+1) * sizeof(node)); 
-    node *tdTreeArray = (node *) malloc((tdTreeSize+NUM_THREADS+1) * sizeof(node));
+    node *buTreeArray = (node *) malloc((buTreeSize+numThreads+1) * sizeof(node)); 
+    node *tdTreeArray = (node *) malloc((tdTreeSize+numThreads+1) * sizeof(node));
     for (i=0, tmp=buTreeArray; i<buTreeSize; i++, tmp++) { initNode(tmp); }
     for (i=0, tmp=tdTreeArray; i<tdTreeSize; i++, tmp++) { initNode(tmp); }
 
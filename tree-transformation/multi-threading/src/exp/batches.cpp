@@ -75,7 +75,7 @@ void traversalBatch(
 	}
 	timeTransformNoMalloc(original, buNodeArray, true, false, treeType, "td-2-bu-cont");
 	// printf("Thread Loads: ");
-	// for (i=0; i<NUM_THREADS+1; i++)
+	// for (i=0; i<numThreads+1; i++)
 	// {
 	// 	printf("%d ", threadLoads[i]);
 	// }
@@ -84,7 +84,7 @@ void traversalBatch(
 
 
 /* -------------- Transform Without Mem. Alloc. and No Locking -------------- */
-	if (NUM_THREADS <= 1)
+	if (numThreads <= 1)
 	{
 		for (i=0, tmp=buNodeArray; i<buTreeSize; i++, tmp++)
 		{
@@ -97,10 +97,10 @@ void traversalBatch(
 	else
 	{
 		free(buNodeArray);
-		node **buNodeArrays = (node **) malloc((NUM_THREADS+1) * sizeof(node *));
-		node **passedPointer = (node **) malloc((NUM_THREADS+1) * sizeof(node *));
+		node **buNodeArrays = (node **) malloc((numThreads+1) * sizeof(node *));
+		node **passedPointer = (node **) malloc((numThreads+1) * sizeof(node *));
 		int j;
-		for (j=0; j<(NUM_THREADS+1); j++)
+		for (j=0; j<(numThreads+1); j++)
 		{
 			buNodeArrays[j] = (node *) malloc(threadLoads[j] * sizeof(node));
 			passedPointer[j] = buNodeArrays[j];
@@ -110,7 +110,7 @@ void traversalBatch(
 			}
 		}
 		timeTransformNoMalloc2(original, passedPointer, true, false, treeType, "td-2-bu-cont");
-		for (j=0; j<(NUM_THREADS+1); j++) { free(buNodeArrays[j]); }
+		for (j=0; j<(numThreads+1); j++) { free(buNodeArrays[j]); }
 		free(buNodeArrays);
 	}
 /* -------------------------------------------------------------------------- */
@@ -134,6 +134,59 @@ void traversalBatch(
 
 
 
+/* ---------------------------- Thread Scaling ------------------------------ */
+
+void scalingBatch(
+	const char tree_input_file[], const char treeType[], 
+	int buTreeSize, int maxThreads,
+	bool verbose
+)
+{
+	int i, p;
+	int restoreThreads = numThreads;
+	double baseMalloc = 0, baseNoMalloc = 0;
+
+	node *splayArray = NULL;
+	node *original = NULL;
+	node *buRoot = NULL;
+	node *tmp;
+
+	loadCompressedJSON(tree_input_file, &splayArray, &original);
+	node *buNodeArray = (node *) malloc(buTreeSize * sizeof(node));
+
+	for (p=1; p<=maxThreads; p++)
+	{
+		setNumThreads(p);
+
+		TimeInfo mallocInfo = timeTransformMalloc(original, &buRoot, false, false, treeType, "td-2-bu-cont");
+		free(buRoot);
+
+		resetThreadLoads();
+		for (i=0, tmp=buNodeArray; i<buTreeSize; i++, tmp++)
+		{
+			initNode(tmp);
+		}
+		TimeInfo noMallocInfo = timeTransformNoMalloc(original, buNodeArray, false, false, treeType, "td-2-bu-cont");
+
+		if (p == 1)
+		{
+			baseMalloc = mallocInfo.avgWallTime;
+			baseNoMalloc = noMallocInfo.avgWallTime;
+		}
+		printScaleResults(mallocInfo, baseMalloc, p, treeType, "transform-malloc", "td-2-bu-cont", verbose);
+		printScaleResults(noMallocInfo, baseNoMalloc, p, treeType, "transform-no-malloc", "td-2-bu-cont", verbose);
+	}
+
+	setNumThreads(restoreThreads);
+	free(splayArray);
+	free(buNodeArray);
+}
+
+/* -------------------------------------------------------------------------- */
+
+
+
+
 // /* --------------------------- Backwards Direction (Fragmented) ---------------------------- */
 
 // void traversalBatch2(
@@ -16,9 +16,11 @@
 /******************************************************************************* 
 ------------------------------- IMPORTS & PARAMS -------------------------------
 *******************************************************************************/
+#include <string.h>
 
 #include "treeLoader.h"
 #include "treeConversion.h"
+#include "threadpool.h"
 
 #include "batches.h"
 
@@ -40,6 +42,23 @@ int main(int argc, char *argv[])
 	bool printResults = true;
 	bool verbose = false;
 
+	setNumThreads(getNumThreads(argc, argv));
+
+	/* "scale" sweeps 1..numThreads workers instead of the fixed-count batches */
+	int i;
+	for (i=1; i<argc; i++)
+	{
+		if (strcmp(argv[i], "scale") == 0)
+		{
+			scalingBatch(
+				small_tree_file_compressed, "small", 
+				SMALL_TREE_SIZE_BU, numThreads,
+				verbose
+			);
+			return (0);
+		}
+	}
+
 	/* ---------------------------------------------------------------------- */
 
 	// traversalBatch(
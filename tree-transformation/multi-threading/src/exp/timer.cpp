@@ -61,6 +61,31 @@ void printExpResults(
 	}
 }
 
+void printScaleResults(
+	TimeInfo timeInfo, double baseWallTime, int threads,
+	const char treeType[], const char experType[], const char direction[],
+	bool verbose
+)
+{
+	double speedup = (timeInfo.avgWallTime > 0) ? baseWallTime / timeInfo.avgWallTime : 0;
+	double efficiency = speedup / threads;
+
+	if (verbose)
+	{
+		fprintf(
+			stdout, "TreeType = %s , ExpType = %s , Direction = %s , Threads = %d , AvgWallSeconds = %f , Speedup = %f , Efficiency = %f\n",
+			treeType, experType, direction, threads, timeInfo.avgWallTime, speedup, efficiency
+		);
+	}
+	else
+	{
+		fprintf(
+			stdout, "%s,%s,%s,%d,%f,%f,%f\n",
+			treeType, experType, direction, threads, timeInfo.avgWallTime, speedup, efficiency
+		);
+	}
+}
+
 double wallTimeDiff(struct timeval start, struct timeval end)
 {
     long seconds = (end.tv_sec - start.tv_sec);
@@ -26,6 +26,7 @@
 #include "splayTree.h"
 #include "treeLoader.h"
 #include "treeConversion.h"
+#include "threadpool.h"
 #include "util.h"
 
 
@@ -87,6 +88,7 @@ int main(int argc, char *argv[])
 	printf("\n");
 
 	int testNum = 1;
+	setNumThreads(getNumThreads(argc, argv));
 
 	/* ---------------------------------------------------------------------- */
 	